@@ -142,6 +142,10 @@ void Client::messageReceived(const Message &msg)
                                                "Probe version is %1, was expecting %2.").arg(
                                                 serverVersion).arg(Protocol::version()));
             disconnectFromHost();
+        } else {
+            quint8 serverEncodings;
+            msg >> serverEncodings;
+            selectPayloadEncoding(serverEncodings);
         }
         m_initState |= VersionChecked;
         return;
@@ -245,6 +249,19 @@ void Client::handlerDestroyed(Protocol::ObjectAddress objectAddress, const QStri
     unmonitorObject(objectAddress);
 }
 
+void Client::selectPayloadEncoding(quint8 serverEncodings)
+{
+    // must be sent before any model request, the server switches when receiving this
+    const quint8 encodings = serverEncodings & Protocol::supportedPayloadEncodings();
+    const Protocol::PayloadEncoding encoding = (encodings & (1 << Protocol::CompactEncoding))
+                                               ? Protocol::CompactEncoding
+                                               : Protocol::DataStreamEncoding;
+    Message msg(endpointAddress(), Protocol::PayloadEncodingSelected);
+    msg << quint8(encoding);
+    send(msg);
+    setPayloadEncoding(encoding);
+}
+
 void Client::monitorObject(Protocol::ObjectAddress objectAddress)
 {
     if (!isConnected())
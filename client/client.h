@@ -86,6 +86,7 @@ protected:
 private:
     void monitorObject(Protocol::ObjectAddress objectAddress);
     void unmonitorObject(Protocol::ObjectAddress objectAddress);
+    void selectPayloadEncoding(quint8 serverEncodings);
 
 private slots:
     void socketConnected();
@@ -48,6 +48,7 @@ static const MetaEnum::Value<Protocol::MessageType> message_type_table[] = {
     M(ObjectRemoved),
     M(ModelRowColumnCountRequest),
     M(ModelContentRequest),
+    M(ModelAppendedContentRequest),
     M(ModelHeaderRequest),
     M(ModelSetDataRequest),
     M(ModelSortRequest),
@@ -55,6 +56,7 @@ static const MetaEnum::Value<Protocol::MessageType> message_type_table[] = {
     M(SelectionModelStateRequest),
     M(ModelRowColumnCountReply),
     M(ModelContentReply),
+    M(ModelAppendedContentReply),
     M(ModelContentChanged),
     M(ModelHeaderReply),
     M(ModelHeaderChanged),
@@ -73,7 +75,8 @@ static const MetaEnum::Value<Protocol::MessageType> message_type_table[] = {
     M(PropertyValuesChanged),
     M(ServerInfo),
     M(ProbeSettings),
-    M(ServerAddress)
+    M(ServerAddress),
+    M(PayloadEncodingSelected)
 };
 #undef M
 
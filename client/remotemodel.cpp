@@ -29,7 +29,9 @@
 #include "remotemodel.h"
 #include "client.h"
 
+#include <common/compactpayload.h>
 #include <common/message.h>
+#include <common/modelutils.h>
 
 #include <QApplication>
 #include <QDataStream>
@@ -42,6 +44,11 @@
 
 using namespace GammaRay;
 
+// roughly 10-20MB of cached content for typical models
+static const int DefaultMaxCachedRows = 10000;
+// number of viewport heights prefetched in scroll direction
+static const int PrefetchPages = 2;
+
 void(*RemoteModel::s_registerClientCallback)() = nullptr;
 
 RemoteModel::Node::~Node()
@@ -95,6 +102,12 @@ QVariant RemoteModel::s_emptySizeHintValue;
 RemoteModel::RemoteModel(const QString &serverObject, QObject *parent)
     : QAbstractItemModel(parent)
     , m_pendingDataRequestsTimer(new QTimer(this))
+    , m_accessCounter(0)
+    , m_cachedRows(0)
+    , m_maxCachedRows(DefaultMaxCachedRows)
+    , m_evictionThreshold(DefaultMaxCachedRows)
+    , m_viewportParent(nullptr)
+    , m_viewportFirstRow(0)
     , m_serverObject(serverObject)
     , m_myAddress(Protocol::InvalidObjectAddress)
     , m_currentSyncBarrier(0)
@@ -199,6 +212,7 @@ QVariant RemoteModel::data(const QModelIndex &index, int role) const
 
     Node *node = nodeForIndex(index);
     Q_ASSERT(node);
+    node->lastAccess = ++m_accessCounter;
 
     const auto state = stateForColumn(node, index.column());
     if (role == RemoteModelRole::LoadingState)
@@ -276,6 +290,70 @@ void RemoteModel::sort(int column, Qt::SortOrder order)
     sendMessage(msg);
 }
 
+int RemoteModel::maxCachedRows() const
+{
+    return m_maxCachedRows;
+}
+
+void RemoteModel::setMaxCachedRows(int rows)
+{
+    m_maxCachedRows = qMax(0, rows);
+    evictRows();
+}
+
+void RemoteModel::setViewport(const QModelIndex &first, int rowCount)
+{
+    if (!isConnected() || !first.isValid() || first.model() != this || rowCount <= 0)
+        return;
+
+    Node *parentNode = nodeForIndex(first.parent());
+    if (parentNode->rowCount <= 0 || parentNode->columnCount <= 0)
+        return;
+
+    const int direction = parentNode == m_viewportParent ? first.row() - m_viewportFirstRow : 0;
+    m_viewportParent = parentNode;
+    m_viewportFirstRow = first.row();
+
+    int firstRow = first.row();
+    int lastRow = first.row() + rowCount - 1;
+    if (direction < 0)
+        firstRow -= PrefetchPages * rowCount;
+    else
+        lastRow += PrefetchPages * rowCount;
+    firstRow = qMax(0, firstRow);
+    lastRow = qMin(parentNode->rowCount - 1, lastRow);
+
+    for (int row = firstRow; row <= lastRow; ++row)
+        touchRow(parentNode->children.at(row), row);
+}
+
+void RemoteModel::setVisibleRows(const QModelIndexList &rows)
+{
+    if (!isConnected())
+        return;
+
+    // no meaningful scroll direction across scattered rows
+    m_viewportParent = nullptr;
+    foreach (const auto &index, rows) {
+        if (!index.isValid() || index.model() != this)
+            continue;
+        Node *parentNode = nodeForIndex(index.parent());
+        if (parentNode->columnCount <= 0 || index.row() >= parentNode->children.size())
+            continue;
+        touchRow(parentNode->children.at(index.row()), index.row());
+    }
+}
+
+void RemoteModel::touchRow(Node *node, int row) const
+{
+    node->lastAccess = ++m_accessCounter;
+    for (int column = 0; column < node->parent->columnCount; ++column) {
+        const auto state = stateForColumn(node, column);
+        if ((state & RemoteModelNodeState::Outdated) && ((state & RemoteModelNodeState::Loading) == 0))
+            requestDataAndFlags(createIndex(row, column, node));
+    }
+}
+
 void RemoteModel::newMessage(const GammaRay::Message &msg)
 {
     if (!checkSyncBarrier(msg))
@@ -342,21 +420,35 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
 
     case Protocol::ModelContentReply:
     {
+        const bool compact = payloadEncoding() == Protocol::CompactEncoding;
+        CompactPayloadReader reader(compact ? msg.rawPayload() : QByteArray());
         quint32 size;
-        msg >> size;
+        if (compact)
+            size = reader.readUInt();
+        else
+            msg >> size;
         Q_ASSERT(size > 0);
 
         QHash<QModelIndex, QVector<QModelIndex> > dataChangedIndexes;
         for (quint32 i = 0; i < size; ++i) {
             Protocol::ModelIndex index;
-            msg >> index;
-            Node *node = nodeForIndex(index);
-            const auto column = index.last().second;
-            const auto state = node ? stateForColumn(node, column) : RemoteModelNodeState::NoState;
             typedef QHash<int, QVariant> ItemData;
             ItemData itemData;
             qint32 flags;
-            msg >> itemData >> flags;
+            if (compact) {
+                index = reader.readModelIndex();
+                itemData = reader.readItemData();
+                flags = static_cast<qint32>(reader.readUInt());
+                if (reader.hasError() || index.isEmpty()) {
+                    qWarning() << Q_FUNC_INFO << "Malformed model content reply.";
+                    break;
+                }
+            } else {
+                msg >> index >> itemData >> flags;
+            }
+            Node *node = nodeForIndex(index);
+            const auto column = index.last().second;
+            const auto state = node ? stateForColumn(node, column) : RemoteModelNodeState::NoState;
             if ((state & RemoteModelNodeState::Loading) == 0)
                 continue; // we didn't ask for this, probably outdated response for a moved cell
 
@@ -429,19 +521,56 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
         Q_ASSERT(beginIndex.last().first <= endIndex.last().first);
         Q_ASSERT(beginIndex.last().second <= endIndex.last().second);
 
-        // mark content as outdated (will be refetched on next request)
+        const int appendOnlyIndex = roles.indexOf(RemoteModelRole::AppendOnly);
+        if (appendOnlyIndex >= 0)
+            roles.remove(appendOnlyIndex);
+        const bool appendOnly = appendOnlyIndex >= 0 && !roles.isEmpty();
+        struct AppendRequest {
+            Protocol::ModelIndex index;
+            qint32 role;
+            qint32 knownSize;
+        };
+        QVector<AppendRequest> appendRequests;
+
+        // mark content as outdated (will be refetched on next request), unless we only
+        // need to fetch elements appended to content we already have
         for (int row = beginIndex.last().first; row <= endIndex.last().first; ++row) {
             Node *currentRow = node->parent->children.at(row);
             if (!currentRow->hasColumnData())
                 continue;
             for (int col = beginIndex.last().second; col <= endIndex.last().second; ++col) {
                 const auto state = stateForColumn(currentRow, col);
+                if (appendOnly && state == RemoteModelNodeState::NoState) {
+                    Protocol::ModelIndex index = beginIndex;
+                    index.last() = qMakePair(row, col);
+                    const auto &cellData = currentRow->data.at(col);
+                    QVector<AppendRequest> requests;
+                    foreach (int role, roles) {
+                        const AppendRequest request = {
+                            index, role, ModelUtils::appendableSize(cellData.value(role))
+                        };
+                        if (request.knownSize < 0)
+                            break;
+                        requests.push_back(request);
+                    }
+                    if (requests.size() == roles.size()) {
+                        appendRequests += requests;
+                        continue;
+                    }
+                }
                 if ((state & RemoteModelNodeState::Outdated) == 0) {
                     Q_ASSERT(currentRow->state.size() > col);
                     currentRow->state[col] = state | RemoteModelNodeState::Outdated;
                 }
             }
         }
+        if (!appendRequests.isEmpty()) {
+            Message requestMsg(m_myAddress, Protocol::ModelAppendedContentRequest);
+            requestMsg << quint32(appendRequests.size());
+            foreach (const auto &request, appendRequests)
+                requestMsg << request.index << request.role << request.knownSize;
+            sendMessage(requestMsg);
+        }
 
         const QModelIndex qmiBegin = modelIndexForNode(node, beginIndex.last().second);
         const QModelIndex qmiEnd = qmiBegin.sibling(endIndex.last().first, endIndex.last().second);
@@ -454,6 +583,44 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
         break;
     }
 
+    case Protocol::ModelAppendedContentReply:
+    {
+        quint32 size;
+        msg >> size;
+        for (quint32 i = 0; i < size; ++i) {
+            Protocol::ModelIndex index;
+            qint32 role, offset;
+            QVariant tail;
+            msg >> index >> role >> offset >> tail;
+            Node *node = nodeForIndex(index);
+            if (!node || index.isEmpty())
+                continue;
+            const auto column = index.last().second;
+            const auto state = stateForColumn(node, column);
+            if (state != RemoteModelNodeState::NoState)
+                continue; // content is being refetched entirely anyway
+
+            QVariant &value = node->data[column][role];
+            const int knownSize = ModelUtils::appendableSize(value);
+            if (offset == 0) {
+                value = tail;
+            } else if (offset < 0 || knownSize < offset
+                       || !ModelUtils::appendableAppend(
+                           value, ModelUtils::appendableMid(tail, knownSize - offset))) {
+                // replies overlapping with each other are fine, gaps are not
+                node->state[column] = state | RemoteModelNodeState::Outdated;
+            }
+
+            const QModelIndex qmi = modelIndexForNode(node, column);
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+            emit dataChanged(qmi, qmi);
+#else
+            emit dataChanged(qmi, qmi, QVector<int>() << role);
+#endif
+        }
+        break;
+    }
+
     case Protocol::ModelHeaderChanged:
     {
         qint8 ori;
@@ -718,6 +885,9 @@ void RemoteModel::requestDataAndFlags(const QModelIndex &index) const
     const auto state = stateForColumn(node, index.column());
     Q_ASSERT((state & RemoteModelNodeState::Loading) == 0);
 
+    node->lastAccess = ++m_accessCounter;
+    if (!node->hasColumnData())
+        ++m_cachedRows;
     node->allocateColumns();
     Q_ASSERT(node->state.size() > index.column());
     node->state[index.column()] = state | RemoteModelNodeState::Loading; // mark pending request
@@ -735,11 +905,66 @@ void RemoteModel::doRequestDataAndFlags() const
 {
     Q_ASSERT(!m_pendingDataRequests.isEmpty());
     Message msg(m_myAddress, Protocol::ModelContentRequest);
-    msg << quint32(m_pendingDataRequests.size());
-    foreach (const auto &index, m_pendingDataRequests)
-        msg << index;
+    if (payloadEncoding() == Protocol::CompactEncoding) {
+        CompactPayloadWriter writer(&msg.rawPayload(), m_pendingDataRequests.size() * 8);
+        writer.writeUInt(m_pendingDataRequests.size());
+        foreach (const auto &index, m_pendingDataRequests)
+            writer.writeModelIndex(index);
+    } else {
+        msg << quint32(m_pendingDataRequests.size());
+        foreach (const auto &index, m_pendingDataRequests)
+            msg << index;
+    }
     m_pendingDataRequests.clear();
     sendMessage(msg);
+
+    if (m_maxCachedRows > 0 && m_cachedRows > m_evictionThreshold)
+        evictRows();
+}
+
+void RemoteModel::collectCachedRows(RemoteModel::Node *node, QVector<Node *> &rows) const
+{
+    foreach (auto child, node->children) {
+        if (child->hasColumnData())
+            rows.push_back(child);
+        collectCachedRows(child, rows);
+    }
+}
+
+void RemoteModel::evictRows() const
+{
+    QVector<Node *> rows;
+    rows.reserve(m_cachedRows);
+    collectCachedRows(m_root, rows);
+    m_cachedRows = rows.size();
+    m_evictionThreshold = m_maxCachedRows;
+    if (m_maxCachedRows <= 0 || m_cachedRows <= m_maxCachedRows)
+        return;
+
+    // evict down to 3/4 of the budget, so we don't end up doing this on every request
+    const int keep = m_maxCachedRows * 3 / 4;
+    const auto end = rows.begin() + (rows.size() - keep);
+    std::nth_element(rows.begin(), end, rows.end(), [](Node *lhs, Node *rhs) {
+        return lhs->lastAccess < rhs->lastAccess;
+    });
+
+    for (auto it = rows.begin(); it != end; ++it) {
+        Node *node = *it;
+        // rows waiting for a reply need to stay, the reply would be discarded otherwise
+        if (std::find_if(node->state.constBegin(), node->state.constEnd(),
+                         [](RemoteModelNodeState::NodeStates state) {
+                             return (state & RemoteModelNodeState::Loading) != 0;
+                         }) != node->state.constEnd())
+            continue;
+        node->data.clear();
+        node->flags.clear();
+        node->state.clear();
+        --m_cachedRows;
+    }
+
+    // rows still loading might have kept us above the budget, don't rescan the entire tree
+    // on every request then, but only once a substantial amount of new rows got added
+    m_evictionThreshold = qMax(m_maxCachedRows, m_cachedRows + m_maxCachedRows / 4);
 }
 
 void RemoteModel::requestHeaderData(Qt::Orientation orientation, int section) const
@@ -767,6 +992,9 @@ void RemoteModel::clear()
 
     delete m_root;
     m_root = new Node;
+    m_cachedRows = 0;
+    m_evictionThreshold = m_maxCachedRows;
+    m_viewportParent = nullptr;
     m_horizontalHeaders.clear();
     m_verticalHeaders.clear();
     endResetModel();
@@ -977,6 +1205,11 @@ void RemoteModel::sendMessage(const Message &msg) const
     Endpoint::send(msg);
 }
 
+Protocol::PayloadEncoding RemoteModel::payloadEncoding() const
+{
+    return Endpoint::payloadEncoding();
+}
+
 bool RemoteModel::proxyDynamicSortFilter() const
 {
     return m_proxyDynamicSortFilter;
@@ -75,6 +75,22 @@ public:
                         int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_OVERRIDE;
 
+    /** Maximum number of rows we keep content for, least recently used rows beyond that
+     *  are dropped and transparently refetched when accessed again. 0 means unlimited.
+     */
+    int maxCachedRows() const;
+    void setMaxCachedRows(int rows);
+
+    /** Notification from a view about its visible range, @p rowCount rows starting at @p first.
+     *  Content for those rows and the next ones in scroll direction is prefetched.
+     *  Views find this by name through any proxy models in between.
+     */
+    Q_INVOKABLE void setViewport(const QModelIndex &first, int rowCount);
+    /** Like setViewport(), for views whose visible rows are not one contiguous range in this
+     *  model, e.g. due to a sorting proxy model in between. No prefetching is done for those.
+     */
+    Q_INVOKABLE void setVisibleRows(const QModelIndexList &rows);
+
 public slots:
     void newMessage(const GammaRay::Message &msg);
     void serverRegistered(const QString &objectName, Protocol::ObjectAddress objectAddress);
@@ -91,7 +107,8 @@ private:
         Node()
             : parent(nullptr)
             , rowCount(-1)
-            , columnCount(-1) {}
+            , columnCount(-1)
+            , lastAccess(0) {}
         ~Node();
         Q_DISABLE_COPY(Node)
         // delete all cached children data, but assume row/column count on this level is still accurate
@@ -111,6 +128,7 @@ private:
         QVector<QHash<int, QVariant> > data; // column -> role -> data
         QVector<Qt::ItemFlags> flags;      // column -> flags
         QVector<RemoteModelNodeState::NodeStates> state;         // column -> state (cache outdated, waiting for data, etc)
+        quint64 lastAccess; // value of m_accessCounter when this row was last used
     };
 
     void clear();
@@ -130,6 +148,11 @@ private:
     void requestRowColumnCount(const QModelIndex &index) const;
     void requestDataAndFlags(const QModelIndex &index) const;
     void requestHeaderData(Qt::Orientation orientation, int section) const;
+    /// Drop the content of the least recently used rows if we exceed m_maxCachedRows.
+    void evictRows() const;
+    /// Refresh the LRU position of the row @p node and request its outdated columns.
+    void touchRow(Node *node, int row) const;
+    void collectCachedRows(Node *node, QVector<Node *> &rows) const;
     /// Reset the loading state for all rows at @p startRow or later.
     /// This is needed when rows have been added or removed before @p startRow, since
     /// pending replies might have a wrong index.
@@ -170,6 +193,16 @@ private:
     mutable QVector<Protocol::ModelIndex> m_pendingDataRequests;
     QTimer *m_pendingDataRequestsTimer;
 
+    // LRU cache bookkeeping, m_cachedRows is an upper bound corrected on every eviction run
+    mutable quint64 m_accessCounter;
+    mutable int m_cachedRows;
+    int m_maxCachedRows;
+    // m_cachedRows value at which to try the next eviction run, see evictRows()
+    mutable int m_evictionThreshold;
+    // last reported viewport, to determine the scroll direction, never dereferenced
+    Node *m_viewportParent;
+    int m_viewportFirstRow;
+
     QString m_serverObject;
     Protocol::ObjectAddress m_myAddress;
 
@@ -189,6 +222,7 @@ private:
     static void (*s_registerClientCallback)();
     void registerClient(const QString &serverObject);
     virtual void sendMessage(const Message &msg) const;
+    virtual Protocol::PayloadEncoding payloadEncoding() const;
     friend class FakeRemoteModel;
 };
 }
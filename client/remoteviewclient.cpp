@@ -103,3 +103,18 @@ void RemoteViewClient::clientViewUpdated()
 {
     Endpoint::instance()->invokeObject(name(), "clientViewUpdated");
 }
+
+void RemoteViewClient::requestCompleteFrame()
+{
+    Endpoint::instance()->invokeObject(name(), "requestCompleteFrame");
+}
+
+void RemoteViewClient::setViewport(const QRectF &rect, const QSize &size)
+{
+    Endpoint::instance()->invokeObject(name(), "setViewport", QVariantList() << rect << size);
+}
+
+void RemoteViewClient::requestInlineFrames()
+{
+    Endpoint::instance()->invokeObject(name(), "requestInlineFrames");
+}
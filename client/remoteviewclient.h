@@ -52,6 +52,9 @@ public:
                         Q_DECL_OVERRIDE;
     void setViewActive(bool active) Q_DECL_OVERRIDE;
     void clientViewUpdated() Q_DECL_OVERRIDE;
+    void requestCompleteFrame() Q_DECL_OVERRIDE;
+    void setViewport(const QRectF &rect, const QSize &size) Q_DECL_OVERRIDE;
+    void requestInlineFrames() Q_DECL_OVERRIDE;
 };
 }
 
@@ -0,0 +1,390 @@
+/*
+  compactpayload.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "compactpayload.h"
+
+#include <QDataStream>
+#include <QMetaType>
+#include <qendian.h>
+
+#include <cstring>
+
+using namespace GammaRay;
+
+// must match the Message QDataStream version, for types relying on QDataStream::version()
+static const QDataStream::Version StreamVersion = QDataStream::Qt_4_7;
+
+enum VariantTag {
+    InvalidTag,
+    FalseTag,
+    TrueTag,
+    IntTag,
+    UIntTag,
+    LongLongTag,
+    ULongLongTag,
+    DoubleTag,
+    StringTag,
+    ByteArrayTag,
+    MetaTypeTag // interned type name, followed by the length-prefixed QMetaType::save() data
+};
+
+CompactPayloadWriter::CompactPayloadWriter(QByteArray *buffer, int sizeHint)
+    : m_buffer(buffer)
+{
+    Q_ASSERT(m_buffer);
+    if (sizeHint > 0)
+        m_buffer->reserve(m_buffer->size() + sizeHint);
+}
+
+void CompactPayloadWriter::writeRaw(const char *data, int size)
+{
+    m_buffer->append(data, size);
+}
+
+void CompactPayloadWriter::writeUInt(quint64 value)
+{
+    char buffer[10];
+    int size = 0;
+    while (value >= 0x80) {
+        buffer[size++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = static_cast<char>(value);
+    writeRaw(buffer, size);
+}
+
+void CompactPayloadWriter::writeInt(qint64 value)
+{
+    // zig-zag encoding, so small negative numbers stay small as well
+    writeUInt((static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+void CompactPayloadWriter::writeString(const QString &value)
+{
+    writeUInt(value.size());
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    writeRaw(reinterpret_cast<const char *>(value.constData()), value.size() * 2);
+#else
+    for (int i = 0; i < value.size(); ++i) {
+        const quint16 c = qToLittleEndian(value.at(i).unicode());
+        writeRaw(reinterpret_cast<const char *>(&c), 2);
+    }
+#endif
+}
+
+void CompactPayloadWriter::writeByteArray(const QByteArray &value)
+{
+    writeUInt(value.size());
+    writeRaw(value.constData(), value.size());
+}
+
+void CompactPayloadWriter::writeModelIndex(const Protocol::ModelIndex &index)
+{
+    writeUInt(index.size());
+    foreach (const auto &pos, index) {
+        writeInt(pos.first);
+        writeInt(pos.second);
+    }
+}
+
+void CompactPayloadWriter::writeRole(int role)
+{
+    // known roles are sent as their position in the role table, new ones with the lowest bit set
+    const auto it = m_roles.constFind(role);
+    if (it != m_roles.constEnd()) {
+        writeUInt(static_cast<quint64>(it.value()) << 1);
+    } else {
+        m_roles.insert(role, m_roles.size());
+        writeUInt((static_cast<quint64>(static_cast<quint32>(role)) << 1) | 1);
+    }
+}
+
+void CompactPayloadWriter::writeVariant(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QVariant::Invalid:
+        writeUInt(InvalidTag);
+        return;
+    case QVariant::Bool:
+        writeUInt(value.toBool() ? TrueTag : FalseTag);
+        return;
+    case QVariant::Int:
+        writeUInt(IntTag);
+        writeInt(value.toInt());
+        return;
+    case QVariant::UInt:
+        writeUInt(UIntTag);
+        writeUInt(value.toUInt());
+        return;
+    case QVariant::LongLong:
+        writeUInt(LongLongTag);
+        writeInt(value.toLongLong());
+        return;
+    case QVariant::ULongLong:
+        writeUInt(ULongLongTag);
+        writeUInt(value.toULongLong());
+        return;
+    case QVariant::Double:
+    {
+        writeUInt(DoubleTag);
+        const double d = value.toDouble();
+        quint64 bits;
+        memcpy(&bits, &d, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        writeRaw(reinterpret_cast<const char *>(&bits), sizeof(bits));
+        return;
+    }
+    case QVariant::String:
+        writeUInt(StringTag);
+        writeString(value.toString());
+        return;
+    case QVariant::ByteArray:
+        writeUInt(ByteArrayTag);
+        writeByteArray(value.toByteArray());
+        return;
+    }
+
+    // everything else goes through QMetaType, with the type name interned
+    const int type = value.userType();
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(StreamVersion);
+        if (!QMetaType::save(stream, type, value.constData())) {
+            writeUInt(InvalidTag);
+            return;
+        }
+    }
+
+    writeUInt(MetaTypeTag);
+    const auto it = m_typeNames.constFind(type);
+    if (it != m_typeNames.constEnd()) {
+        writeUInt(static_cast<quint64>(it.value()) << 1);
+    } else {
+        m_typeNames.insert(type, m_typeNames.size());
+        writeUInt(1);
+        writeByteArray(QByteArray(QMetaType::typeName(type)));
+    }
+    writeByteArray(data);
+}
+
+void CompactPayloadWriter::writeItemData(const QMap<int, QVariant> &itemData)
+{
+    writeUInt(itemData.size());
+    for (auto it = itemData.constBegin(); it != itemData.constEnd(); ++it) {
+        writeRole(it.key());
+        writeVariant(it.value());
+    }
+}
+
+CompactPayloadReader::CompactPayloadReader(const QByteArray &buffer)
+    : m_buffer(buffer)
+    , m_pos(0)
+    , m_error(false)
+{
+}
+
+bool CompactPayloadReader::hasError() const
+{
+    return m_error;
+}
+
+const char *CompactPayloadReader::readRaw(int size)
+{
+    if (m_error || size < 0 || size > m_buffer.size() - m_pos) {
+        m_error = true;
+        return nullptr;
+    }
+    const char *data = m_buffer.constData() + m_pos;
+    m_pos += size;
+    return data;
+}
+
+quint64 CompactPayloadReader::readUInt()
+{
+    quint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const char *c = readRaw(1);
+        if (!c)
+            return 0;
+        value |= static_cast<quint64>(*c & 0x7f) << shift;
+        if ((*c & 0x80) == 0)
+            return value;
+    }
+    m_error = true;
+    return 0;
+}
+
+qint64 CompactPayloadReader::readInt()
+{
+    const quint64 value = readUInt();
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+QString CompactPayloadReader::readString()
+{
+    const quint64 size = readUInt();
+    if (size > static_cast<quint64>(m_buffer.size() - m_pos) / 2) {
+        m_error = true;
+        return QString();
+    }
+    const char *data = readRaw(size * 2);
+    if (!data)
+        return QString();
+
+    QString s(static_cast<int>(size), Qt::Uninitialized);
+    memcpy(s.data(), data, size * 2);
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    for (int i = 0; i < s.size(); ++i)
+        s[i] = QChar(qFromLittleEndian(s.at(i).unicode()));
+#endif
+    return s;
+}
+
+QByteArray CompactPayloadReader::readByteArray()
+{
+    const quint64 size = readUInt();
+    if (size > static_cast<quint64>(m_buffer.size() - m_pos)) {
+        m_error = true;
+        return QByteArray();
+    }
+    const char *data = readRaw(size);
+    if (!data)
+        return QByteArray();
+    return QByteArray(data, static_cast<int>(size));
+}
+
+Protocol::ModelIndex CompactPayloadReader::readModelIndex()
+{
+    Protocol::ModelIndex index;
+    const quint64 size = readUInt();
+    if (size > static_cast<quint64>(m_buffer.size() - m_pos) / 2) {
+        m_error = true;
+        return index;
+    }
+    index.reserve(static_cast<int>(size));
+    for (quint64 i = 0; i < size; ++i) {
+        const qint32 row = readInt();
+        const qint32 column = readInt();
+        index.push_back(qMakePair(row, column));
+    }
+    return index;
+}
+
+int CompactPayloadReader::readRole()
+{
+    const quint64 value = readUInt();
+    if (value & 1) {
+        const int role = static_cast<int>(value >> 1);
+        m_roles.push_back(role);
+        return role;
+    }
+    if ((value >> 1) >= static_cast<quint64>(m_roles.size())) {
+        m_error = true;
+        return -1;
+    }
+    return m_roles.at(value >> 1);
+}
+
+QVariant CompactPayloadReader::readVariant()
+{
+    switch (readUInt()) {
+    case InvalidTag:
+        return QVariant();
+    case FalseTag:
+        return QVariant(false);
+    case TrueTag:
+        return QVariant(true);
+    case IntTag:
+        return QVariant(static_cast<int>(readInt()));
+    case UIntTag:
+        return QVariant(static_cast<uint>(readUInt()));
+    case LongLongTag:
+        return QVariant(static_cast<qlonglong>(readInt()));
+    case ULongLongTag:
+        return QVariant(static_cast<qulonglong>(readUInt()));
+    case DoubleTag:
+    {
+        const char *data = readRaw(sizeof(quint64));
+        if (!data)
+            return QVariant();
+        quint64 bits;
+        memcpy(&bits, data, sizeof(bits));
+        bits = qFromLittleEndian(bits);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return QVariant(d);
+    }
+    case StringTag:
+        return QVariant(readString());
+    case ByteArrayTag:
+        return QVariant(readByteArray());
+    case MetaTypeTag:
+    {
+        int type = 0;
+        const quint64 typeRef = readUInt();
+        if (typeRef & 1) {
+            type = QMetaType::type(readByteArray().constData());
+            m_types.push_back(type);
+        } else if ((typeRef >> 1) < static_cast<quint64>(m_types.size())) {
+            type = m_types.at(typeRef >> 1);
+        } else {
+            m_error = true;
+        }
+
+        const QByteArray data = readByteArray();
+        if (m_error || type == 0) // unknown on this side, skipped
+            return QVariant();
+
+        QVariant value(type, nullptr);
+        QDataStream stream(data);
+        stream.setVersion(StreamVersion);
+        if (!QMetaType::load(stream, type, value.data()))
+            return QVariant();
+        return value;
+    }
+    }
+
+    m_error = true;
+    return QVariant();
+}
+
+QHash<int, QVariant> CompactPayloadReader::readItemData()
+{
+    QHash<int, QVariant> itemData;
+    const quint64 size = readUInt();
+    if (size > static_cast<quint64>(m_buffer.size() - m_pos)) {
+        m_error = true;
+        return itemData;
+    }
+    itemData.reserve(static_cast<int>(size));
+    for (quint64 i = 0; i < size && !m_error; ++i) {
+        const int role = readRole();
+        itemData.insert(role, readVariant());
+    }
+    return itemData;
+}
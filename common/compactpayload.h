@@ -0,0 +1,100 @@
+/*
+  compactpayload.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_COMPACTPAYLOAD_H
+#define GAMMARAY_COMPACTPAYLOAD_H
+
+#include "gammaray_common_export.h"
+#include "protocol.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QVariant>
+#include <QVector>
+
+namespace GammaRay {
+/**
+ * Writes the compact binary payload encoding (Protocol::CompactEncoding).
+ *
+ * Unlike QDataStream this appends directly to the message buffer, uses variable length
+ * integers for indexes and sizes, interns role ids and variant type names per message,
+ * and only falls back to QMetaType serialization for non-trivial variant types.
+ */
+class GAMMARAY_COMMON_EXPORT CompactPayloadWriter
+{
+public:
+    /** Append to @p buffer, reserving @p sizeHint additional bytes upfront. */
+    explicit CompactPayloadWriter(QByteArray *buffer, int sizeHint = 0);
+
+    void writeUInt(quint64 value);
+    void writeInt(qint64 value);
+    void writeString(const QString &value);
+    void writeByteArray(const QByteArray &value);
+    void writeModelIndex(const Protocol::ModelIndex &index);
+    void writeRole(int role);
+    void writeVariant(const QVariant &value);
+    void writeItemData(const QMap<int, QVariant> &itemData);
+
+private:
+    void writeRaw(const char *data, int size);
+
+    QByteArray *m_buffer;
+    QHash<int, int> m_roles;
+    QHash<int, int> m_typeNames;
+};
+
+/** Reads the data written by CompactPayloadWriter. */
+class GAMMARAY_COMMON_EXPORT CompactPayloadReader
+{
+public:
+    explicit CompactPayloadReader(const QByteArray &buffer);
+
+    /** Returns @c true if we tried to read beyond the end or encountered malformed data. */
+    bool hasError() const;
+
+    quint64 readUInt();
+    qint64 readInt();
+    QString readString();
+    QByteArray readByteArray();
+    Protocol::ModelIndex readModelIndex();
+    int readRole();
+    QVariant readVariant();
+    QHash<int, QVariant> readItemData();
+
+private:
+    const char *readRaw(int size);
+
+    QByteArray m_buffer;
+    int m_pos;
+    bool m_error;
+    QVector<int> m_roles;
+    QVector<int> m_types;
+};
+}
+
+#endif // GAMMARAY_COMPACTPAYLOAD_H
@@ -28,9 +28,12 @@
 
 #include "endpoint.h"
 #include "message.h"
+#include "messagecompressor.h"
 #include "methodargument.h"
 #include "propertysyncer.h"
 
+#include <QTimer>
+
 #include <iostream>
 
 using namespace GammaRay;
@@ -38,11 +41,20 @@ using namespace std;
 
 Endpoint *Endpoint::s_instance = nullptr;
 
+// write immediately once this much accumulated, rather than waiting for the flush timer
+static const int MaxSendBufferSize = 256 * 1024;
+
 Endpoint::Endpoint(QObject *parent)
     : QObject(parent)
     , m_propertySyncer(new PropertySyncer(this))
     , m_socket(nullptr)
     , m_myAddress(Protocol::InvalidObjectAddress +1)
+    , m_payloadEncoding(Protocol::DataStreamEncoding)
+    , m_flushTimer(new QTimer(this))
+    , m_receiveOffset(0)
+    , m_compressor(nullptr)
+    , m_decompressor(nullptr)
+    , m_bytesDrained(0)
 {
     if (s_instance)
         qCritical(
@@ -58,6 +70,10 @@ Endpoint::Endpoint(QObject *parent)
 
     connect(m_propertySyncer, SIGNAL(message(GammaRay::Message)), this,
             SLOT(sendMessage(GammaRay::Message)));
+
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(0);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
 }
 
 Endpoint::~Endpoint()
@@ -67,6 +83,8 @@ Endpoint::~Endpoint()
          it != m_addressMap.constEnd(); ++it)
         delete it.value();
 
+    delete m_compressor;
+    delete m_decompressor;
     s_instance = nullptr;
 }
 
@@ -91,11 +109,52 @@ void Endpoint::sendMessage(const Message &msg)
 void Endpoint::doSendMessage(const GammaRay::Message &msg)
 {
     Q_ASSERT(msg.address() != Protocol::InvalidObjectAddress);
-    msg.write(m_socket);
+    msg.write(&m_sendBuffer, m_compressor);
+    if (m_sendBuffer.size() >= MaxSendBufferSize)
+        flush();
+    else if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void Endpoint::flush()
+{
+    m_flushTimer->stop();
+    if (m_sendBuffer.isEmpty())
+        return;
+
+    if (m_socket) {
+        const int s = m_socket->write(m_sendBuffer);
+        Q_ASSERT(s == m_sendBuffer.size());
+        Q_UNUSED(s);
+
+        // measure the link while it is saturated, that's when compression pays off
+        const qint64 backlog = m_socket->bytesToWrite();
+        qint64 throughput = -1;
+        if (backlog == 0 || !m_throughputTimer.isValid()) {
+            m_throughputTimer.start();
+            m_bytesDrained = 0;
+        } else if (m_throughputTimer.elapsed() >= 100) {
+            throughput = m_bytesDrained * 1000 / m_throughputTimer.restart();
+            m_bytesDrained = 0;
+        }
+        if (m_compressor)
+            m_compressor->adapt(backlog, throughput);
+    }
+    // keep the allocation for the next batch, unless this was an unusually large one
+    if (m_sendBuffer.capacity() > 2 * MaxSendBufferSize)
+        m_sendBuffer.clear();
+    else
+        m_sendBuffer.resize(0);
+}
+
+void Endpoint::setMaxSendLatency(int msecs)
+{
+    m_flushTimer->setInterval(qMax(0, msecs));
 }
 
 void Endpoint::waitForMessagesWritten()
 {
+    flush();
     m_socket->waitForBytesWritten(-1);
 }
 
@@ -104,6 +163,18 @@ bool Endpoint::isConnected()
     return s_instance && s_instance->m_socket;
 }
 
+Protocol::PayloadEncoding Endpoint::payloadEncoding()
+{
+    if (!s_instance)
+        return Protocol::DataStreamEncoding;
+    return s_instance->m_payloadEncoding;
+}
+
+void Endpoint::setPayloadEncoding(Protocol::PayloadEncoding encoding)
+{
+    m_payloadEncoding = encoding;
+}
+
 quint16 Endpoint::defaultPort()
 {
     return 11732;
@@ -119,7 +190,19 @@ void Endpoint::setDevice(QIODevice *device)
     Q_ASSERT(!m_socket);
     Q_ASSERT(device);
     m_socket = device;
+    m_receiveBuffer.clear();
+    m_receiveOffset = 0;
+
+    // fresh stream state for each connection
+    delete m_compressor;
+    m_compressor = new MessageCompressor;
+    delete m_decompressor;
+    m_decompressor = new MessageDecompressor;
+    m_throughputTimer.invalidate();
+    m_propertySyncer->resetPeerState();
+
     connect(m_socket.data(), SIGNAL(readyRead()), SLOT(readyRead()));
+    connect(m_socket.data(), SIGNAL(bytesWritten(qint64)), SLOT(bytesWritten(qint64)));
     connect(m_socket.data(), SIGNAL(disconnected()), SLOT(connectionClosed()));
     if (m_socket->bytesAvailable())
         readyRead();
@@ -132,15 +215,38 @@ Protocol::ObjectAddress Endpoint::endpointAddress() const
 
 void Endpoint::readyRead()
 {
-    while (Message::canReadMessage(m_socket.data()))
-        messageReceived(Message::readMessage(m_socket.data()));
+    if (m_socket)
+        m_receiveBuffer.append(m_socket->readAll());
+
+    // the offset is a member, as message handlers might re-enter the event loop
+    while (Message::canReadMessage(m_receiveBuffer, m_receiveOffset))
+        messageReceived(Message::readMessage(m_receiveBuffer, &m_receiveOffset, m_decompressor));
+
+    if (m_receiveOffset == m_receiveBuffer.size()) {
+        m_receiveBuffer.resize(0);
+        m_receiveOffset = 0;
+    } else if (m_receiveOffset > m_receiveBuffer.size() / 2) {
+        m_receiveBuffer.remove(0, m_receiveOffset);
+        m_receiveOffset = 0;
+    }
+}
+
+void Endpoint::bytesWritten(qint64 bytes)
+{
+    m_bytesDrained += bytes;
 }
 
 void Endpoint::connectionClosed()
 {
     disconnect(m_socket.data(), SIGNAL(readyRead()), this, SLOT(readyRead()));
     disconnect(m_socket.data(), SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+    disconnect(m_socket.data(), SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten(qint64)));
     m_socket = nullptr;
+    m_payloadEncoding = Protocol::DataStreamEncoding;
+    m_flushTimer->stop();
+    m_sendBuffer.clear();
+    m_receiveBuffer.clear();
+    m_receiveOffset = 0;
     emit disconnected();
 }
 
@@ -190,6 +296,9 @@ void Endpoint::invokeObject(const QString &objectName, const char *method,
     if (!obj || obj->address == Protocol::InvalidObjectAddress)
         return;
 
+    // the call might depend on property changes not sent yet
+    m_propertySyncer->flushPendingChanges(obj->address);
+
     Message msg(obj->address, Protocol::MethodCall);
     const QByteArray name(method);
     Q_ASSERT(!name.isEmpty());
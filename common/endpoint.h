@@ -32,17 +32,21 @@
 #include "gammaray_common_export.h"
 #include "protocol.h"
 
+#include <QElapsedTimer>
 #include <QMetaMethod>
 #include <QObject>
 #include <QPointer>
 
 QT_BEGIN_NAMESPACE
 class QIODevice;
+class QTimer;
 class QUrl;
 QT_END_NAMESPACE
 
 namespace GammaRay {
 class Message;
+class MessageCompressor;
+class MessageDecompressor;
 class PropertySyncer;
 
 /** @brief Network protocol endpoint.
@@ -63,6 +67,11 @@ public:
     /** Returns @c true if we are currently connected to another endpoint. */
     static bool isConnected();
 
+    /** The payload encoding for model content messages negotiated with the other endpoint.
+     *  @since 2.7
+     */
+    static Protocol::PayloadEncoding payloadEncoding();
+
     static quint16 defaultPort();
     static quint16 broadcastPort();
 
@@ -96,6 +105,14 @@ public:
      */
     void waitForMessagesWritten();
 
+    /**
+     * Maximum time in milliseconds outgoing messages are held back to be written
+     * together with subsequent ones. The default of 0 batches all messages sent
+     * within one event loop iteration.
+     * @since 2.7
+     */
+    void setMaxSendLatency(int msecs);
+
     /**
      * Returns a human-readable string describing the host program.
      */
@@ -140,6 +157,11 @@ public slots:
     /** Convenience overload of send(), to directly send message delivered via signals. */
     void sendMessage(const GammaRay::Message &msg);
 
+    /** Write all batched messages to the device now.
+     *  @since 2.7
+     */
+    void flush();
+
 signals:
     /** Emitted when a connection to another endpoint was successfully established and passed the protocol version handshake step. */
     void connectionEstablished();
@@ -158,6 +180,9 @@ protected:
     /** The object address of the other endpoint. */
     Protocol::ObjectAddress endpointAddress() const;
 
+    /** Call once both sides agreed on a payload encoding, reset on disconnect. */
+    void setPayloadEncoding(Protocol::PayloadEncoding encoding);
+
     /** Called for every incoming message.
      *  @see dispatchMessage().
      */
@@ -200,6 +225,7 @@ protected:
 
 private slots:
     void readyRead();
+    void bytesWritten(qint64 bytes);
     void connectionClosed();
     void handlerDestroyed(QObject *obj);
     void objectDestroyed(QObject *obj);
@@ -236,6 +262,19 @@ private:
 
     QPointer<QIODevice> m_socket;
     Protocol::ObjectAddress m_myAddress;
+    Protocol::PayloadEncoding m_payloadEncoding;
+
+    // outgoing messages not written yet, and incoming data not decoded yet
+    QByteArray m_sendBuffer;
+    QTimer *m_flushTimer;
+    QByteArray m_receiveBuffer;
+    int m_receiveOffset;
+
+    // per-connection compression state, and link throughput measurement for adapting it
+    MessageCompressor *m_compressor;
+    MessageDecompressor *m_decompressor;
+    QElapsedTimer m_throughputTimer;
+    qint64 m_bytesDrained;
 
     QString m_label;
     QString m_key;
@@ -27,44 +27,14 @@
 */
 
 #include "message.h"
-
-#include "lz4/lz4.h" // 3rdparty
+#include "messagecompressor.h"
 
 #include <QDebug>
 #include <qendian.h>
 
-inline QByteArray compress(const QByteArray &src)
-{
-    const qint32 srcSz = src.size();
-
-    QByteArray dst;
-    dst.resize(LZ4_compressBound(srcSz + sizeof(srcSz)));
-    *(qint32 *)dst.data() = srcSz; // save the source size
-
-    const int sz
-        = LZ4_compress_default(src.constData(), dst.data() + sizeof(int), srcSz, dst.size());
-    dst.resize(sz + sizeof(srcSz));
-    return dst;
-}
-
-inline QByteArray uncompress(const QByteArray &src)
-{
-    const qint32 dstSz = *(const qint32 *)src.constData(); // get the dest size
-    QByteArray dst;
-    dst.resize(dstSz);
-    const int sz = LZ4_decompress_safe(src.constData() + sizeof(dstSz), dst.data(),
-                                       src.size()- sizeof(dstSz), dstSz);
-    if (sz <= 0)
-        dst.resize(0);
-    else
-        dst.resize(sz);
-    return dst;
-}
+#include <cstring>
 
 static const QDataStream::Version StreamVersion = QDataStream::Qt_4_7;
-#ifdef ENABLE_MESSAGE_COMPRESSSION
-static const int minimumUncompressedSize = 32;
-#endif
 
 #if QT_VERSION < 0x040800
 // This template-specialization is missing in qendian.h, required for qFromBigEndian
@@ -75,6 +45,9 @@ template<> inline quint8 qbswap<quint8>(quint8 source)
 
 #endif
 
+static const int HeaderSize = sizeof(Protocol::PayloadSize) + sizeof(Protocol::ObjectAddress)
+                             + sizeof(Protocol::MessageType);
+
 template<typename T> static T readNumber(QIODevice *device)
 {
     T buffer;
@@ -84,12 +57,17 @@ template<typename T> static T readNumber(QIODevice *device)
     return qFromBigEndian(buffer);
 }
 
-template<typename T> static void writeNumber(QIODevice *device, T value)
+template<typename T> static T readNumber(const char *data)
+{
+    T buffer;
+    memcpy(&buffer, data, sizeof(T));
+    return qFromBigEndian(buffer);
+}
+
+template<typename T> static void writeNumber(QByteArray *buffer, T value)
 {
     value = qToBigEndian(value);
-    const int writeSize = device->write((char *)&value, sizeof(T));
-    Q_UNUSED(writeSize);
-    Q_ASSERT(writeSize == sizeof(T));
+    buffer->append((const char *)&value, sizeof(T));
 }
 
 using namespace GammaRay;
@@ -148,9 +126,7 @@ bool Message::canReadMessage(QIODevice *device)
     if (!device)
         return false;
 
-    static const int minimumSize = sizeof(Protocol::PayloadSize) + sizeof(Protocol::ObjectAddress)
-                                   + sizeof(Protocol::MessageType);
-    if (device->bytesAvailable() < minimumSize)
+    if (device->bytesAvailable() < HeaderSize)
         return false;
 
     Protocol::PayloadSize payloadSize;
@@ -162,7 +138,7 @@ bool Message::canReadMessage(QIODevice *device)
         return false;
 
     payloadSize = abs(qFromBigEndian(payloadSize));
-    return device->bytesAvailable() >= payloadSize + minimumSize;
+    return device->bytesAvailable() >= payloadSize + HeaderSize;
 }
 
 Message Message::readMessage(QIODevice *device)
@@ -178,7 +154,10 @@ Message Message::readMessage(QIODevice *device)
     if (payloadSize < 0) {
         payloadSize = abs(payloadSize);
         QByteArray buff = device->read(payloadSize);
-        msg.m_buffer = uncompress(buff);
+        // without a decompressor we don't have the stream history, that's only enough for the first message
+        MessageDecompressor decompressor;
+        if (!decompressor.decompress(buff.constData(), buff.size(), &msg.m_buffer))
+            qWarning("%s: Failed to decompress message payload.", Q_FUNC_INFO);
         Q_ASSERT(payloadSize == buff.size());
     } else {
         if (payloadSize > 0) {
@@ -189,43 +168,86 @@ Message Message::readMessage(QIODevice *device)
     return msg;
 }
 
+bool Message::canReadMessage(const QByteArray &buffer, int offset)
+{
+    if (buffer.size() - offset < HeaderSize)
+        return false;
+
+    const Protocol::PayloadSize payloadSize
+        = abs(readNumber<Protocol::PayloadSize>(buffer.constData() + offset));
+    return buffer.size() - offset >= payloadSize + HeaderSize;
+}
+
+Message Message::readMessage(const QByteArray &buffer, int *offset,
+                             MessageDecompressor *decompressor)
+{
+    Message msg;
+
+    const char *data = buffer.constData() + *offset;
+    Protocol::PayloadSize payloadSize = readNumber<Protocol::PayloadSize>(data);
+    data += sizeof(Protocol::PayloadSize);
+    msg.m_objectAddress = readNumber<Protocol::ObjectAddress>(data);
+    data += sizeof(Protocol::ObjectAddress);
+    msg.m_messageType = readNumber<Protocol::MessageType>(data);
+    data += sizeof(Protocol::MessageType);
+    Q_ASSERT(msg.m_messageType != Protocol::InvalidMessageType);
+    Q_ASSERT(msg.m_objectAddress != Protocol::InvalidObjectAddress);
+
+    if (payloadSize < 0) {
+        payloadSize = abs(payloadSize);
+        Q_ASSERT(decompressor);
+        if (!decompressor || !decompressor->decompress(data, payloadSize, &msg.m_buffer))
+            qWarning("%s: Failed to decompress message payload.", Q_FUNC_INFO);
+    } else if (payloadSize > 0) {
+        msg.m_buffer = QByteArray(data, payloadSize);
+    }
+    Q_ASSERT(*offset + HeaderSize + payloadSize <= buffer.size());
+    *offset += HeaderSize + payloadSize;
+    return msg;
+}
+
 void Message::write(QIODevice *device) const
 {
-    Q_ASSERT(m_objectAddress != Protocol::InvalidObjectAddress);
-    Q_ASSERT(m_messageType != Protocol::InvalidMessageType);
-    const int buffSize = m_buffer.size();
-#ifdef ENABLE_MESSAGE_COMPRESSSION
-    QByteArray buff;
-    if (buffSize > minimumUncompressedSize)
-        buff = compress(m_buffer);
-
-    if (buff.size() && buff.size() < buffSize)
-        writeNumber<Protocol::PayloadSize>(device, -buff.size()); // send compressed Buffer
-    else
-#endif
-    writeNumber<Protocol::PayloadSize>(device, buffSize);   // send uncompressed Buffer
-
-    writeNumber(device, m_objectAddress);
-    writeNumber(device, m_messageType);
-
-#ifdef ENABLE_MESSAGE_COMPRESSSION
-    if (buffSize) {
-        if (buff.size() && buff.size() < buffSize) {
-            const int s = device->write(buff);
-            Q_ASSERT(s == buff.size());
-            Q_UNUSED(s);
-        } else {
-#endif
-    const int s = device->write(m_buffer);
-    Q_ASSERT(s == m_buffer.size());
+    QByteArray buffer;
+    write(&buffer);
+    const int s = device->write(buffer);
+    Q_ASSERT(s == buffer.size());
     Q_UNUSED(s);
-#ifdef ENABLE_MESSAGE_COMPRESSSION
 }
-}
-#endif
+
+void Message::write(QByteArray *buffer, MessageCompressor *compressor) const
+{
+    Q_ASSERT(m_objectAddress != Protocol::InvalidObjectAddress);
+    Q_ASSERT(m_messageType != Protocol::InvalidMessageType);
+
+    const int offset = buffer->size();
+    buffer->reserve(offset + HeaderSize + m_buffer.size());
+    writeNumber<Protocol::PayloadSize>(buffer, m_buffer.size()); // patched below if compressed
+    writeNumber(buffer, m_objectAddress);
+    writeNumber(buffer, m_messageType);
+
+    const int compressedSize = compressor ? compressor->compress(m_buffer, buffer) : -1;
+    if (compressedSize >= 0) {
+        const Protocol::PayloadSize size = qToBigEndian<Protocol::PayloadSize>(-compressedSize);
+        memcpy(buffer->data() + offset, &size, sizeof(size));
+    } else {
+        buffer->append(m_buffer);
+    }
 }
 
 int Message::size() const
 {
     return m_buffer.size();
 }
+
+QByteArray &Message::rawPayload()
+{
+    Q_ASSERT(!m_stream);
+    return m_buffer;
+}
+
+const QByteArray &Message::rawPayload() const
+{
+    Q_ASSERT(!m_stream);
+    return m_buffer;
+}
@@ -36,13 +36,18 @@
 #include <QDataStream>
 
 namespace GammaRay {
+class MessageCompressor;
+class MessageDecompressor;
+
 /**
  * Single message send between client and server.
  * Binary format:
- * - sizeof(Protocol::PayloadSize) byte size of the message payload (not including the size and other fixed fields itself) in netowork byte order (big endian)
+ * - sizeof(Protocol::PayloadSize) byte size of the message payload (not including the size and other fixed fields itself) in netowork byte order (big endian),
+ *   negative if the payload is LZ4 stream compressed (see MessageCompressor)
  * - sizeof(Protocol::ObjectAddress) server object address (big endian)
  * - sizeof(Protocol::MessageType) command type (big endian)
- * - size bytes message payload (encoding is user defined, QDataStream provided for convenience)
+ * - size bytes message payload (encoding is user defined, QDataStream provided for convenience,
+ *   see CompactPayloadWriter for a faster alternative)
  */
 class GAMMARAY_COMMON_EXPORT Message
 {
@@ -111,12 +116,36 @@ public:
     /** Read the next message from @p device. */
     static Message readMessage(QIODevice *device);
 
+    /** Checks if there is a full message in @p buffer starting at @p offset.
+     *  @since 2.7
+     */
+    static bool canReadMessage(const QByteArray &buffer, int offset);
+    /** Read the message starting at @p offset in @p buffer, and advance @p offset behind it.
+     *  This allows to decode any number of messages received in one go without touching the device.
+     *  @p decompressor is needed if the other side used a MessageCompressor.
+     *  @since 2.7
+     */
+    static Message readMessage(const QByteArray &buffer, int *offset,
+                               MessageDecompressor *decompressor = nullptr);
+
     /** Write this message to @p device. */
     void write(QIODevice *device) const;
+    /** Append this message to @p buffer, for writing several messages at once.
+     *  If @p compressor is given, it decides whether to compress the payload.
+     *  @since 2.7
+     */
+    void write(QByteArray *buffer, MessageCompressor *compressor = nullptr) const;
 
     /** Size of the uncompressed message payload. */
     int size() const;
 
+    /** Direct access to the payload buffer, for encodings other than QDataStream.
+     *  Must not be mixed with the stream operators on the same message.
+     *  @since 2.7
+     */
+    QByteArray &rawPayload();
+    const QByteArray &rawPayload() const;
+
 private:
     Message();
 
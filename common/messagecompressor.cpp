@@ -0,0 +1,214 @@
+/*
+  messagecompressor.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "messagecompressor.h"
+
+#include "lz4/lz4.h" // 3rdparty
+
+#include <qendian.h>
+
+#include <cstring>
+
+using namespace GammaRay;
+
+static const int DictionarySize = 64 * 1024; // maximum LZ4 back-reference distance
+static const int BlockSize = 64 * 1024;
+// history of the stream, compressor and decompressor use the same layout (see lz4.h)
+static const int RingBufferSize = 4 * DictionarySize;
+static const int MinimumUncompressedSize = 32;
+static const int FastAcceleration = 8;
+
+// link throughput thresholds in bytes/second, below which we compress harder
+static const qint64 StrongThroughput = 1024 * 1024;
+static const qint64 FastThroughput = 16 * 1024 * 1024;
+// consecutive writes without backlog before relaxing the compression level
+static const int IdleWritesBeforeRelaxing = 64;
+
+namespace GammaRay {
+struct MessageCompressorState
+{
+    LZ4_stream_t stream;
+    char ringBuffer[RingBufferSize];
+    int ringOffset;
+};
+
+struct MessageDecompressorState
+{
+    LZ4_streamDecode_t stream;
+    char ringBuffer[RingBufferSize];
+    int ringOffset;
+};
+}
+
+// position of the next block of @p blockSize bytes in the ring buffer, same rule on both ends
+static int ringPosition(int ringOffset, int blockSize)
+{
+    return ringOffset + blockSize > RingBufferSize ? 0 : ringOffset;
+}
+
+MessageCompressor::MessageCompressor()
+    : m_state(new MessageCompressorState)
+#ifdef ENABLE_MESSAGE_COMPRESSSION
+    , m_level(Fast)
+#else
+    , m_level(Raw)
+#endif
+    , m_idleCount(0)
+{
+    LZ4_resetStream(&m_state->stream);
+    m_state->ringOffset = 0;
+}
+
+MessageCompressor::~MessageCompressor()
+{
+    delete m_state;
+}
+
+MessageCompressor::Level MessageCompressor::level() const
+{
+    return m_level;
+}
+
+void MessageCompressor::setLevel(MessageCompressor::Level level)
+{
+    m_level = level;
+}
+
+int MessageCompressor::compress(const QByteArray &data, QByteArray *buffer)
+{
+    if (m_level == Raw || data.size() < MinimumUncompressedSize)
+        return -1;
+
+    // once data entered the stream history it has to be sent compressed, regardless of the ratio
+    // layout: uncompressed size, followed by compressed size and content of each block
+    const int offset = buffer->size();
+    const int blockCount = (data.size() + BlockSize - 1) / BlockSize;
+    buffer->resize(offset + sizeof(qint32) * (blockCount + 1)
+                   + blockCount * LZ4_compressBound(BlockSize));
+    int pos = offset;
+    const qint32 size = qToBigEndian<qint32>(data.size());
+    memcpy(buffer->data() + pos, &size, sizeof(size));
+    pos += sizeof(size);
+
+    for (int from = 0; from < data.size(); from += BlockSize) {
+        const int blockSize = qMin(BlockSize, data.size() - from);
+        // the stream refers to previous blocks where they were compressed, so they must stay put
+        char *src = m_state->ringBuffer + ringPosition(m_state->ringOffset, blockSize);
+        memcpy(src, data.constData() + from, blockSize);
+        m_state->ringOffset = src - m_state->ringBuffer + blockSize;
+
+        const int bound = LZ4_compressBound(blockSize);
+        const int compressedSize = LZ4_compress_fast_continue(&m_state->stream, src,
+                                                              buffer->data() + pos + sizeof(qint32),
+                                                              blockSize, bound,
+                                                              m_level == Fast ? FastAcceleration : 1);
+        Q_ASSERT(compressedSize > 0);
+        const qint32 blockHeader = qToBigEndian<qint32>(compressedSize);
+        memcpy(buffer->data() + pos, &blockHeader, sizeof(blockHeader));
+        pos += sizeof(blockHeader) + compressedSize;
+    }
+
+    buffer->resize(pos);
+    return pos - offset;
+}
+
+void MessageCompressor::adapt(qint64 backlog, qint64 throughput)
+{
+    if (backlog == 0) {
+        // the link keeps up with us, slowly trade ratio for latency again
+        if (m_level != Raw && ++m_idleCount >= IdleWritesBeforeRelaxing) {
+            m_level = static_cast<Level>(m_level - 1);
+            m_idleCount = 0;
+        }
+        return;
+    }
+
+    m_idleCount = 0;
+    if (throughput < 0)
+        return;
+    if (throughput < StrongThroughput)
+        m_level = Strong;
+    else if (throughput < FastThroughput && m_level == Raw)
+        m_level = Fast;
+}
+
+MessageDecompressor::MessageDecompressor()
+    : m_state(new MessageDecompressorState)
+{
+    LZ4_setStreamDecode(&m_state->stream, nullptr, 0);
+    m_state->ringOffset = 0;
+}
+
+MessageDecompressor::~MessageDecompressor()
+{
+    delete m_state;
+}
+
+static bool readSize(const char *&data, const char *end, qint32 *size)
+{
+    if (end - data < static_cast<int>(sizeof(qint32)))
+        return false;
+    memcpy(size, data, sizeof(qint32));
+    *size = qFromBigEndian(*size);
+    data += sizeof(qint32);
+    return *size >= 0;
+}
+
+bool MessageDecompressor::decompress(const char *data, int size, QByteArray *buffer)
+{
+    const char *end = data + size;
+    qint32 uncompressedSize;
+    if (!readSize(data, end, &uncompressedSize))
+        return false;
+    // each block has a size header at least
+    const qint64 blockCount = (static_cast<qint64>(uncompressedSize) + BlockSize - 1) / BlockSize;
+    if (blockCount * static_cast<qint64>(sizeof(qint32)) > end - data)
+        return false;
+
+    buffer->resize(uncompressedSize);
+    for (int to = 0; to < uncompressedSize; to += BlockSize) {
+        const int blockSize = qMin(BlockSize, uncompressedSize - to);
+        qint32 compressedSize;
+        if (!readSize(data, end, &compressedSize) || compressedSize > end - data) {
+            buffer->clear();
+            return false;
+        }
+
+        // decompress in place in our copy of the compressor's history
+        char *dst = m_state->ringBuffer + ringPosition(m_state->ringOffset, blockSize);
+        const int s = LZ4_decompress_safe_continue(&m_state->stream, data, dst,
+                                                   compressedSize, blockSize);
+        if (s != blockSize) {
+            buffer->clear();
+            return false;
+        }
+        m_state->ringOffset = dst - m_state->ringBuffer + blockSize;
+        memcpy(buffer->data() + to, dst, blockSize);
+        data += compressedSize;
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+  messagecompressor.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_MESSAGECOMPRESSOR_H
+#define GAMMARAY_MESSAGECOMPRESSOR_H
+
+#include "gammaray_common_export.h"
+
+#include <QByteArray>
+
+namespace GammaRay {
+struct MessageCompressorState;
+struct MessageDecompressorState;
+
+/**
+ * Per-connection LZ4 stream compression of message payloads.
+ *
+ * All compressed payloads of a connection form one LZ4 stream, so later messages can
+ * reference the previous 64kB, which is what makes small and repetitive messages compress.
+ * Payloads are copied into a ring buffer for this, and compressed in blocks of at most 64kB.
+ * The compression level adapts to the throughput of the link, see adapt().
+ */
+class GAMMARAY_COMMON_EXPORT MessageCompressor
+{
+public:
+    enum Level {
+        Raw, ///< no compression
+        Fast, ///< high LZ4 acceleration
+        Strong ///< default LZ4 acceleration, best ratio available
+    };
+
+    MessageCompressor();
+    ~MessageCompressor();
+
+    Level level() const;
+    void setLevel(Level level);
+
+    /**
+     * Appends the compressed form of @p data to @p buffer.
+     * @returns the number of bytes appended, or -1 if @p data was not compressed
+     * (level Raw, or too small to be worth it), in which case the stream state is unchanged.
+     */
+    int compress(const QByteArray &data, QByteArray *buffer);
+
+    /**
+     * Adjusts the compression level to the link.
+     * @param backlog The amount of data still waiting to be written to the device.
+     * @param throughput Write rate in bytes/second measured while there was a backlog, -1 if unknown.
+     */
+    void adapt(qint64 backlog, qint64 throughput);
+
+private:
+    Q_DISABLE_COPY(MessageCompressor)
+    MessageCompressorState *m_state;
+    Level m_level;
+    int m_idleCount;
+};
+
+/** Counterpart to MessageCompressor, needs to see the compressed payloads in the same order. */
+class GAMMARAY_COMMON_EXPORT MessageDecompressor
+{
+public:
+    MessageDecompressor();
+    ~MessageDecompressor();
+
+    /** Decompresses the payload at @p data into @p buffer. Returns @c false on malformed input. */
+    bool decompress(const char *data, int size, QByteArray *buffer);
+
+private:
+    Q_DISABLE_COPY(MessageDecompressor)
+    MessageDecompressorState *m_state;
+};
+}
+
+#endif // GAMMARAY_MESSAGECOMPRESSOR_H
@@ -58,6 +58,11 @@ Q_DECLARE_METATYPE(QMetaMethod::Access)
 Q_DECLARE_METATYPE(QMetaMethod::MethodType)
 Q_DECLARE_METATYPE(const QMetaObject *)
 
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#include <QVector>
+Q_DECLARE_METATYPE(QVector<qlonglong>)
+#endif
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
 #include <QTimeZone>
 Q_DECLARE_METATYPE(QTimeZone)
@@ -27,8 +27,11 @@
 */
 
 #include "modelutils.h"
+#include "metatypedeclarations.h"
 
 #include <QAbstractItemModel>
+#include <QStringList>
+#include <QVector>
 
 using namespace GammaRay;
 
@@ -73,3 +76,67 @@ QModelIndexList ModelUtils::match(const QModelIndex &start, int role, MatchAccep
 
     return result;
 }
+
+template<typename T>
+static bool appendTo(QVariant &value, const QVariant &tail)
+{
+    T list = value.value<T>();
+    value = QVariant(); // avoid detaching the shared data on append
+    list += tail.value<T>();
+    value = QVariant::fromValue(list);
+    return true;
+}
+
+int ModelUtils::appendableSize(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::QVariantList:
+        return value.toList().size();
+    case QMetaType::QStringList:
+        return value.toStringList().size();
+    case QMetaType::QByteArray:
+        return value.toByteArray().size();
+    default:
+        break;
+    }
+    if (value.userType() == qMetaTypeId<QVector<qlonglong> >())
+        return value.value<QVector<qlonglong> >().size();
+    return -1;
+}
+
+QVariant ModelUtils::appendableMid(const QVariant &value, int from)
+{
+    switch (value.userType()) {
+    case QMetaType::QVariantList:
+        return value.toList().mid(from);
+    case QMetaType::QStringList:
+        return value.toStringList().mid(from);
+    case QMetaType::QByteArray:
+        return value.toByteArray().mid(from);
+    default:
+        break;
+    }
+    if (value.userType() == qMetaTypeId<QVector<qlonglong> >())
+        return QVariant::fromValue(value.value<QVector<qlonglong> >().mid(from));
+    return QVariant();
+}
+
+bool ModelUtils::appendableAppend(QVariant &value, const QVariant &tail)
+{
+    if (value.userType() != tail.userType())
+        return false;
+
+    switch (value.userType()) {
+    case QMetaType::QVariantList:
+        return appendTo<QVariantList>(value, tail);
+    case QMetaType::QStringList:
+        return appendTo<QStringList>(value, tail);
+    case QMetaType::QByteArray:
+        return appendTo<QByteArray>(value, tail);
+    default:
+        break;
+    }
+    if (value.userType() == qMetaTypeId<QVector<qlonglong> >())
+        return appendTo<QVector<qlonglong> >(value, tail);
+    return false;
+}
@@ -32,6 +32,7 @@
 #include "gammaray_common_export.h"
 
 #include <QModelIndex>
+#include <QVariant>
 
 namespace GammaRay {
 namespace ModelUtils {
@@ -50,6 +51,17 @@ typedef bool (*MatchAcceptor)(const QVariant &);
 GAMMARAY_COMMON_EXPORT QModelIndexList match(const QModelIndex &start, int role,
                                              MatchAcceptor accept, int hits = 1,
                                              Qt::MatchFlags flags = Qt::MatchFlags(Qt::MatchWrap));
+
+/**
+ * Number of elements in @p value, for values of roles changed with
+ * RemoteModelRole::AppendOnly. Supported are QVariantList, QStringList, QByteArray
+ * and QVector<qlonglong>, -1 is returned for any other type.
+ */
+GAMMARAY_COMMON_EXPORT int appendableSize(const QVariant &value);
+/** The elements of @p value starting at @p from, with the same type as @p value. */
+GAMMARAY_COMMON_EXPORT QVariant appendableMid(const QVariant &value, int from);
+/** Appends the elements of @p tail to @p value, returns @c false if the types don't match. */
+GAMMARAY_COMMON_EXPORT bool appendableAppend(QVariant &value, const QVariant &tail);
 }
 }
 
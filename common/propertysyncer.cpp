@@ -31,8 +31,7 @@
 
 #include <QDebug>
 #include <QMetaProperty>
-
-#include <algorithm>
+#include <QTimer>
 
 using namespace GammaRay;
 
@@ -43,9 +42,13 @@ static int qobjectPropertyOffset()
 
 PropertySyncer::PropertySyncer(QObject *parent)
     : QObject(parent)
+    , m_sendTimer(new QTimer(this))
     , m_address(Protocol::InvalidObjectAddress)
     , m_initialSync(false)
 {
+    m_sendTimer->setSingleShot(true);
+    m_sendTimer->setInterval(0);
+    connect(m_sendTimer, SIGNAL(timeout()), this, SLOT(sendPendingChanges()));
 }
 
 PropertySyncer::~PropertySyncer()
@@ -57,6 +60,43 @@ void PropertySyncer::setRequestInitialSync(bool initialSync)
     m_initialSync = initialSync;
 }
 
+void PropertySyncer::resetPeerState()
+{
+    for (auto it = m_classes.begin(); it != m_classes.end(); ++it)
+        (*it).announced = false;
+    m_remoteClasses.clear();
+}
+
+void PropertySyncer::flushPendingChanges(Protocol::ObjectAddress addr)
+{
+    const auto index = m_pendingObjects.indexOf(addr);
+    if (index < 0)
+        return;
+    m_pendingObjects.remove(index);
+    sendValues(QVector<Protocol::ObjectAddress>() << addr, false);
+}
+
+int PropertySyncer::classId(const QMetaObject *mo)
+{
+    const auto it = m_classIds.constFind(mo);
+    if (it != m_classIds.constEnd())
+        return it.value();
+
+    ClassInfo info;
+    info.mo = mo;
+    info.announced = false;
+    for (int i = qobjectPropertyOffset(); i < mo->propertyCount(); ++i) {
+        const auto prop = mo->property(i);
+        if (prop.hasNotifySignal())
+            info.notifyProperties[prop.notifySignalIndex()].push_back(i - qobjectPropertyOffset());
+    }
+
+    const int id = m_classes.size();
+    m_classes.push_back(info);
+    m_classIds.insert(mo, id);
+    return id;
+}
+
 void PropertySyncer::addObject(Protocol::ObjectAddress addr, QObject *obj)
 {
     Q_ASSERT(addr != Protocol::InvalidObjectAddress);
@@ -64,39 +104,39 @@ void PropertySyncer::addObject(Protocol::ObjectAddress addr, QObject *obj)
     if (qobjectPropertyOffset() == obj->metaObject()->propertyCount())
         return; // no properties we could sync
 
-    for (int i = qobjectPropertyOffset(); i < obj->metaObject()->propertyCount(); ++i) {
-        const auto prop = obj->metaObject()->property(i);
-        if (!prop.hasNotifySignal())
-            continue;
+    ObjectInfo info;
+    info.obj = obj;
+    info.classId = classId(obj->metaObject());
+    info.recursionLock = false;
+    info.enabled = false;
+
+    // one connection per signal, no matter how many properties share it
+    const auto &notifyProperties = m_classes.at(info.classId).notifyProperties;
+    for (auto it = notifyProperties.constBegin(); it != notifyProperties.constEnd(); ++it) {
+        const auto method = obj->metaObject()->method(it.key());
         connect(obj, QByteArray("2") +
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-                prop.notifySignal().signature()
+                method.signature()
 #else
-                prop.notifySignal().methodSignature()
+                method.methodSignature()
 #endif
                 , this, SLOT(propertyChanged()));
     }
 
     connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
 
-    ObjectInfo info;
-    info.addr = addr;
-    info.obj = obj;
-    info.recursionLock = false;
-    info.enabled = false;
-    m_objects.push_back(info);
+    m_objects.insert(addr, info);
+    m_objectAddresses.insert(obj, addr);
 }
 
 void PropertySyncer::setObjectEnabled(Protocol::ObjectAddress addr, bool enabled)
 {
-    const auto it = std::find_if(m_objects.begin(), m_objects.end(), [addr](
-                                     const ObjectInfo &info) {
-        return info.addr == addr;
-    });
+    const auto it = m_objects.find(addr);
     if (it == m_objects.end() || (*it).enabled == enabled)
         return;
 
     (*it).enabled = enabled;
+    (*it).pendingProperties.clear();
     if (enabled && m_initialSync) {
         Message msg(m_address, Protocol::PropertySyncRequest);
         msg << addr;
@@ -114,6 +154,22 @@ void PropertySyncer::setAddress(Protocol::ObjectAddress addr)
     m_address = addr;
 }
 
+int PropertySyncer::remotePropertyIndex(RemoteClassInfo &remoteClass, QObject *obj,
+                                        quint16 propId)
+{
+    const auto mo = obj->metaObject();
+    if (remoteClass.mo != mo) {
+        remoteClass.mo = mo;
+        remoteClass.propertyIndexes.clear();
+        remoteClass.propertyIndexes.reserve(remoteClass.propertyNames.size());
+        foreach (const auto &name, remoteClass.propertyNames)
+            remoteClass.propertyIndexes.push_back(mo->indexOfProperty(name));
+    }
+    if (propId >= remoteClass.propertyIndexes.size())
+        return -1;
+    return remoteClass.propertyIndexes.at(propId);
+}
+
 void PropertySyncer::handleMessage(const GammaRay::Message &msg)
 {
     Q_ASSERT(msg.address() == m_address);
@@ -123,58 +179,65 @@ void PropertySyncer::handleMessage(const GammaRay::Message &msg)
         Protocol::ObjectAddress addr;
         msg >> addr;
         Q_ASSERT(addr != Protocol::InvalidObjectAddress);
-
-        const auto it
-            = std::find_if(m_objects.constBegin(), m_objects.constEnd(),
-                           [addr](const ObjectInfo &info) {
-                return info.addr == addr;
-            });
-        if (it == m_objects.constEnd())
-            break;
-
-        QVector<QPair<QByteArray, QVariant> > values;
-        const auto propCount = (*it).obj->metaObject()->propertyCount();
-        values.reserve(propCount);
-        for (int i = qobjectPropertyOffset(); i < propCount; ++i) {
-            const auto prop = (*it).obj->metaObject()->property(i);
-            values.push_back(qMakePair(QByteArray(prop.name()), prop.read((*it).obj)));
-        }
-        Q_ASSERT(!values.isEmpty());
-
-        Message msg(m_address, Protocol::PropertyValuesChanged);
-        msg << addr << (quint32)values.size();
-        foreach (const auto &value, values)
-            msg << value.first << value.second;
-        emit message(msg);
+        sendValues(QVector<Protocol::ObjectAddress>() << addr, true);
         break;
     }
     case Protocol::PropertyValuesChanged:
     {
-        Protocol::ObjectAddress addr;
-        quint32 changeSize;
-        msg >> addr >> changeSize;
-        Q_ASSERT(addr != Protocol::InvalidObjectAddress);
-        Q_ASSERT(changeSize > 0);
+        quint16 classCount;
+        msg >> classCount;
+        for (quint16 i = 0; i < classCount; ++i) {
+            quint16 remoteClassId;
+            RemoteClassInfo remoteClass;
+            msg >> remoteClassId >> remoteClass.propertyNames;
+            remoteClass.mo = nullptr;
+            m_remoteClasses.insert(remoteClassId, remoteClass);
+        }
 
-        auto it = std::find_if(m_objects.begin(), m_objects.end(), [addr](const ObjectInfo &info) {
-                return info.addr == addr;
-            });
-        if (it == m_objects.end())
-            break;
-
-        for (quint32 i = 0; i < changeSize; ++i) {
-            QByteArray propName;
-            QVariant propValue;
-            msg >> propName >> propValue;
-            (*it).recursionLock = true;
-            (*it).obj->setProperty(propName, propValue);
-
-            // it can be invalid if as a result of the above call new objects have been registered for example
-            it = std::find_if(m_objects.begin(), m_objects.end(), [addr](const ObjectInfo &info) {
-                    return info.addr == addr;
-                });
-            Q_ASSERT(it != m_objects.end());
-            (*it).recursionLock = false;
+        quint16 objectCount;
+        msg >> objectCount;
+        Q_ASSERT(objectCount > 0);
+        for (quint16 i = 0; i < objectCount; ++i) {
+            Protocol::ObjectAddress addr;
+            quint16 remoteClassId;
+            quint16 changeSize;
+            msg >> addr >> remoteClassId >> changeSize;
+            Q_ASSERT(addr != Protocol::InvalidObjectAddress);
+            Q_ASSERT(changeSize > 0);
+            Q_ASSERT(m_remoteClasses.contains(remoteClassId));
+
+            for (quint16 j = 0; j < changeSize; ++j) {
+                quint16 propId;
+                QVariant propValue;
+                msg >> propId >> propValue;
+
+                // look this up for every value, it can be invalid if as a result of setting
+                // a property new objects have been registered for example
+                auto it = m_objects.find(addr);
+                if (it == m_objects.end())
+                    continue;
+                auto &remoteClass = m_remoteClasses[remoteClassId];
+                QObject *obj = (*it).obj;
+                const auto propIndex = remotePropertyIndex(remoteClass, obj, propId);
+
+                // what we received supersedes our own changes
+                if (propIndex >= qobjectPropertyOffset()) {
+                    auto &pending = (*it).pendingProperties;
+                    const auto pendingIndex = pending.indexOf(propIndex - qobjectPropertyOffset());
+                    if (pendingIndex >= 0)
+                        pending.remove(pendingIndex);
+                }
+
+                (*it).recursionLock = true;
+                if (propIndex >= 0)
+                    obj->metaObject()->property(propIndex).write(obj, propValue);
+                else if (propId < remoteClass.propertyNames.size())
+                    obj->setProperty(remoteClass.propertyNames.at(propId), propValue);
+
+                it = m_objects.find(addr);
+                Q_ASSERT(it != m_objects.end());
+                (*it).recursionLock = false;
+            }
         }
         break;
     }
@@ -188,37 +251,107 @@ void PropertySyncer::propertyChanged()
 {
     const auto *obj = sender();
     Q_ASSERT(obj);
-    const auto it
-        = std::find_if(m_objects.constBegin(), m_objects.constEnd(), [obj](const ObjectInfo &info) {
-        return info.obj == obj;
-    });
-    Q_ASSERT(it != m_objects.constEnd());
+    const auto addr = m_objectAddresses.value(obj, Protocol::InvalidObjectAddress);
+    const auto it = m_objects.find(addr);
+    Q_ASSERT(it != m_objects.end());
 
     if ((*it).recursionLock || !(*it).enabled)
         return;
 
-    const auto sigIndex = senderSignalIndex();
-    QVector<QPair<QByteArray, QVariant> > changes;
-    for (int i = qobjectPropertyOffset(); i < obj->metaObject()->propertyCount(); ++i) {
-        const auto prop = obj->metaObject()->property(i);
-        if (prop.notifySignalIndex() != sigIndex)
+    const auto &changed
+        = m_classes.at((*it).classId).notifyProperties.value(senderSignalIndex());
+    Q_ASSERT(!changed.isEmpty());
+
+    if ((*it).pendingProperties.isEmpty())
+        m_pendingObjects.push_back(addr);
+    foreach (auto propId, changed) {
+        if (!(*it).pendingProperties.contains(propId))
+            (*it).pendingProperties.push_back(propId);
+    }
+
+    if (!m_sendTimer->isActive())
+        m_sendTimer->start();
+}
+
+void PropertySyncer::sendPendingChanges()
+{
+    const auto addrs = m_pendingObjects;
+    m_pendingObjects.clear();
+    sendValues(addrs, false);
+}
+
+void PropertySyncer::sendValues(const QVector<Protocol::ObjectAddress> &addrs, bool allProperties)
+{
+    struct ObjectValues {
+        Protocol::ObjectAddress addr;
+        int classId;
+        QVector<QPair<quint16, QVariant> > values;
+    };
+    QVector<ObjectValues> objects;
+    QVector<int> newClasses;
+
+    foreach (auto addr, addrs) {
+        const auto it = m_objects.find(addr);
+        if (it == m_objects.end())
             continue;
-        changes.push_back(qMakePair(QByteArray(prop.name()), prop.read(obj)));
+
+        ObjectValues values;
+        values.addr = addr;
+        values.classId = (*it).classId;
+        const auto obj = (*it).obj;
+        if (allProperties) {
+            const auto propCount = obj->metaObject()->propertyCount();
+            values.values.reserve(propCount - qobjectPropertyOffset());
+            for (int i = qobjectPropertyOffset(); i < propCount; ++i)
+                values.values.push_back(qMakePair<quint16, QVariant>(i - qobjectPropertyOffset(),
+                                                                     obj->metaObject()->property(i).read(obj)));
+        } else if ((*it).enabled) {
+            values.values.reserve((*it).pendingProperties.size());
+            foreach (auto propId, (*it).pendingProperties) {
+                const auto prop = obj->metaObject()->property(propId + qobjectPropertyOffset());
+                values.values.push_back(qMakePair(propId, prop.read(obj)));
+            }
+        }
+        (*it).pendingProperties.clear();
+        if (values.values.isEmpty())
+            continue;
+
+        auto &classInfo = m_classes[values.classId];
+        if (!classInfo.announced) {
+            classInfo.announced = true;
+            newClasses.push_back(values.classId);
+        }
+        objects.push_back(values);
     }
-    Q_ASSERT(!changes.isEmpty());
+
+    if (objects.isEmpty())
+        return;
 
     Message msg(m_address, Protocol::PropertyValuesChanged);
-    msg << (*it).addr << (quint32)changes.size();
-    foreach (const auto &change, changes)
-        msg << change.first << change.second;
+    msg << (quint16)newClasses.size();
+    foreach (auto id, newClasses) {
+        const auto mo = m_classes.at(id).mo;
+        QVector<QByteArray> names;
+        names.reserve(mo->propertyCount() - qobjectPropertyOffset());
+        for (int i = qobjectPropertyOffset(); i < mo->propertyCount(); ++i)
+            names.push_back(QByteArray(mo->property(i).name()));
+        msg << (quint16)id << names;
+    }
+
+    msg << (quint16)objects.size();
+    foreach (const auto &object, objects) {
+        msg << object.addr << (quint16)object.classId << (quint16)object.values.size();
+        foreach (const auto &value, object.values)
+            msg << value.first << value.second;
+    }
     emit message(msg);
 }
 
 void PropertySyncer::objectDestroyed(QObject *obj)
 {
-    const auto it = std::find_if(m_objects.begin(), m_objects.end(), [obj](const ObjectInfo &info) {
-        return info.obj == obj;
-    });
+    const auto addr = m_objectAddresses.take(obj);
+    const auto it = m_objects.find(addr);
     Q_ASSERT(it != m_objects.end());
-    m_objects.erase(it);
+    if ((*it).obj == obj) // the address might have been reused already
+        m_objects.erase(it);
 }
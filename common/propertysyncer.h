@@ -33,13 +33,23 @@
 
 #include <common/protocol.h>
 
+#include <QHash>
 #include <QObject>
 #include <QVector>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 class Message;
 
-/** Infrastructure for syncing property values between a local and a remote object. */
+/** Infrastructure for syncing property values between a local and a remote object.
+ *  Changes are collected and sent in one message per event loop iteration, properties
+ *  are identified by numeric ids announced once per class and connection.
+ *  Messages sent for an object by other means are only ordered after its property changes
+ *  if flushPendingChanges() is called before, Endpoint does that for method calls.
+ */
 class GAMMARAY_COMMON_EXPORT PropertySyncer : public QObject
 {
     Q_OBJECT
@@ -65,6 +75,12 @@ public:
      */
     void setRequestInitialSync(bool initialSync);
 
+    /** Forget the property ids exchanged with the other side, call this for each new connection. */
+    void resetPeerState();
+
+    /** Send the collected property changes of the object with address @p addr right away. */
+    void flushPendingChanges(Protocol::ObjectAddress addr);
+
 public slots:
     /** Feed in incoming network messages here. */
     void handleMessage(const GammaRay::Message &msg);
@@ -76,15 +92,42 @@ signals:
 private slots:
     void propertyChanged();
     void objectDestroyed(QObject *obj);
+    void sendPendingChanges();
 
 private:
     struct ObjectInfo {
-        Protocol::ObjectAddress addr;
         QObject *obj;
+        int classId;
         bool recursionLock;
         bool enabled;
+        // changed properties not sent yet, as property ids
+        QVector<quint16> pendingProperties;
     };
-    QVector<ObjectInfo> m_objects;
+    /** A local class, property ids are the property index relative to QObject's properties. */
+    struct ClassInfo {
+        const QMetaObject *mo;
+        // notify signal index -> ids of the properties using that signal
+        QHash<int, QVector<quint16> > notifyProperties;
+        bool announced;
+    };
+    /** A class of the other side, with the property ids resolved for our class. */
+    struct RemoteClassInfo {
+        QVector<QByteArray> propertyNames;
+        const QMetaObject *mo;
+        QVector<int> propertyIndexes; // -1 for properties we don't have
+    };
+
+    int classId(const QMetaObject *mo);
+    int remotePropertyIndex(RemoteClassInfo &remoteClass, QObject *obj, quint16 propId);
+    void sendValues(const QVector<Protocol::ObjectAddress> &addrs, bool allProperties);
+
+    QHash<Protocol::ObjectAddress, ObjectInfo> m_objects;
+    QHash<const QObject *, Protocol::ObjectAddress> m_objectAddresses;
+    QVector<ClassInfo> m_classes;
+    QHash<const QMetaObject *, int> m_classIds;
+    QHash<quint16, RemoteClassInfo> m_remoteClasses;
+    QVector<Protocol::ObjectAddress> m_pendingObjects;
+    QTimer *m_sendTimer;
     Protocol::ObjectAddress m_address;
     bool m_initialSync;
 };
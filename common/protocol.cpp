@@ -55,7 +55,12 @@ QModelIndex toQModelIndex(const QAbstractItemModel *model, const Protocol::Model
 
 qint32 version()
 {
-    return 30;
+    return 38;
+}
+
+quint8 supportedPayloadEncodings()
+{
+    return (1 << DataStreamEncoding) | (1 << CompactEncoding);
 }
 
 qint32 broadcastFormatVersion()
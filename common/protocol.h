@@ -65,6 +65,7 @@ enum BuildInMessageType {
     // client -> server
     ModelRowColumnCountRequest,
     ModelContentRequest,
+    ModelAppendedContentRequest,
     ModelHeaderRequest,
     ModelSetDataRequest,
     ModelSortRequest,
@@ -74,6 +75,7 @@ enum BuildInMessageType {
     // server -> client
     ModelRowColumnCountReply,
     ModelContentReply,
+    ModelAppendedContentReply,
     ModelContentChanged,
     ModelHeaderReply,
     ModelHeaderChanged,
@@ -100,9 +102,21 @@ enum BuildInMessageType {
     ProbeSettings,
     ServerAddress,
 
+    // client -> server, answer to ServerVersion
+    PayloadEncodingSelected,
+
     MESSAGE_TYPE_COUNT // NOTE when changing this enum, also update MessageStatisticsModel!
 };
 
+/** Payload encodings supported for model content messages, negotiated during the ServerVersion handshake. */
+enum PayloadEncoding {
+    DataStreamEncoding, ///< QDataStream, always supported
+    CompactEncoding ///< see CompactPayloadWriter
+};
+
+/** Bit mask of the payload encodings supported by this build, sent with ServerVersion. */
+GAMMARAY_COMMON_EXPORT quint8 supportedPayloadEncodings();
+
 typedef QVector<QPair<qint32, qint32> > ModelIndex;
 
 /** @brief Protocol representation of an QItemSelectionRange. */
@@ -40,7 +40,13 @@ static const int RemoteModelUserRole = 0xFFFFFF;
 /*! Custom roles for RemoteModel. */
 namespace RemoteModelRole {
     enum Roles {
-        LoadingState = RemoteModelUserRole + 1
+        LoadingState = RemoteModelUserRole + 1,
+        /*! Pass this along with the changed roles to QAbstractItemModel::dataChanged() if
+         *  their values only had elements appended. RemoteModel then transfers just the new
+         *  elements instead of the entire cell content, see ModelUtils::appendableSize()
+         *  for the supported value types.
+         */
+        AppendOnly
     };
 }
 
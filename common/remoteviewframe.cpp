@@ -30,6 +30,8 @@
 
 #include <QDataStream>
 
+#include <algorithm>
+
 namespace GammaRay {
 RemoteViewFrame::RemoteViewFrame()
 {
@@ -48,11 +50,7 @@ QRectF RemoteViewFrame::viewRect() const
 {
     if (m_viewRect.isValid())
         return m_viewRect;
-    qreal pxRatio = 1.0;
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-    pxRatio = m_image.image().devicePixelRatio();
-#endif
-    return QRect(QPoint(), m_image.image().size() / pxRatio);
+    return QRect(QPoint(), m_image.image().size() / m_image.devicePixelRatio());
 }
 
 void RemoteViewFrame::setViewRect(const QRectF &viewRect)
@@ -82,6 +80,82 @@ void RemoteViewFrame::setImage(const QImage &image)
     m_image.setImage(image);
 }
 
+QRectF RemoteViewFrame::imageRect() const
+{
+    if (m_imageRect.isValid())
+        return m_imageRect;
+    return viewRect();
+}
+
+void RemoteViewFrame::setImageRect(const QRectF &imageRect)
+{
+    m_imageRect = imageRect;
+}
+
+void RemoteViewFrame::reduceImage(const QRectF &rect, const QSize &size)
+{
+    const QImage img = image();
+    if (img.isNull() || !rect.isValid() || size.isEmpty())
+        return;
+
+    const QRectF imgRect = imageRect();
+    const QRectF visibleRect = rect & imgRect;
+    if (visibleRect.isEmpty())
+        return;
+
+    // image pixels per view unit, and the factor needed to get to what the client shows
+    const qreal sx = img.width() / imgRect.width();
+    const qreal sy = img.height() / imgRect.height();
+    const qreal scale = std::min<qreal>(1.0, size.width() / (rect.width() * sx));
+
+    const QRect pixelRect = QRectF((visibleRect.x() - imgRect.x()) * sx,
+                                   (visibleRect.y() - imgRect.y()) * sy,
+                                   visibleRect.width() * sx,
+                                   visibleRect.height() * sy).toAlignedRect() & img.rect();
+    const QSize scaledSize(qMax(1, qRound(pixelRect.width() * scale)),
+                           qMax(1, qRound(pixelRect.height() * scale)));
+    if (pixelRect == img.rect() && scaledSize == pixelRect.size())
+        return;
+
+    // the view geometry can't be derived from the image anymore once we changed it
+    m_viewRect = viewRect();
+    m_imageRect = QRectF(imgRect.x() + pixelRect.x() / sx, imgRect.y() + pixelRect.y() / sy,
+                         pixelRect.width() / sx, pixelRect.height() / sy);
+
+    const qreal pxRatio = m_image.devicePixelRatio();
+    QImage reduced = img.copy(pixelRect);
+    if (scaledSize != pixelRect.size()) // vectorized in QtGui for 32bit formats
+        reduced = reduced.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    setImage(reduced);
+    // kept next to the image, the client paints it into imageRect() anyway
+    m_image.setDevicePixelRatio(pxRatio * scaledSize.width() / pixelRect.width());
+}
+
+void RemoteViewFrame::encodeImageDelta(TransferImageDeltaEncoder *encoder)
+{
+    encoder->encode(&m_image);
+}
+
+bool RemoteViewFrame::encodeImageSharedMemory(TransferImageSharedMemoryEncoder *encoder)
+{
+    return encoder->encode(&m_image);
+}
+
+bool RemoteViewFrame::isImageInaccessible() const
+{
+    return m_image.isInaccessible();
+}
+
+bool RemoteViewFrame::isImageDelta() const
+{
+    return m_image.isDelta();
+}
+
+bool RemoteViewFrame::applyImageDelta(const RemoteViewFrame &previous)
+{
+    return m_image.applyDelta(previous.image());
+}
+
 QVariant RemoteViewFrame::data() const
 {
     return m_data;
@@ -94,7 +168,8 @@ void RemoteViewFrame::setData(const QVariant &data)
 
 QDataStream &operator<<(QDataStream &stream, const RemoteViewFrame &frame)
 {
-    stream << frame.m_image << frame.m_data << frame.m_viewRect << frame.m_sceneRect;
+    stream << frame.m_image << frame.m_data << frame.m_viewRect << frame.m_sceneRect
+           << frame.m_imageRect;
     return stream;
 }
 
@@ -104,6 +179,7 @@ QDataStream &operator>>(QDataStream &stream, RemoteViewFrame &frame)
     stream >> frame.m_data;
     stream >> frame.m_viewRect;
     stream >> frame.m_sceneRect;
+    stream >> frame.m_imageRect;
     return stream;
 }
 }
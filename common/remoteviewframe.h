@@ -40,8 +40,8 @@
 namespace GammaRay {
 class RemoteViewFrame;
 
-QDataStream &operator<<(QDataStream &stream, const GammaRay::RemoteViewFrame &frame);
-QDataStream &operator>>(QDataStream &stream, GammaRay::RemoteViewFrame &frame);
+GAMMARAY_COMMON_EXPORT QDataStream &operator<<(QDataStream &stream, const GammaRay::RemoteViewFrame &frame);
+GAMMARAY_COMMON_EXPORT QDataStream &operator>>(QDataStream &stream, GammaRay::RemoteViewFrame &frame);
 
 /** Data of a single frame displayed in the RemoteViewWidget. */
 class GAMMARAY_COMMON_EXPORT RemoteViewFrame
@@ -61,6 +61,24 @@ public:
 
     QImage image() const;
     void setImage(const QImage &image);
+    /// the area covered by image(), if it only shows parts of the view
+    QRectF imageRect() const;
+    void setImageRect(const QRectF &imageRect);
+
+    /// @internal reduce the image to the part within @p rect (in view coordinates), at
+    /// no more than @p size device pixels for all of @p rect
+    void reduceImage(const QRectF &rect, const QSize &size);
+
+    /// @internal encode the image as difference to the one last sent with @p encoder
+    void encodeImageDelta(TransferImageDeltaEncoder *encoder);
+    /// @internal returns @c true if the image still needs to be completed with applyImageDelta()
+    bool isImageDelta() const;
+    /// @internal completes the image with the content of @p previous, the frame received before this one
+    bool applyImageDelta(const RemoteViewFrame &previous);
+    /// @internal pass the image via shared memory using @p encoder, returns @c false if that isn't possible
+    bool encodeImageSharedMemory(TransferImageSharedMemoryEncoder *encoder);
+    /// @internal returns @c true if the image was passed via shared memory we have no access to
+    bool isImageInaccessible() const;
 
     /// tool specific frame data
     QVariant data() const;
@@ -73,6 +91,7 @@ private:
     QVariant m_data;
     QRectF m_viewRect;
     QRectF m_sceneRect;
+    QRectF m_imageRect;
 };
 }
 
@@ -35,6 +35,8 @@
 
 #include <QObject>
 #include <QPoint>
+#include <QRectF>
+#include <QSize>
 #include <QTouchEvent>
 
 namespace GammaRay {
@@ -76,6 +78,13 @@ public slots:
 
     /// Tell the server we are ready for the next frame.
     virtual void clientViewUpdated() = 0;
+    /// Tell the server we can't use delta frames, as we lost the frame they refer to.
+    virtual void requestCompleteFrame() = 0;
+    /// Tell the server which part of the source (in view coordinates) is visible,
+    /// and how many device pixels the client uses to show it.
+    virtual void setViewport(const QRectF &rect, const QSize &size) = 0;
+    /// Tell the server we can't access its shared memory, frames have to be sent inline.
+    virtual void requestInlineFrames() = 0;
 
 signals:
     void reset();
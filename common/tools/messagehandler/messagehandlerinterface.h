@@ -43,9 +43,16 @@ public:
     explicit MessageHandlerInterface(QObject *parent = nullptr);
     virtual ~MessageHandlerInterface();
 
+public slots:
+    /** Symbolizes the backtrace of the message with MessageModelRole::MessageId @p messageId,
+     *  answered by backtraceAvailable().
+     */
+    virtual void requestBacktrace(int messageId) = 0;
+
 signals:
     void fatalMessageReceived(const QString &app, const QString &message, const QTime &time,
                               const QStringList &backtrace);
+    void backtraceAvailable(int messageId, const QStringList &backtrace);
 };
 }
 
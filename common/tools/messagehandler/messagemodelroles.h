@@ -39,7 +39,8 @@ enum Role {
     Type,
     File,
     Line,
-    Backtrace
+    Backtrace,  // not for remoting, symbolizing is expensive, see MessageHandlerInterface
+    MessageId
 };
 }
 
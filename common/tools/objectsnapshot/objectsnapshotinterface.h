@@ -0,0 +1,59 @@
+/*
+  objectsnapshotinterface.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSNAPSHOTINTERFACE_H
+#define GAMMARAY_OBJECTSNAPSHOTINTERFACE_H
+
+#include <QObject>
+
+namespace GammaRay {
+
+/*! communication interface for the object snapshot tool. */
+class ObjectSnapshotInterface : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ObjectSnapshotInterface(QObject *parent = nullptr);
+    ~ObjectSnapshotInterface();
+
+public slots:
+    /** Captures the current object tree into a new snapshot. */
+    virtual void takeSnapshot() = 0;
+    /** Periodically capture snapshots, to catch short-lived states. */
+    virtual void setContinuousCapture(bool enabled) = 0;
+    /** Show the snapshot with id @p snapshotId in the snapshot content model, -1 for none. */
+    virtual void selectSnapshot(int snapshotId) = 0;
+    /** Compare the selected snapshot against the one with id @p snapshotId, -1 for none. */
+    virtual void setDiffBase(int snapshotId) = 0;
+};
+}
+
+QT_BEGIN_NAMESPACE
+Q_DECLARE_INTERFACE(GammaRay::ObjectSnapshotInterface, "com.kdab.GammaRay.ObjectSnapshotInterface")
+QT_END_NAMESPACE
+
+#endif // GAMMARAY_OBJECTSNAPSHOTINTERFACE_H
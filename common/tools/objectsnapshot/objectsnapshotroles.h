@@ -1,11 +1,10 @@
 /*
-  functioncalltimer.h
+  objectsnapshotroles.h
 
   This file is part of GammaRay, the Qt application inspection and
   manipulation tool.
 
-  Copyright (C) 2010-2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
-  Author: Thomas McGuire <thomas.mcguire@kdab.com>
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
 
   Licensees holding valid commercial KDAB GammaRay licenses may use this file in
   accordance with GammaRay Commercial License Agreement provided with the Software.
@@ -25,29 +24,29 @@
   You should have received a copy of the GNU General Public License
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-#ifndef GAMMARAY_TIMERTOP_FUNCTIONCALLTIMER_H
-#define GAMMARAY_TIMERTOP_FUNCTIONCALLTIMER_H
 
-#include <qglobal.h>
+#ifndef GAMMARAY_OBJECTSNAPSHOTROLES_H
+#define GAMMARAY_OBJECTSNAPSHOTROLES_H
 
-#include <ctime>
+#include <common/modelroles.h>
 
 namespace GammaRay {
-class FunctionCallTimer
-{
-public:
-    FunctionCallTimer();
-    bool start();
-    bool active() const;
-    int stop();
-
-private:
-#ifndef Q_OS_WIN
-    timespec m_startTime;
-#else
-    qint64 m_startTime;
-#endif
-    bool m_active;
+namespace ObjectSnapshotRoles {
+
+enum Roles {
+    SnapshotIdRole = UserRole + 1,
+    DiffStateRole
+};
+
+/** How an object in the selected snapshot differs from the diff base. */
+enum DiffState {
+    Unchanged,
+    Added,
+    Removed,
+    Changed
 };
+
+}
 }
-#endif // GAMMARAY_FUNCTIONCALLTIMER_H
+
+#endif
@@ -28,15 +28,128 @@
 
 #include "transferimage.h"
 
+#include "lz4/lz4.h" // 3rdparty
+
+#include <QBuffer>
+#include <QCoreApplication>
 #include <QDebug>
+#include <QHash>
+#include <QSharedMemory>
+#include <QSharedPointer>
+
+#include <cstring>
 
 namespace GammaRay {
+// edge length of the tiles for TileDeltaFormat, in pixels
+static const int TileSize = 64;
+// number of images in the shared memory ring for SharedMemoryFormat
+static const int SharedMemorySlots = 3;
+
+static inline quint64 mixTileHash(quint64 hash, quint64 word)
+{
+    hash = (hash ^ word) * Q_UINT64_C(1099511628211);
+    return hash ^ (hash >> 32);
+}
+
+static quint64 tileHash(const QImage &image, int x, int y, int width, int height)
+{
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    const int bytes = width * 4;
+    for (int row = y; row < y + height; ++row) {
+        const uchar *line = image.constScanLine(row) + x * 4;
+        int i = 0;
+        for (; i + 8 <= bytes; i += 8) {
+            quint64 word;
+            memcpy(&word, line + i, sizeof(word));
+            hash = mixTileHash(hash, word);
+        }
+        for (; i < bytes; i += 4) {
+            quint32 word;
+            memcpy(&word, line + i, sizeof(word));
+            hash = mixTileHash(hash, word);
+        }
+    }
+    return hash;
+}
+
+static qreal imageDevicePixelRatio(const QImage &image)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    return image.devicePixelRatio();
+#else
+    Q_UNUSED(image);
+    return 1.0;
+#endif
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) && !defined(QT_NO_SHAREDMEMORY)
+static void releaseSharedMemory(void *info)
+{
+    delete static_cast<QSharedPointer<QSharedMemory> *>(info);
+}
+
+static int bitsPerPixel(QImage::Format format)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    return QImage::toPixelFormat(format).bitsPerPixel();
+#else
+    return QImage(1, 1, format).depth();
+#endif
+}
+#endif
+
+// maps an image sent in SharedMemoryFormat, returns a null image if we can't access it
+static QImage sharedMemoryImage(const QString &key, quint32 offset, int width, int height,
+                                int bytesPerLine, QImage::Format format)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) && !defined(QT_NO_SHAREDMEMORY)
+    // segments stay attached for as long as images referring to them exist
+    static QHash<QString, QWeakPointer<QSharedMemory> > segments;
+    QSharedPointer<QSharedMemory> memory = segments.value(key).toStrongRef();
+    if (!memory) {
+        for (auto it = segments.begin(); it != segments.end();) {
+            if (it.value().isNull())
+                it = segments.erase(it);
+            else
+                ++it;
+        }
+        memory.reset(new QSharedMemory(key));
+        if (!memory->attach(QSharedMemory::ReadOnly))
+            return QImage();
+        segments.insert(key, memory);
+    }
+
+    if (format <= QImage::Format_Invalid || format >= QImage::NImageFormats
+        || width <= 0 || height <= 0 || bytesPerLine <= 0
+        || bytesPerLine < (qint64(width) * bitsPerPixel(format) + 7) / 8
+        || offset + qint64(bytesPerLine) * height > memory->size())
+        return QImage();
+    const uchar *data = static_cast<const uchar *>(memory->constData()) + offset;
+    return QImage(data, width, height, bytesPerLine, format, releaseSharedMemory,
+                  new QSharedPointer<QSharedMemory>(memory));
+#else
+    Q_UNUSED(key);
+    Q_UNUSED(offset);
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    Q_UNUSED(bytesPerLine);
+    Q_UNUSED(format);
+    return QImage();
+#endif
+}
+
 TransferImage::TransferImage()
+    : m_format(RawFormat)
+    , m_devicePixelRatio(1.0)
+    , m_sharedMemoryOffset(0)
 {
 }
 
 TransferImage::TransferImage(const QImage &image)
     : m_image(image)
+    , m_format(RawFormat)
+    , m_devicePixelRatio(imageDevicePixelRatio(image))
+    , m_sharedMemoryOffset(0)
 {
 }
 
@@ -48,11 +161,210 @@ const QImage &TransferImage::image() const
 void TransferImage::setImage(const QImage &image)
 {
     m_image = image;
+    m_format = RawFormat;
+    m_devicePixelRatio = imageDevicePixelRatio(image);
+    m_tileData.clear();
+    m_sharedMemoryKey.clear();
+    m_sharedMemoryOffset = 0;
+}
+
+qreal TransferImage::devicePixelRatio() const
+{
+    return m_devicePixelRatio;
+}
+
+void TransferImage::setDevicePixelRatio(qreal ratio)
+{
+    m_devicePixelRatio = ratio;
+}
+
+bool TransferImage::isDelta() const
+{
+    return m_format == TileDeltaFormat;
+}
+
+bool TransferImage::isInaccessible() const
+{
+    return m_format == SharedMemoryFormat && m_image.isNull();
+}
+
+bool TransferImage::applyDelta(const QImage &base)
+{
+    if (!isDelta())
+        return true;
+    if (base.size() != m_image.size() || base.format() != m_image.format()
+        || base.bytesPerLine() != m_image.bytesPerLine())
+        return false;
+
+    memcpy(m_image.bits(), base.constBits(), m_image.bytesPerLine() * m_image.height());
+
+    QDataStream stream(m_tileData);
+    quint32 tileSize, count;
+    stream >> tileSize >> count;
+    if (tileSize == 0)
+        return false;
+    const int columns = (m_image.width() + tileSize - 1) / tileSize;
+    QByteArray compressed, tile;
+    for (quint32 i = 0; i < count; ++i) {
+        quint32 index;
+        qint32 size;
+        stream >> index >> size;
+        if (stream.status() != QDataStream::Ok || size < 0)
+            return false;
+        compressed.resize(size);
+        if (stream.readRawData(compressed.data(), size) != size)
+            return false;
+
+        const int x = (index % columns) * tileSize;
+        const int y = (index / columns) * tileSize;
+        if (y >= m_image.height())
+            return false;
+        const int lineBytes = qMin<int>(tileSize, m_image.width() - x) * 4;
+        const int height = qMin<int>(tileSize, m_image.height() - y);
+        tile.resize(lineBytes * height);
+        if (LZ4_decompress_safe(compressed.constData(), tile.data(), size, tile.size()) != tile.size())
+            return false;
+        for (int row = 0; row < height; ++row)
+            memcpy(m_image.scanLine(y + row) + x * 4, tile.constData() + row * lineBytes, lineBytes);
+    }
+
+    m_format = RawFormat;
+    m_tileData.clear();
+    return true;
+}
+
+TransferImageDeltaEncoder::TransferImageDeltaEncoder()
+    : m_format(QImage::Format_Invalid)
+    , m_devicePixelRatio(1.0)
+{
+}
+
+void TransferImageDeltaEncoder::reset()
+{
+    m_tileHashes.clear();
+    m_size = QSize();
+    m_format = QImage::Format_Invalid;
+}
+
+void TransferImageDeltaEncoder::encode(TransferImage *transferImage)
+{
+    const QImage &image = transferImage->m_image;
+    transferImage->m_format = TransferImage::RawFormat;
+    transferImage->m_tileData.clear();
+    if (image.isNull() || image.depth() != 32) {
+        reset();
+        return;
+    }
+
+    const int columns = (image.width() + TileSize - 1) / TileSize;
+    const int rows = (image.height() + TileSize - 1) / TileSize;
+    QVector<quint64> hashes(columns * rows);
+    for (int i = 0; i < hashes.size(); ++i) {
+        const int x = (i % columns) * TileSize;
+        const int y = (i / columns) * TileSize;
+        hashes[i] = tileHash(image, x, y, qMin(TileSize, image.width() - x),
+                             qMin(TileSize, image.height() - y));
+    }
+
+    // anything we can't express as a delta goes out as a complete RawFormat key frame
+    const bool keyFrame = m_tileHashes.size() != hashes.size() || m_size != image.size()
+                          || m_format != image.format()
+                          || m_devicePixelRatio != transferImage->m_devicePixelRatio;
+    if (!keyFrame) {
+        QBuffer buffer(&transferImage->m_tileData);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream stream(&buffer);
+        quint32 count = 0;
+        stream << quint32(TileSize) << count; // count is updated at the end
+
+        QByteArray tile, compressed;
+        for (int i = 0; i < hashes.size(); ++i) {
+            if (hashes.at(i) == m_tileHashes.at(i))
+                continue;
+            const int x = (i % columns) * TileSize;
+            const int y = (i / columns) * TileSize;
+            const int lineBytes = qMin(TileSize, image.width() - x) * 4;
+            const int height = qMin(TileSize, image.height() - y);
+            tile.resize(lineBytes * height);
+            for (int row = 0; row < height; ++row)
+                memcpy(tile.data() + row * lineBytes, image.constScanLine(y + row) + x * 4, lineBytes);
+
+            compressed.resize(LZ4_compressBound(tile.size()));
+            const int size = LZ4_compress_default(tile.constData(), compressed.data(), tile.size(),
+                                                  compressed.size());
+            stream << quint32(i) << qint32(size);
+            stream.writeRawData(compressed.constData(), size);
+            ++count;
+        }
+        buffer.seek(sizeof(quint32));
+        stream << count;
+        transferImage->m_format = TransferImage::TileDeltaFormat;
+    }
+
+    m_tileHashes.swap(hashes);
+    m_size = image.size();
+    m_format = image.format();
+    m_devicePixelRatio = transferImage->m_devicePixelRatio;
+}
+
+TransferImageSharedMemoryEncoder::TransferImageSharedMemoryEncoder()
+    : m_memory(nullptr)
+    , m_slotSize(0)
+    , m_nextSlot(0)
+{
+}
+
+TransferImageSharedMemoryEncoder::~TransferImageSharedMemoryEncoder()
+{
+    delete m_memory;
+}
+
+bool TransferImageSharedMemoryEncoder::encode(TransferImage *transferImage)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0) && !defined(QT_NO_SHAREDMEMORY)
+    const QImage &image = transferImage->m_image;
+    if (image.isNull())
+        return false;
+
+    const int byteCount = image.bytesPerLine() * image.height();
+    if (!m_memory || byteCount > m_slotSize) {
+        // the receiver keeps the previous segment alive while it still uses images from it
+        delete m_memory;
+        static int segmentCount = 0;
+        m_memory = new QSharedMemory(QStringLiteral("gammaray-%1-images-%2")
+                                     .arg(QCoreApplication::applicationPid())
+                                     .arg(++segmentCount));
+        // leave some room for growing, e.g. while resizing a window, and keep slots aligned
+        m_slotSize = (byteCount + byteCount / 4 + 63) & ~63;
+        m_nextSlot = 0;
+        if (!m_memory->create(m_slotSize * SharedMemorySlots)) {
+            qWarning() << "Failed to create shared memory for remote view frames:"
+                       << m_memory->errorString();
+            delete m_memory;
+            m_memory = nullptr;
+            m_slotSize = 0;
+            return false;
+        }
+    }
+
+    const quint32 offset = m_nextSlot * m_slotSize;
+    m_nextSlot = (m_nextSlot + 1) % SharedMemorySlots;
+    memcpy(static_cast<char *>(m_memory->data()) + offset, image.constBits(), byteCount);
+
+    transferImage->m_format = TransferImage::SharedMemoryFormat;
+    transferImage->m_tileData.clear();
+    transferImage->m_sharedMemoryKey = m_memory->key();
+    transferImage->m_sharedMemoryOffset = offset;
+    return true;
+#else
+    Q_UNUSED(transferImage);
+    return false;
+#endif
 }
 
 QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image)
 {
-    static const TransferImage::Format format = TransferImage::RawFormat;
+    const TransferImage::Format format = image.m_format;
 
     const QImage &img = image.image();
     stream << (quint32)(format);
@@ -61,15 +373,21 @@ QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &imag
         stream << img;
         break;
     case TransferImage::RawFormat:
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-        stream << (double)img.devicePixelRatio();
-#else
-        stream << 1.0;
-#endif
+        stream << (double)image.m_devicePixelRatio;
         stream << (quint32)img.format() << (quint32)img.width() << (quint32)img.height();
         for (int i = 0; i < img.height(); ++i)
             stream.device()->write((const char *)img.scanLine(i), img.bytesPerLine());
         break;
+    case TransferImage::TileDeltaFormat:
+        stream << (double)image.m_devicePixelRatio;
+        stream << (quint32)img.format() << (quint32)img.width() << (quint32)img.height();
+        stream << image.m_tileData;
+        break;
+    case TransferImage::SharedMemoryFormat:
+        stream << (double)image.m_devicePixelRatio;
+        stream << (quint32)img.format() << (quint32)img.width() << (quint32)img.height();
+        stream << (quint32)img.bytesPerLine() << image.m_sharedMemoryKey << image.m_sharedMemoryOffset;
+        break;
     }
 
     return stream;
@@ -95,14 +413,40 @@ QDataStream &operator>>(QDataStream &stream, TransferImage &image)
         quint32 f, w, h;
         stream >> r >> f >> w >> h;
         QImage img(w, h, static_cast<QImage::Format>(f));
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-        img.setDevicePixelRatio(r);
-#endif
         for (int i = 0; i < img.height(); ++i) {
             const QByteArray buffer = stream.device()->read(img.bytesPerLine());
             memcpy(img.scanLine(i), buffer.constData(), img.bytesPerLine());
         }
         image.setImage(img);
+        image.m_devicePixelRatio = r;
+        break;
+    }
+    case TransferImage::TileDeltaFormat:
+    {
+        double r;
+        quint32 f, w, h;
+        stream >> r >> f >> w >> h;
+        // content is filled in by applyDelta()
+        QImage img(w, h, static_cast<QImage::Format>(f));
+        image.setImage(img);
+        image.m_devicePixelRatio = r;
+        stream >> image.m_tileData;
+        image.m_format = TransferImage::TileDeltaFormat;
+        break;
+    }
+    case TransferImage::SharedMemoryFormat:
+    {
+        double r;
+        quint32 f, w, h, bytesPerLine, offset;
+        QString key;
+        stream >> r >> f >> w >> h >> bytesPerLine >> key >> offset;
+        QImage img = sharedMemoryImage(key, offset, w, h, bytesPerLine,
+                                       static_cast<QImage::Format>(f));
+        image.setImage(img);
+        image.m_devicePixelRatio = r;
+        image.m_format = TransferImage::SharedMemoryFormat;
+        image.m_sharedMemoryKey = key;
+        image.m_sharedMemoryOffset = offset;
         break;
     }
     }
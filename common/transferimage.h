@@ -29,13 +29,27 @@
 #ifndef GAMMARAY_TRANSFERIMAGE_H
 #define GAMMARAY_TRANSFERIMAGE_H
 
+#include "gammaray_common_export.h"
+
 #include <QDataStream>
 #include <QImage>
 #include <QVariant>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QSharedMemory;
+QT_END_NAMESPACE
 
 namespace GammaRay {
+class TransferImage;
+class TransferImageDeltaEncoder;
+class TransferImageSharedMemoryEncoder;
+
+GAMMARAY_COMMON_EXPORT QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image);
+GAMMARAY_COMMON_EXPORT QDataStream &operator>>(QDataStream &stream, GammaRay::TransferImage &image);
+
 /** Wrapper class for a QImage to allow raw data transfer over a QDataStream, bypassing the usuale PNG encoding. */
-class TransferImage
+class GAMMARAY_COMMON_EXPORT TransferImage
 {
 public:
     TransferImage();
@@ -43,18 +57,95 @@ public:
 
     const QImage &image() const;
     void setImage(const QImage &image);
+    /**
+     * Returns the device pixel ratio of image().
+     * Received images don't carry this themselves, setting it would detach them from shared memory.
+     */
+    qreal devicePixelRatio() const;
+    void setDevicePixelRatio(qreal ratio);
 
     enum Format {
         QImageFormat,
-        RawFormat
+        RawFormat,
+        TileDeltaFormat, ///< only the tiles that changed compared to the previous image
+        SharedMemoryFormat ///< only a reference to the image content in shared memory
     };
 
+    /** Returns @c true if this was received as TileDeltaFormat and still needs applyDelta(). */
+    bool isDelta() const;
+    /**
+     * Completes a received delta image with the unchanged tiles of @p base, the image
+     * that was sent before this one.
+     * @returns @c false if @p base doesn't match what the delta was created against.
+     */
+    bool applyDelta(const QImage &base);
+
+    /** Returns @c true if this was received as SharedMemoryFormat, but we can't access that memory. */
+    bool isInaccessible() const;
+
 private:
+    friend class TransferImageDeltaEncoder;
+    friend class TransferImageSharedMemoryEncoder;
+    friend QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image);
+    friend QDataStream &operator>>(QDataStream &stream, GammaRay::TransferImage &image);
+
     QImage m_image;
+    Format m_format;
+    qreal m_devicePixelRatio;
+    // LZ4 compressed dirty tiles, for TileDeltaFormat
+    QByteArray m_tileData;
+    // shared memory segment and offset of the content, for SharedMemoryFormat
+    QString m_sharedMemoryKey;
+    quint32 m_sharedMemoryOffset;
+};
+
+/**
+ * Sender side state for TransferImage::TileDeltaFormat.
+ *
+ * Images are split into square tiles, of which we remember a hash. As long as size and format
+ * stay the same, an image is then sent as the set of tiles whose hash changed.
+ * This assumes the receiving side saw every image we encoded, call reset() if that
+ * is no longer the case to send the next image completely in RawFormat.
+ */
+class GAMMARAY_COMMON_EXPORT TransferImageDeltaEncoder
+{
+public:
+    TransferImageDeltaEncoder();
+
+    void reset();
+    /** Prepares @p image for sending as delta against the previously encoded image. */
+    void encode(TransferImage *image);
+
+private:
+    QVector<quint64> m_tileHashes;
+    QSize m_size;
+    QImage::Format m_format;
+    qreal m_devicePixelRatio;
 };
 
-QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image);
-QDataStream &operator>>(QDataStream &stream, GammaRay::TransferImage &image);
+/**
+ * Sender side state for TransferImage::SharedMemoryFormat.
+ *
+ * Images are copied into a ring of slots in a shared memory segment, the receiver then
+ * uses them from there without copying. This relies on the receiver being done with an
+ * image two images later, which holds as long as we only send after it acknowledged
+ * the previous one. Obviously only usable for receivers on the same host.
+ */
+class GAMMARAY_COMMON_EXPORT TransferImageSharedMemoryEncoder
+{
+public:
+    TransferImageSharedMemoryEncoder();
+    ~TransferImageSharedMemoryEncoder();
+
+    /** Moves the content of @p image into shared memory, returns @c false if that failed. */
+    bool encode(TransferImage *image);
+
+private:
+    Q_DISABLE_COPY(TransferImageSharedMemoryEncoder)
+    QSharedMemory *m_memory;
+    int m_slotSize;
+    int m_nextSlot;
+};
 }
 
 Q_DECLARE_METATYPE(GammaRay::TransferImage)
@@ -43,15 +43,23 @@
 
 #include <QDebug>
 #include <QMetaEnum>
+#include <QTimer>
+
+#include <algorithm>
 
 using namespace GammaRay;
 
 AggregatedPropertyModel::AggregatedPropertyModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_rootAdaptor(nullptr)
+    , m_updateTimer(new QTimer(this))
     , m_inhibitAdaptorCreation(false)
 {
     qRegisterMetaType<GammaRay::PropertyAdaptor *>();
+
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(PropertyAdaptor::UpdateInterval);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(updateChangedProperties()));
 }
 
 AggregatedPropertyModel::~AggregatedPropertyModel()
@@ -89,6 +97,7 @@ void AggregatedPropertyModel::clear()
         beginRemoveRows(QModelIndex(), 0, count - 1);
 
     m_parentChildrenMap.clear();
+    m_changedAdaptors.clear();
     delete m_rootAdaptor;
     m_rootAdaptor = nullptr;
 
@@ -109,7 +118,7 @@ QVariant AggregatedPropertyModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    const auto d = adaptor->propertyData(index.row());
+    const auto d = adaptor->cachedPropertyData(index.row());
     return data(adaptor, d, index.column(), role);
 }
 
@@ -126,7 +135,7 @@ QMap<int, QVariant> AggregatedPropertyModel::itemData(const QModelIndex &index)
                                   Q_ARG(GammaRay::PropertyAdaptor *, adaptor));
         return res;
     }
-    const auto d = adaptor->propertyData(index.row());
+    const auto d = adaptor->cachedPropertyData(index.row());
 
     res.insert(Qt::DisplayRole, data(adaptor, d, index.column(), Qt::DisplayRole));
     res.insert(Qt::ToolTipRole, data(adaptor, d, index.column(), Qt::ToolTipRole));
@@ -256,7 +265,7 @@ int AggregatedPropertyModel::rowCount(const QModelIndex &parent) const
     auto &siblings = m_parentChildrenMap[adaptor];
     if (!m_inhibitAdaptorCreation && !siblings.at(parent.row())) {
         // TODO: remember we tried any of this
-        auto pd = adaptor->propertyData(parent.row());
+        auto pd = adaptor->cachedPropertyData(parent.row());
         if (!hasLoop(adaptor, pd.value())) {
             auto a = PropertyAdaptorFactory::create(pd.value(), adaptor);
             siblings[parent.row()] = a;
@@ -276,7 +285,7 @@ Qt::ItemFlags AggregatedPropertyModel::flags(const QModelIndex &index) const
         return baseFlags;
 
     auto adaptor = adaptorForIndex(index);
-    auto data = adaptor->propertyData(index.row());
+    auto data = adaptor->cachedPropertyData(index.row());
     // we can't edit value types (yet)
     const auto editable = (data.flags() & PropertyData::Writable) && isParentEditable(adaptor);
     return editable ? (baseFlags | Qt::ItemIsEditable) : baseFlags;
@@ -350,9 +359,42 @@ void AggregatedPropertyModel::propertyChanged(int first, int last)
     Q_ASSERT(first >= 0);
     Q_ASSERT(last < adaptor->count());
 
-    emit dataChanged(createIndex(first, 0, adaptor), createIndex(last, columnCount() - 1, adaptor));
-    for (int i = first; i <= last; ++i)
-        reloadSubTree(adaptor, i);
+    // the adaptor tracks which properties notified, we only need to look at it once per frame
+    if (!m_changedAdaptors.contains(adaptor))
+        m_changedAdaptors.push_back(adaptor);
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void AggregatedPropertyModel::updateChangedProperties()
+{
+    const auto adaptors = m_changedAdaptors;
+    m_changedAdaptors.clear();
+
+    foreach (auto adaptor, adaptors) {
+        // might have been deleted by reloading a sub-tree meanwhile
+        if (!m_parentChildrenMap.contains(adaptor))
+            continue;
+
+        const auto rowCount = m_parentChildrenMap.value(adaptor).size();
+        QVector<int> rows = adaptor->updateChangedProperties();
+        rows.erase(std::remove_if(rows.begin(), rows.end(), [rowCount](int row) {
+            return row >= rowCount;
+        }), rows.end());
+
+        // one notification per contiguous range of changed properties
+        for (int i = 0; i < rows.size();) {
+            int j = i;
+            while (j + 1 < rows.size() && rows.at(j + 1) == rows.at(j) + 1)
+                ++j;
+            emit dataChanged(createIndex(rows.at(i), 0, adaptor),
+                             createIndex(rows.at(j), columnCount() - 1, adaptor));
+            i = j + 1;
+        }
+
+        foreach (auto row, rows)
+            reloadSubTree(adaptor, row);
+    }
 }
 
 void AggregatedPropertyModel::propertyAdded(int first, int last)
@@ -456,7 +498,7 @@ void AggregatedPropertyModel::reloadSubTree(PropertyAdaptor *parentAdaptor, int
 
     // re-add the sub-tree
     // TODO consolidate with code in rowCount()
-    auto pd = parentAdaptor->propertyData(index);
+    auto pd = parentAdaptor->cachedPropertyData(index);
     if (hasLoop(parentAdaptor, pd.value())) {
         m_inhibitAdaptorCreation = false;
         return;
@@ -488,7 +530,7 @@ bool AggregatedPropertyModel::isParentEditable(PropertyAdaptor *adaptor) const
         const auto row = m_parentChildrenMap.value(parentAdaptor).indexOf(adaptor);
         Q_ASSERT(row >= 0);
 
-        const auto pd = parentAdaptor->propertyData(row);
+        const auto pd = parentAdaptor->cachedPropertyData(row);
         if ((pd.flags() & PropertyData::Writable) == 0)
             return false;
     }
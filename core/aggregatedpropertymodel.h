@@ -35,6 +35,10 @@
 #include <QHash>
 #include <QVector>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 class PropertyAdaptor;
 class PropertyData;
@@ -75,6 +79,7 @@ private:
 
 private slots:
     void propertyChanged(int first, int last);
+    void updateChangedProperties();
     void propertyAdded(int first, int last);
     void propertyRemoved(int first, int last);
     void objectInvalidated();
@@ -83,6 +88,9 @@ private slots:
 private:
     PropertyAdaptor *m_rootAdaptor;
     mutable QHash<PropertyAdaptor *, QVector<PropertyAdaptor *> > m_parentChildrenMap;
+    // adaptors with change notifications, processed at most once per frame
+    QVector<PropertyAdaptor *> m_changedAdaptors;
+    QTimer *m_updateTimer;
     bool m_inhibitAdaptorCreation;
 };
 }
@@ -42,8 +42,6 @@ using namespace std;
 ObjectListModel::ObjectListModel(Probe *probe)
     : ObjectModelBase< QAbstractTableModel >(probe)
 {
-    connect(probe, SIGNAL(objectCreated(QObject*)),
-            this, SLOT(objectAdded(QObject*)));
     connect(probe, SIGNAL(objectDestroyed(QObject*)),
             this, SLOT(objectRemoved(QObject*)));
 }
@@ -80,23 +78,20 @@ int ObjectListModel::rowCount(const QModelIndex &parent) const
     return m_objects.size();
 }
 
-void ObjectListModel::objectAdded(QObject *obj)
+void ObjectListModel::objectsAdded(const QVector<QObject *> &objs)
 {
-    // see Probe::objectCreated, that promises a valid object in the main thread
+    // see Probe::objectCreated, that promises valid objects in the main thread
     Q_ASSERT(QThread::currentThread() == thread());
-    Q_ASSERT(obj);
-    Q_ASSERT(Probe::instance()->isValidObject(obj));
 
-    QVector<QObject *>::iterator it = std::lower_bound(m_objects.begin(), m_objects.end(), obj);
-    Q_ASSERT(it == m_objects.end() || *it != obj);
-
-    const int row = std::distance(m_objects.begin(), it);
-    Q_ASSERT(row >= 0 && row <= m_objects.size());
+    QVector<QObject *> added = objs;
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+    // insertSortedObjects() must not see objects we have already
+    added.erase(std::remove_if(added.begin(), added.end(), [this](QObject *obj) {
+        return std::binary_search(m_objects.constBegin(), m_objects.constEnd(), obj);
+    }), added.end());
 
-    beginInsertRows(QModelIndex(), row, row);
-    m_objects.insert(it, obj);
-    Q_ASSERT(m_objects.at(row) == obj);
-    endInsertRows();
+    insertSortedObjects(m_objects, added);
 }
 
 void ObjectListModel::objectRemoved(QObject *obj)
@@ -58,11 +58,13 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
     int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
+    /** Adds a batch of newly created objects, called by Probe instead of objectCreated. */
+    void objectsAdded(const QVector<QObject *> &objs);
+
 public slots:
     QPair<int, QVariant> defaultSelectedItem() const;
 
 private slots:
-    void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
 
 private:
@@ -47,6 +47,9 @@
 
 #include <QModelIndex>
 #include <QObject>
+#include <QVector>
+
+#include <algorithm>
 
 namespace GammaRay {
 /**
@@ -149,6 +152,38 @@ public:
         }
         return Base::headerData(section, orientation, role);
     }
+
+protected:
+    /**
+     * Merges the sorted @p added objects into the sorted rows @p objects below @p parent.
+     * Row insertion is announced once per contiguous range of new rows.
+     * @param objects the sorted model storage, must not contain any of @p added.
+     * @param added the sorted new objects.
+     * @param parent is the model QModelIndex @p objects belong to.
+     */
+    void insertSortedObjects(QVector<QObject *> &objects, const QVector<QObject *> &added,
+                             const QModelIndex &parent = QModelIndex())
+    {
+        int pos = 0;
+        int first = 0;
+        while (first < added.size()) {
+            pos = std::lower_bound(objects.constBegin() + pos, objects.constEnd(),
+                                   added.at(first)) - objects.constBegin();
+            // extend the range up to the next existing row
+            int last = first + 1;
+            while (last < added.size() && (pos == objects.size() || added.at(last) < objects.at(pos)))
+                ++last;
+            const int count = last - first;
+
+            this->beginInsertRows(parent, pos, pos + count - 1);
+            objects.insert(pos, count, nullptr);
+            std::copy(added.constBegin() + first, added.constBegin() + last, objects.begin() + pos);
+            this->endInsertRows();
+
+            pos += count;
+            first = last;
+        }
+    }
 };
 }
 
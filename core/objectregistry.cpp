@@ -0,0 +1,91 @@
+/*
+  objectregistry.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectregistry.h"
+
+using namespace GammaRay;
+
+ObjectRegistry::ObjectRegistry()
+    : m_shards(new Shard[ShardCount])
+{
+}
+
+ObjectRegistry::~ObjectRegistry()
+{
+    delete[] m_shards;
+}
+
+ObjectRegistry::Shard *ObjectRegistry::shardFor(QObject *obj) const
+{
+    // the lower bits are always the same due to alignment
+    return &m_shards[(reinterpret_cast<quintptr>(obj) >> 4) & (ShardCount - 1)];
+}
+
+bool ObjectRegistry::contains(QObject *obj) const
+{
+    Shard *shard = shardFor(obj);
+    QMutexLocker lock(&shard->lock);
+    return shard->objects.contains(obj);
+}
+
+bool ObjectRegistry::insert(QObject *obj)
+{
+    Shard *shard = shardFor(obj);
+    QMutexLocker lock(&shard->lock);
+    if (shard->objects.contains(obj))
+        return false;
+    shard->objects.insert(obj);
+    return true;
+}
+
+bool ObjectRegistry::remove(QObject *obj)
+{
+    Shard *shard = shardFor(obj);
+    QMutexLocker lock(&shard->lock);
+    return shard->objects.remove(obj);
+}
+
+bool ObjectRegistry::remove(QObject *obj, QMutex *barrier)
+{
+    Shard *shard = shardFor(obj);
+    shard->lock.lock();
+    if (barrier->tryLock()) {
+        // nobody relies on obj right now, and anyone taking barrier from now on will block
+        // in contains() until we are done here
+        barrier->unlock();
+        const bool removed = shard->objects.remove(obj);
+        shard->lock.unlock();
+        return removed;
+    }
+
+    // the barrier holder might be waiting for the shard lock in contains(), so we must not
+    // hold on to that while waiting for the barrier
+    shard->lock.unlock();
+    QMutexLocker barrierLock(barrier);
+    QMutexLocker shardLock(&shard->lock);
+    return shard->objects.remove(obj);
+}
@@ -0,0 +1,83 @@
+/*
+  objectregistry.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTREGISTRY_H
+#define GAMMARAY_OBJECTREGISTRY_H
+
+#include <QMutex>
+#include <QSet>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/**
+ * Thread-safe set of all objects known to the probe.
+ *
+ * Objects are distributed over independently locked shards based on their address,
+ * so lookups, insertions and removals from different threads usually don't contend.
+ */
+class ObjectRegistry
+{
+public:
+    ObjectRegistry();
+    ~ObjectRegistry();
+
+    bool contains(QObject *obj) const;
+    /** Returns @c false if @p obj was known already. */
+    bool insert(QObject *obj);
+    /** Returns @c false if @p obj was not known. */
+    bool remove(QObject *obj);
+    /**
+     * Like remove(), but blocks while anyone else holds @p barrier.
+     * This does not serialize with other removals as long as @p barrier is not in use,
+     * which allows code holding @p barrier to rely on contains() until it releases it.
+     */
+    bool remove(QObject *obj, QMutex *barrier);
+
+private:
+    Q_DISABLE_COPY(ObjectRegistry)
+
+    enum {
+        ShardCount = 64 // needs to be a power of two
+    };
+
+    struct Shard
+    {
+        mutable QMutex lock;
+        QSet<QObject *> objects;
+        char padding[64 - sizeof(QMutex) - sizeof(QSet<QObject *>)]; // avoid false sharing
+    };
+
+    Shard *shardFor(QObject *obj) const;
+
+    Shard *m_shards;
+};
+}
+
+#endif // GAMMARAY_OBJECTREGISTRY_H
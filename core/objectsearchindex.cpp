@@ -0,0 +1,197 @@
+/*
+  objectsearchindex.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsearchindex.h"
+#include "objectdataprovider.h"
+#include "probe.h"
+
+#include <QMutexLocker>
+#include <QRegExp>
+
+#include <cstring>
+
+using namespace GammaRay;
+
+ObjectSearchIndex::ObjectSearchIndex(Probe *probe)
+    : QObject(probe)
+{
+    connect(probe, SIGNAL(objectDestroyed(QObject*)), this, SLOT(objectRemoved(QObject*)));
+}
+
+ObjectSearchIndex::~ObjectSearchIndex()
+{
+}
+
+bool ObjectSearchIndex::canHandle(const QRegExp &regExp, int filterKeyColumn)
+{
+    return regExp.patternSyntax() == QRegExp::FixedString
+           && regExp.caseSensitivity() == Qt::CaseInsensitive
+           && !regExp.pattern().isEmpty()
+           && (filterKeyColumn == -1 || filterKeyColumn == 0);
+}
+
+bool ObjectSearchIndex::matches(QObject *object, const QRegExp &regExp, int filterKeyColumn)
+{
+    Q_ASSERT(canHandle(regExp, filterKeyColumn));
+    setQuery(regExp.pattern().toCaseFolded());
+
+    Entry entry;
+    if (!lookup(object, &entry))
+        return false;
+
+    if (m_stringMatches.testBit(entry.nameId))
+        return true;
+    // column 1 is the type name
+    if (filterKeyColumn == -1 && m_stringMatches.testBit(entry.typeId))
+        return true;
+    // column 0 shows the address only for unnamed objects, see Util::shortDisplayString()
+    return !m_addressQuery.isEmpty() && m_strings.at(entry.nameId).isEmpty()
+           && addressMatches(object);
+}
+
+void ObjectSearchIndex::objectRemoved(QObject *object)
+{
+    const auto it = m_entries.find(object);
+    if (it == m_entries.end())
+        return;
+    releaseString(it.value().nameId);
+    releaseString(it.value().typeId);
+    m_entries.erase(it);
+}
+
+bool ObjectSearchIndex::lookup(QObject *object, Entry *entry)
+{
+    const auto it = m_entries.constFind(object);
+    if (it != m_entries.constEnd()) {
+        *entry = it.value();
+        return true;
+    }
+
+    QString name;
+    QString typeName;
+    {
+        QMutexLocker lock(Probe::objectLock());
+        if (!Probe::instance()->isValidObject(object))
+            return false;
+        name = ObjectDataProvider::name(object);
+        typeName = ObjectDataProvider::typeName(object);
+    }
+
+    entry->nameId = acquireString(name.toCaseFolded());
+    entry->typeId = acquireString(typeName.toCaseFolded());
+    m_entries.insert(object, *entry);
+    return true;
+}
+
+int ObjectSearchIndex::acquireString(const QString &str)
+{
+    auto it = m_stringIds.constFind(str);
+    if (it != m_stringIds.constEnd()) {
+        ++m_stringRefs[it.value()];
+        return it.value();
+    }
+
+    int id;
+    if (m_freeStringIds.isEmpty()) {
+        id = m_strings.size();
+        m_strings.push_back(str);
+        m_stringRefs.push_back(1);
+        m_stringMatches.resize(m_strings.size());
+    } else {
+        id = m_freeStringIds.last();
+        m_freeStringIds.pop_back();
+        m_strings[id] = str;
+        m_stringRefs[id] = 1;
+    }
+    m_stringIds.insert(str, id);
+
+    if (!m_query.isEmpty() && str.contains(m_query)) {
+        m_stringMatches.setBit(id);
+        m_matchingStrings.push_back(id);
+    }
+    return id;
+}
+
+void ObjectSearchIndex::releaseString(int id)
+{
+    if (--m_stringRefs[id] > 0)
+        return;
+
+    m_stringIds.remove(m_strings.at(id));
+    m_strings[id].clear();
+    if (m_stringMatches.testBit(id)) {
+        m_stringMatches.clearBit(id);
+        m_matchingStrings.remove(m_matchingStrings.indexOf(id));
+    }
+    m_freeStringIds.push_back(id);
+}
+
+void ObjectSearchIndex::setQuery(const QString &query)
+{
+    if (query == m_query)
+        return;
+
+    if (!m_query.isEmpty() && query.contains(m_query)) {
+        // refinement, only what matched so far can still match
+        QVector<int> matching;
+        matching.reserve(m_matchingStrings.size());
+        foreach (int id, m_matchingStrings) {
+            if (m_strings.at(id).contains(query))
+                matching.push_back(id);
+            else
+                m_stringMatches.clearBit(id);
+        }
+        m_matchingStrings = matching;
+    } else {
+        m_stringMatches.fill(false);
+        m_matchingStrings.clear();
+        for (int id = 0; id < m_strings.size(); ++id) {
+            if (m_stringRefs.at(id) > 0 && m_strings.at(id).contains(query)) {
+                m_stringMatches.setBit(id);
+                m_matchingStrings.push_back(id);
+            }
+        }
+    }
+    m_query = query;
+
+    m_addressQuery = m_query.toLatin1();
+    foreach (const QChar &c, m_query) {
+        if ((c < QLatin1Char('0') || c > QLatin1Char('9')) && (c < QLatin1Char('a') || c > QLatin1Char('f')) && c != QLatin1Char('x')) {
+            m_addressQuery.clear();
+            break;
+        }
+    }
+}
+
+bool ObjectSearchIndex::addressMatches(QObject *object) const
+{
+    // same format as Util::addressToString()
+    char address[2 * sizeof(void *) + 3];
+    qsnprintf(address, sizeof(address), "0x%llx",
+              static_cast<qulonglong>(reinterpret_cast<quintptr>(object)));
+    return strstr(address, m_addressQuery.constData()) != nullptr;
+}
@@ -0,0 +1,99 @@
+/*
+  objectsearchindex.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSEARCHINDEX_H
+#define GAMMARAY_OBJECTSEARCHINDEX_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QRegExp;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+class Probe;
+
+/** Search index over object name, type name and address, for the object model search proxies.
+ *
+ *  Names and type names are interned, so a query only needs to be matched against
+ *  the distinct strings instead of against every object. A query extending the previous
+ *  one only re-checks the strings that matched before. Objects are indexed on first
+ *  lookup and dropped again on destruction, renames after that are not picked up.
+ *
+ *  Only to be used from the main thread.
+ */
+class ObjectSearchIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ObjectSearchIndex(Probe *probe);
+    ~ObjectSearchIndex();
+
+    /** Returns @c true if the filter settings of a QSortFilterProxyModel on top of one of
+     *  the object models can be evaluated by matches().
+     */
+    static bool canHandle(const QRegExp &regExp, int filterKeyColumn);
+
+    /** Equivalent of the QSortFilterProxyModel filter for @p object, see canHandle(). */
+    bool matches(QObject *object, const QRegExp &regExp, int filterKeyColumn);
+
+private slots:
+    void objectRemoved(QObject *object);
+
+private:
+    struct Entry {
+        int nameId;
+        int typeId;
+    };
+    bool lookup(QObject *object, Entry *entry);
+    int acquireString(const QString &str);
+    void releaseString(int id);
+    void setQuery(const QString &query);
+    bool addressMatches(QObject *object) const;
+
+    QHash<QObject *, Entry> m_entries;
+
+    // interned case-folded strings, ids of released strings are reused
+    QVector<QString> m_strings;
+    QVector<int> m_stringRefs;
+    QHash<QString, int> m_stringIds;
+    QVector<int> m_freeStringIds;
+
+    // state of the current query
+    QString m_query;
+    QBitArray m_stringMatches;
+    QVector<int> m_matchingStrings;
+    QByteArray m_addressQuery; // empty if the query can't match an address
+};
+}
+
+#endif // GAMMARAY_OBJECTSEARCHINDEX_H
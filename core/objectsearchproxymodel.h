@@ -0,0 +1,52 @@
+/*
+  objectsearchproxymodel.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSEARCHPROXYMODEL_H
+#define GAMMARAY_OBJECTSEARCHPROXYMODEL_H
+
+#include "gammaray_core_export.h"
+
+#include <3rdparty/kde/krecursivefilterproxymodel.h>
+
+namespace GammaRay {
+/** Recursive search proxy for the object tree model, or filtered versions of it.
+ *  Plain text searches are answered by the probe's ObjectSearchIndex rather than by
+ *  matching the display strings of every row.
+ */
+class GAMMARAY_CORE_EXPORT ObjectSearchProxyModel : public KRecursiveFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit ObjectSearchProxyModel(QObject *parent = nullptr);
+    ~ObjectSearchProxyModel();
+
+protected:
+    bool acceptRow(int sourceRow, const QModelIndex &sourceParent) const Q_DECL_OVERRIDE;
+};
+}
+
+#endif // GAMMARAY_OBJECTSEARCHPROXYMODEL_H
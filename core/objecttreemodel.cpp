@@ -48,8 +48,6 @@ using namespace GammaRay;
 ObjectTreeModel::ObjectTreeModel(Probe *probe)
     : ObjectModelBase< QAbstractItemModel >(probe)
 {
-    connect(probe, SIGNAL(objectCreated(QObject*)),
-            this, SLOT(objectAdded(QObject*)));
     connect(probe, SIGNAL(objectDestroyed(QObject*)),
             this, SLOT(objectRemoved(QObject*)));
     connect(probe, SIGNAL(objectReparented(QObject*)),
@@ -67,51 +65,53 @@ static inline QObject *parentObject(QObject *obj)
     return obj->parent();
 }
 
-void ObjectTreeModel::objectAdded(QObject *obj)
+void ObjectTreeModel::objectsAdded(const QVector<QObject *> &objs)
 {
-    // see Probe::objectCreated, that promises a valid object in the main thread here
+    // see Probe::objectCreated, that promises valid objects in the main thread here
     Q_ASSERT(thread() == QThread::currentThread());
-    Q_ASSERT(Probe::instance()->isValidObject(obj));
-
-    IF_DEBUG(cout << "tree obj added: " << hex << obj << " p: " << parentObject(obj) << endl;
-             )
-    Q_ASSERT(!obj->parent() || Probe::instance()->isValidObject(parentObject(obj)));
-
-    if (indexForObject(obj).isValid()) {
-        IF_DEBUG(cout << "tree double obj added: " << hex << obj << endl;
-                 )
-        return;
-    }
 
     // this is ugly, but apparently it can happen
     // that an object gets created without parent
     // then later the delayed signal comes in
-    // so catch this gracefully by first adding the
-    // parent if required
-    if (parentObject(obj)) {
-        const QModelIndex index = indexForObject(parentObject(obj));
-        if (!index.isValid()) {
-            IF_DEBUG(cout << "tree: handle parent first" << endl;
+    // so catch this gracefully by also adding
+    // any unknown ancestors
+    QSet<QObject *> added;
+    QHash<QObject *, QVector<QObject *> > addedChildren;
+    foreach (QObject *obj, objs) {
+        for (QObject *o = obj; o && !m_childParentMap.contains(o) && !added.contains(o);
+             o = parentObject(o)) {
+            Q_ASSERT(Probe::instance()->isValidObject(o));
+            IF_DEBUG(cout << "tree obj added: " << hex << o << " p: " << parentObject(o) << endl;
                      )
-            objectAdded(parentObject(obj));
+            added.insert(o);
+            addedChildren[parentObject(o)].push_back(o);
         }
     }
 
-    const QModelIndex index = indexForObject(parentObject(obj));
-
-    // either we get a proper parent and hence valid index or there is no parent
-    Q_ASSERT(index.isValid() || !parentObject(obj));
-
-    QVector<QObject *> &children = m_parentChildMap[ parentObject(obj) ];
-    QVector<QObject *>::iterator it = std::lower_bound(children.begin(), children.end(), obj);
-    const int row = std::distance(children.begin(), it);
+    // sub-trees below new objects are not reachable before their root is inserted,
+    // so those can be filled in without any notification
+    for (auto it = addedChildren.begin(); it != addedChildren.end(); ++it) {
+        std::sort(it.value().begin(), it.value().end());
+        if (!added.contains(it.key()))
+            continue;
+        m_parentChildMap.insert(it.key(), it.value());
+        foreach (QObject *child, it.value())
+            m_childParentMap.insert(child, it.key());
+    }
 
-    beginInsertRows(index, row, row);
+    for (auto it = addedChildren.constBegin(); it != addedChildren.constEnd(); ++it) {
+        QObject *parentObj = it.key();
+        if (added.contains(parentObj))
+            continue;
 
-    children.insert(it, obj);
-    m_childParentMap.insert(obj, parentObject(obj));
+        const QModelIndex index = indexForObject(parentObj);
+        // either we get a proper parent and hence valid index or there is no parent
+        Q_ASSERT(index.isValid() || !parentObj);
 
-    endInsertRows();
+        foreach (QObject *child, it.value())
+            m_childParentMap.insert(child, parentObj);
+        insertSortedObjects(m_parentChildMap[parentObj], it.value(), index);
+    }
 }
 
 void ObjectTreeModel::objectRemoved(QObject *obj)
@@ -169,7 +169,7 @@ void ObjectTreeModel::objectReparented(QObject *obj)
     // we didn't know obj yet
     if (!m_childParentMap.contains(obj)) {
         Q_ASSERT(!m_parentChildMap.contains(obj));
-        objectAdded(obj);
+        objectsAdded(QVector<QObject *>() << obj);
         return;
     }
 
@@ -231,6 +231,11 @@ int ObjectTreeModel::rowCount(const QModelIndex &parent) const
     return m_parentChildMap.value(parentObj).size();
 }
 
+QVector<QObject *> ObjectTreeModel::childObjects(QObject *parent) const
+{
+    return m_parentChildMap.value(parent);
+}
+
 QModelIndex ObjectTreeModel::parent(const QModelIndex &child) const
 {
     QObject *childObj = reinterpret_cast<QObject *>(child.internalPointer());
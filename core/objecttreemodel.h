@@ -31,6 +31,7 @@
 
 #include "objectmodelbase.h"
 
+#include <QSet>
 #include <QVector>
 
 namespace GammaRay {
@@ -48,11 +49,18 @@ public:
     QModelIndex index(int row, int column,
                       const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
+    /** Adds a batch of newly created objects, called by Probe instead of objectCreated. */
+    void objectsAdded(const QVector<QObject *> &objs);
+
+    /** Children of @p parent known to the model, nullptr for the top-level objects.
+     *  Only to be used from the main thread.
+     */
+    QVector<QObject *> childObjects(QObject *parent) const;
+
 public slots:
     QPair<int, QVariant> defaultSelectedItem() const;
 
 private slots:
-    void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
     void objectReparented(QObject *obj);
 
@@ -34,9 +34,13 @@
 #include "enumrepositoryserver.h"
 #include "metaobjectrepository.h"
 #include "objectlistmodel.h"
+#include "objectsearchindex.h"
 #include "objecttreemodel.h"
+#include "objectregistry.h"
 #include "probesettings.h"
 #include "probecontroller.h"
+#include "signaleventqueue.h"
+#include "signalindexcache.h"
 #include "toolmanager.h"
 #include "toolpluginmodel.h"
 #include "util.h"
@@ -102,29 +106,53 @@ QAtomicPointer<Probe> Probe::s_instance = QAtomicPointer<Probe>(nullptr);
 namespace GammaRay {
 static void signal_begin_callback(QObject *caller, int method_index, void **argv)
 {
-    if (method_index == 0 || Probe::instance()->filterObject(caller))
+    if (method_index == 0)
+        return;
+
+    if (Probe::instance()->filterObject(caller)) {
+        SignalEventQueue::recordBegin(caller, nullptr, method_index, true);
         return;
+    }
 
+    const QMetaObject *metaObject = SignalIndexCache::cacheableMetaObject(caller);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-    method_index = Util::signalIndexToMethodIndex(caller->metaObject(), method_index);
+    if (metaObject)
+        method_index = SignalIndexCache::methodIndex(metaObject, method_index);
+    else
+        method_index = Util::signalIndexToMethodIndex(caller->metaObject(), method_index);
 #endif
+    SignalEventQueue::recordBegin(caller, metaObject, method_index, false);
     Probe::executeSignalCallback([=](const SignalSpyCallbackSet &callbacks) {
             if (callbacks.signalBeginCallback)
                 callbacks.signalBeginCallback(caller, method_index, argv);
         });
 }
 
+// only used when there are no synchronous signal end callbacks, avoids the object lock
+static void signal_event_end_callback(QObject *caller, int method_index)
+{
+    if (method_index == 0)
+        return;
+
+    SignalEventQueue::recordEnd(caller);
+}
+
 static void signal_end_callback(QObject *caller, int method_index)
 {
     if (method_index == 0)
         return;
 
+    SignalEventQueue::recordEnd(caller);
+
     QMutexLocker locker(Probe::objectLock());
     if (!Probe::instance()->isValidObject(caller)) // implies filterObject()
         return; // deleted in the slot
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-    method_index = Util::signalIndexToMethodIndex(caller->metaObject(), method_index);
+    if (const QMetaObject *metaObject = SignalIndexCache::cacheableMetaObject(caller))
+        method_index = SignalIndexCache::methodIndex(metaObject, method_index);
+    else
+        method_index = Util::signalIndexToMethodIndex(caller->metaObject(), method_index);
 #endif
     Probe::executeSignalCallback([=](const SignalSpyCallbackSet &callbacks) {
             if (callbacks.signalEndCallback)
@@ -198,16 +226,21 @@ struct Listener
 
 Q_GLOBAL_STATIC(Listener, s_listener)
 
-// ensures proper information is returned by isValidObject by
-// locking it in objectAdded/Removed
+// ensures objects stay valid while being accessed, object removals from other threads
+// block on this, see ObjectRegistry::remove()
 Q_GLOBAL_STATIC_WITH_ARGS(QMutex, s_lock, (QMutex::Recursive))
 
 Probe::Probe(QObject *parent)
     : QObject(parent)
     , m_objectListModel(new ObjectListModel(this))
     , m_objectTreeModel(new ObjectTreeModel(this))
+    , m_objectSearchIndex(new ObjectSearchIndex(this))
     , m_window(nullptr)
+    , m_validObjects(new ObjectRegistry)
+    , m_filterCacheEnabled(false)
+    , m_creationBatchDepth(0)
     , m_queueTimer(new QTimer(this))
+    , m_signalEventQueue(new SignalEventQueue(this))
     , m_server(nullptr)
 {
     Q_ASSERT(thread() == qApp->thread());
@@ -238,6 +271,8 @@ Probe::Probe(QObject *parent)
     m_queueTimer->setInterval(0);
     connect(m_queueTimer, SIGNAL(timeout()),
             this, SLOT(processQueuedObjectChanges()));
+    connect(m_signalEventQueue, SIGNAL(eventsAvailable(QVector<GammaRay::SignalEvent>)),
+            this, SLOT(dispatchSignalEvents(QVector<GammaRay::SignalEvent>)));
 
     m_previousSignalSpyCallbackSet.signalBeginCallback
         = qt_signal_spy_callback_set.signal_begin_callback;
@@ -268,11 +303,13 @@ Probe::~Probe()
     VariantHandler::clear();
 
     s_instance = QAtomicPointer<Probe>(nullptr);
+    delete m_validObjects;
 }
 
 void Probe::setWindow(QObject *window)
 {
     m_window = window;
+    m_filterCacheGeneration.ref();
 }
 
 QObject *Probe::window() const
@@ -340,6 +377,7 @@ void Probe::createProbe(bool findExisting)
         s_instance = QAtomicPointer<Probe>(probe);
 
         // add objects to the probe that were tracked before its creation
+        ++probe->m_creationBatchDepth;
         foreach (QObject *obj, s_listener()->addedBeforeProbeInstance)
             objectAdded(obj);
         s_listener()->addedBeforeProbeInstance.clear();
@@ -347,6 +385,8 @@ void Probe::createProbe(bool findExisting)
         // try to find existing objects by other means
         if (findExisting)
             probe->findExistingObjects();
+        --probe->m_creationBatchDepth;
+        probe->announceCreatedObjects();
     }
 
     // eventually initialize the rest
@@ -375,6 +415,8 @@ void Probe::startupHookReceived()
 void Probe::delayedInit()
 {
     QCoreApplication::instance()->installEventFilter(this);
+    // from now on we see all reparenting, and with reliable tracking all destructions too
+    m_filterCacheEnabled = hasReliableObjectTracking();
 
     QString appName = qApp->applicationName();
     if (appName.isEmpty() && !qApp->arguments().isEmpty()) {
@@ -441,6 +483,15 @@ void Probe::showInProcessUi()
              )
 }
 
+static inline int loadGeneration(const QAtomicInt &generation)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    return generation.load();
+#else
+    return generation;
+#endif
+}
+
 bool Probe::filterObject(QObject *obj) const
 {
     if (obj->thread() != thread()) {
@@ -448,6 +499,24 @@ bool Probe::filterObject(QObject *obj) const
         return false;
     }
 
+    // the cache is only ever touched from our thread
+    if (!m_filterCacheEnabled || QThread::currentThread() != thread())
+        return computeFilterVerdict(obj);
+
+    const int generation = loadGeneration(m_filterCacheGeneration);
+    const auto it = m_filterCache.constFind(obj);
+    if (it != m_filterCache.constEnd() && it.value().generation == generation)
+        return it.value().filtered;
+
+    FilterVerdict verdict;
+    verdict.filtered = computeFilterVerdict(obj);
+    verdict.generation = generation;
+    m_filterCache.insert(obj, verdict);
+    return verdict.filtered;
+}
+
+bool Probe::computeFilterVerdict(QObject *obj) const
+{
     QSet<QObject *> visitedObjects;
     int iteration = 0;
     QObject *o = obj;
@@ -472,6 +541,18 @@ bool Probe::filterObject(QObject *obj) const
     return false;
 }
 
+void Probe::invalidateFilterCache(QObject *obj)
+{
+    if (QThread::currentThread() != thread())
+        return;
+
+    // newly created objects have neither cached verdicts themselves nor any children with one,
+    // everything else invalidates the verdicts of the entire sub-tree
+    if (!m_filterCache.contains(obj) && obj->children().isEmpty())
+        return;
+    m_filterCacheGeneration.ref();
+}
+
 void Probe::registerModel(const QString &objectName, QAbstractItemModel *model)
 {
     RemoteModelServer *ms = new RemoteModelServer(objectName, model);
@@ -489,6 +570,11 @@ QAbstractItemModel *Probe::objectTreeModel() const
     return m_objectTreeModel;
 }
 
+ObjectSearchIndex *Probe::objectSearchIndex() const
+{
+    return m_objectSearchIndex;
+}
+
 QObject *Probe::probe() const
 {
     return const_cast<GammaRay::Probe *>(this);
@@ -496,9 +582,7 @@ QObject *Probe::probe() const
 
 bool Probe::isValidObject(QObject *obj) const
 {
-    ///TODO: can we somehow assert(s_lock().isLocked()) ?!
-    ///  -> Not with a recursive mutex. Make it non-recursive, and you can do Q_ASSERT(!s_lock().tryLock());
-    return m_validObjects.contains(obj);
+    return m_validObjects->contains(obj);
 }
 
 QMutex *Probe::objectLock()
@@ -524,8 +608,6 @@ QMutex *Probe::objectLock()
  */
 void Probe::objectAdded(QObject *obj, bool fromCtor)
 {
-    QMutexLocker lock(s_lock());
-
     // attempt to ignore objects created by GammaRay itself, especially short-lived ones
     if (fromCtor && ProbeGuard::insideProbe() && obj->thread() == QThread::currentThread())
         return;
@@ -538,15 +620,21 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
 #endif
 
     if (!isInitialized()) {
-        IF_DEBUG(cout
-                 << "objectAdded Before: "
-                 << hex << obj
-                 << (fromCtor ? " (from ctor)" : "") << endl;
-                 )
-        s_listener()->addedBeforeProbeInstance << obj;
-        return;
+        QMutexLocker lock(s_lock());
+        // createProbe() sets the instance while holding the lock, so check again
+        if (!isInitialized()) {
+            IF_DEBUG(cout
+                     << "objectAdded Before: "
+                     << hex << obj
+                     << (fromCtor ? " (from ctor)" : "") << endl;
+                     )
+            s_listener()->addedBeforeProbeInstance << obj;
+            return;
+        }
     }
 
+    // from here on we only need the object lock when running in our thread, hooks
+    // from other threads only go through the object registry and the change queue
     if (instance()->filterObject(obj)) {
         IF_DEBUG(cout
                  << "objectAdded Filter: "
@@ -556,7 +644,7 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
         return;
     }
 
-    if (instance()->m_validObjects.contains(obj)) {
+    if (instance()->m_validObjects->contains(obj)) {
         // this happens when we get a child event before the objectAdded call from the ctor
         // or when we add an item from addedBeforeProbeInstance who got added already
         // due to the add-parent-before-child logic
@@ -569,11 +657,12 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
     }
 
     // make sure we already know the parent
-    if (obj->parent() && !instance()->m_validObjects.contains(obj->parent()))
+    if (obj->parent() && !instance()->m_validObjects->contains(obj->parent()))
         objectAdded(obj->parent(), fromCtor);
-    Q_ASSERT(!obj->parent() || instance()->m_validObjects.contains(obj->parent()));
+    Q_ASSERT(!obj->parent() || instance()->m_validObjects->contains(obj->parent()));
 
-    instance()->m_validObjects << obj;
+    if (!instance()->m_validObjects->insert(obj))
+        return; // added concurrently from another thread meanwhile
     if (!instance()->hasReliableObjectTracking()) {
         // when we did not use a preload variant that
         // overwrites qt_removeObject we must track object
@@ -595,10 +684,12 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
                   << ", p: " << obj->parent() << endl;
              )
 
-    if (fromCtor)
+    if (fromCtor) {
         instance()->queueCreatedObject(obj);
-    else
+    } else {
+        QMutexLocker lock(s_lock());
         instance()->objectFullyConstructed(obj);
+    }
 }
 
 // pre-conditions: lock may or may not be held already, our thread
@@ -612,22 +703,35 @@ void Probe::processQueuedObjectChanges()
     // must be called from the main thread via timeout
     Q_ASSERT(QThread::currentThread() == thread());
 
-    foreach (const auto &change, m_queuedObjectChanges) {
+    QVector<ObjectChange> changes;
+    {
+        QMutexLocker queueLock(&m_queueLock);
+        changes = m_queuedObjectChanges;
+        m_queuedObjectChanges.clear();
+        m_queuedObjectCreations.clear();
+    }
+
+    ++m_creationBatchDepth;
+    foreach (const auto &change, changes) {
+        if (!change.obj) // purged
+            continue;
         switch (change.type) {
         case ObjectChange::Create:
             objectFullyConstructed(change.obj);
             break;
         case ObjectChange::Destroy:
+            // keep the order of creations and destructions, addresses get reused
+            announceCreatedObjects();
             emit objectDestroyed(change.obj);
             break;
         }
     }
+    --m_creationBatchDepth;
+    announceCreatedObjects();
 
     IF_DEBUG(cout << Q_FUNC_INFO << " done" << endl;
              )
 
-    m_queuedObjectChanges.clear();
-
     foreach (QObject *obj, m_pendingReparents) {
         if (!isValidObject(obj))
             continue;
@@ -644,7 +748,7 @@ void Probe::objectFullyConstructed(QObject *obj)
 {
     Q_ASSERT(thread() == QThread::currentThread());
 
-    if (!m_validObjects.contains(obj)) {
+    if (!m_validObjects->contains(obj)) {
         // deleted already
         IF_DEBUG(cout << "stale fully constructed: " << hex << obj << endl;
                  )
@@ -655,7 +759,7 @@ void Probe::objectFullyConstructed(QObject *obj)
         // when the call was delayed from the ctor construction,
         // the parent might not have been set properly yet. hence
         // apply the filter again
-        m_validObjects.remove(obj);
+        m_validObjects->remove(obj);
         IF_DEBUG(cout << "now filtered fully constructed: " << hex << obj << endl;
                  )
         return;
@@ -666,12 +770,12 @@ void Probe::objectFullyConstructed(QObject *obj)
 
     // ensure we know all our ancestors already
     for (QObject *parent = obj->parent(); parent; parent = parent->parent()) {
-        if (!m_validObjects.contains(parent)) {
+        if (!m_validObjects->contains(parent)) {
             objectAdded(parent); // will also handle any further ancestors
             break;
         }
     }
-    Q_ASSERT(!obj->parent() || m_validObjects.contains(obj->parent()));
+    Q_ASSERT(!obj->parent() || m_validObjects->contains(obj->parent()));
 
     // QQuickItem has the briliant idea of suppressing child events, so we need an
     // alternative way of detecting reparenting...
@@ -681,7 +785,26 @@ void Probe::objectFullyConstructed(QObject *obj)
 
     m_toolManager->objectAdded(obj);
 
-    emit objectCreated(obj);
+    m_createdObjects.push_back(obj);
+    if (!m_creationBatchDepth)
+        announceCreatedObjects();
+}
+
+// pre-condition: lock is held already, our thread
+void Probe::announceCreatedObjects()
+{
+    if (m_createdObjects.isEmpty())
+        return;
+
+    const QVector<QObject *> objs = m_createdObjects;
+    m_createdObjects.clear();
+
+    m_objectListModel->objectsAdded(objs);
+    m_objectTreeModel->objectsAdded(objs);
+    foreach (QObject *obj, objs) {
+        if (isValidObject(obj)) // might have been deleted by a previous receiver
+            emit objectCreated(obj);
+    }
 }
 
 /*
@@ -695,33 +818,58 @@ void Probe::objectFullyConstructed(QObject *obj)
  */
 void Probe::objectRemoved(QObject *obj)
 {
-    QMutexLocker lock(s_lock());
-
     if (!isInitialized()) {
-        IF_DEBUG(cout
-                 << "objectRemoved Before: "
-                 << hex << obj
-                 << " have statics: " << s_listener() << endl;
-                 )
-
-        if (!s_listener())
+        QMutexLocker lock(s_lock());
+        // createProbe() sets the instance while holding the lock, so check again
+        if (!isInitialized()) {
+            IF_DEBUG(cout
+                     << "objectRemoved Before: "
+                     << hex << obj
+                     << " have statics: " << s_listener() << endl;
+                     )
+
+            if (!s_listener())
+                return;
+
+            QVector<QObject *> &addedBefore = s_listener()->addedBeforeProbeInstance;
+            for (QVector<QObject *>::iterator it = addedBefore.begin(); it != addedBefore.end();) {
+                if (*it == obj)
+                    it = addedBefore.erase(it);
+                else
+                    ++it;
+            }
             return;
-
-        QVector<QObject *> &addedBefore = s_listener()->addedBeforeProbeInstance;
-        for (QVector<QObject *>::iterator it = addedBefore.begin(); it != addedBefore.end();) {
-            if (*it == obj)
-                it = addedBefore.erase(it);
-            else
-                ++it;
         }
-        return;
     }
 
     IF_DEBUG(cout << "object removed:" << hex << obj << " " << obj->parent() << endl;
              )
 
-    bool success = instance()->m_validObjects.remove(obj);
-    if (!success) {
+    if (instance()->thread() == QThread::currentThread()) {
+        QMutexLocker lock(s_lock());
+        instance()->m_filterCache.remove(obj); // also needed for untracked objects
+        if (!instance()->m_validObjects->remove(obj)) {
+            // object was not tracked by the probe, probably a gammaray object
+            EXPENSIVE_ASSERT(!instance()->isObjectCreationQueued(obj));
+            return;
+        }
+
+        instance()->purgeChangesForObject(obj);
+        EXPENSIVE_ASSERT(!instance()->isObjectCreationQueued(obj));
+        // deleted while its creation is still waiting for the end of the batch
+        const int pendingIndex = instance()->m_createdObjects.indexOf(obj);
+        if (pendingIndex >= 0)
+            instance()->m_createdObjects.remove(pendingIndex);
+        emit instance()->objectDestroyed(obj);
+        return;
+    }
+
+    // an object of our thread deleted elsewhere, we can't touch the filter cache from here
+    if (obj->thread() == instance()->thread())
+        instance()->m_filterCacheGeneration.ref();
+
+    // other threads don't need to wait for each other, only for users of objectLock()
+    if (!instance()->m_validObjects->remove(obj, s_lock())) {
         // object was not tracked by the probe, probably a gammaray object
         EXPENSIVE_ASSERT(!instance()->isObjectCreationQueued(obj));
         return;
@@ -729,11 +877,7 @@ void Probe::objectRemoved(QObject *obj)
 
     instance()->purgeChangesForObject(obj);
     EXPENSIVE_ASSERT(!instance()->isObjectCreationQueued(obj));
-
-    if (instance()->thread() == QThread::currentThread())
-        emit instance()->objectDestroyed(obj);
-    else
-        instance()->queueDestroyedObject(obj);
+    instance()->queueDestroyedObject(obj);
 }
 
 void Probe::handleObjectDestroyed(QObject *obj)
@@ -747,21 +891,24 @@ void Probe::objectParentChanged()
         emit objectReparented(sender());
 }
 
-// pre-condition: we have the lock, arbitrary thread
+// pre-condition: arbitrary thread
 void Probe::queueCreatedObject(QObject *obj)
 {
     EXPENSIVE_ASSERT(!isObjectCreationQueued(obj));
 
+    QMutexLocker queueLock(&m_queueLock);
     ObjectChange c;
     c.obj = obj;
     c.type = ObjectChange::Create;
+    m_queuedObjectCreations.insert(obj, m_queuedObjectChanges.size());
     m_queuedObjectChanges.push_back(c);
     notifyQueuedObjectChanges();
 }
 
-// pre-condition: we have the lock, arbitrary thread
+// pre-condition: arbitrary thread
 void Probe::queueDestroyedObject(QObject *obj)
 {
+    QMutexLocker queueLock(&m_queueLock);
     ObjectChange c;
     c.obj = obj;
     c.type = ObjectChange::Destroy;
@@ -769,28 +916,29 @@ void Probe::queueDestroyedObject(QObject *obj)
     notifyQueuedObjectChanges();
 }
 
-// pre-condition: we have the lock, arbitrary thread
+// pre-condition: arbitrary thread
 bool Probe::isObjectCreationQueued(QObject *obj) const
 {
-    return std::find_if(m_queuedObjectChanges.begin(), m_queuedObjectChanges.end(),
-                        [obj](const ObjectChange &c) {
-        return c.obj == obj && c.type == Probe::ObjectChange::Create;
-    }) != m_queuedObjectChanges.end();
+    QMutexLocker queueLock(&m_queueLock);
+    return m_queuedObjectCreations.contains(obj);
 }
 
-// pre-condition: we have the lock, arbitrary thread
+// pre-condition: arbitrary thread
 void Probe::purgeChangesForObject(QObject *obj)
 {
-    for (int i = 0; i < m_queuedObjectChanges.size(); ++i) {
-        if (m_queuedObjectChanges.at(i).obj == obj
-            && m_queuedObjectChanges.at(i).type == ObjectChange::Create) {
-            m_queuedObjectChanges.remove(i);
-            return;
-        }
-    }
+    QMutexLocker queueLock(&m_queueLock);
+    const auto it = m_queuedObjectCreations.find(obj);
+    if (it == m_queuedObjectCreations.end())
+        return;
+
+    // only mark as purged, removing would invalidate the positions of all later changes
+    ObjectChange &change = m_queuedObjectChanges[it.value()];
+    Q_ASSERT(change.obj == obj && change.type == ObjectChange::Create);
+    change.obj = nullptr;
+    m_queuedObjectCreations.erase(it);
 }
 
-// pre-condition: we have the lock, arbitrary thread
+// pre-condition: we have the queue lock, arbitrary thread
 void Probe::notifyQueuedObjectChanges()
 {
     if (m_queueTimer->isActive())
@@ -812,6 +960,12 @@ void Probe::notifyQueuedObjectChanges()
 
 bool Probe::eventFilter(QObject *receiver, QEvent *event)
 {
+    // needs to see our own reparenting too, so before the probe guard check
+    if (event->type() == QEvent::ChildAdded || event->type() == QEvent::ChildRemoved)
+        invalidateFilterCache(static_cast<QChildEvent *>(event)->child());
+    else if (event->type() == QEvent::ParentChange)
+        invalidateFilterCache(receiver);
+
     if (ProbeGuard::insideProbe() && receiver->thread() == QThread::currentThread())
         return QObject::eventFilter(receiver, event);
 
@@ -820,7 +974,7 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
         QObject *obj = childEvent->child();
 
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(obj);
+        const bool tracked = m_validObjects->contains(obj);
         const bool filtered = filterObject(obj);
 
         IF_DEBUG(cout << "child event: " << hex << obj << ", p: " << obj->parent() << dec
@@ -846,6 +1000,7 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
         } else if (tracked) {
             if (hasReliableObjectTracking()) { // defer processing this until we know its final location
                 m_pendingReparents.push_back(obj);
+                QMutexLocker queueLock(&m_queueLock);
                 notifyQueuedObjectChanges();
             } else {
                 objectRemoved(obj);
@@ -856,7 +1011,7 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
     // widget only unfortunately, but more precise than ChildAdded/Removed...
     if (event->type() == QEvent::ParentChange) {
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(receiver);
+        const bool tracked = m_validObjects->contains(receiver);
         const bool filtered = filterObject(receiver);
         if (!filtered && tracked && !isObjectCreationQueued(receiver)
             && !isObjectCreationQueued(receiver->parent())) {
@@ -873,7 +1028,7 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
         && event->type() != QEvent::WinIdChange // unsafe since emitted from dtors
         && !filterObject(receiver)) {
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(receiver);
+        const bool tracked = m_validObjects->contains(receiver);
         if (!tracked)
             discoverObject(receiver);
     }
@@ -905,7 +1060,7 @@ void Probe::discoverObject(QObject *obj)
         return;
 
     QMutexLocker lock(s_lock());
-    if (m_validObjects.contains(obj))
+    if (m_validObjects->contains(obj))
         return;
 
     objectAdded(obj);
@@ -976,15 +1131,31 @@ void Probe::registerSignalSpyCallbackSet(const SignalSpyCallbackSet &callbacks)
 void Probe::setupSignalSpyCallbacks()
 {
     QSignalSpyCallbackSet cbs = { nullptr, nullptr, nullptr, nullptr };
+    bool hasEventCallbacks = false;
     foreach (const auto &it, m_signalSpyCallbacks) {
         if (it.signalBeginCallback) cbs.signal_begin_callback = signal_begin_callback;
         if (it.signalEndCallback) cbs.signal_end_callback = signal_end_callback;
         if (it.slotBeginCallback) cbs.slot_begin_callback = slot_begin_callback;
         if (it.slotEndCallback) cbs.slot_end_callback = slot_end_callback;
+        if (it.signalEventCallback) hasEventCallbacks = true;
     }
+    if (hasEventCallbacks) {
+        cbs.signal_begin_callback = signal_begin_callback;
+        if (!cbs.signal_end_callback)
+            cbs.signal_end_callback = signal_event_end_callback;
+    }
+    m_signalEventQueue->setEnabled(hasEventCallbacks);
     qt_register_signal_spy_callbacks(cbs);
 }
 
+void Probe::dispatchSignalEvents(const QVector<SignalEvent> &events)
+{
+    executeSignalCallback([&events](const SignalSpyCallbackSet &callbacks) {
+            if (callbacks.signalEventCallback)
+                callbacks.signalEventCallback(events);
+        });
+}
+
 template<typename Func>
 void Probe::executeSignalCallback(const Func &func)
 {
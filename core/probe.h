@@ -34,7 +34,9 @@
 #include "signalspycallbackset.h"
 
 #include <QObject>
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QSet>
 #include <QVector>
 
@@ -44,16 +46,18 @@ class QModelIndex;
 class QThread;
 class QPoint;
 class QTimer;
-class QMutex;
 QT_END_NAMESPACE
 
 namespace GammaRay {
 class ProbeCreator;
 class ObjectListModel;
+class ObjectSearchIndex;
 class ObjectTreeModel;
 class MainWindow;
 class BenchSuite;
+class ObjectRegistry;
 class Server;
+class SignalEventQueue;
 class ToolManager;
 
 class GAMMARAY_CORE_EXPORT Probe : public QObject, public ProbeInterface
@@ -90,18 +94,25 @@ public:
     QObject *window() const;
     void setWindow(QObject *window);
 
+    /** Search index used by the object model search proxies. */
+    ObjectSearchIndex *objectSearchIndex() const;
+
     QObject *probe() const Q_DECL_OVERRIDE;
 
     /**
      * Lock this to check the validity of a QObject
      * and to access it safely afterwards.
+     *
+     * Object destruction in any thread blocks while this is held, so keep it short.
      */
     static QMutex *objectLock();
 
     /**
      * check whether @p obj is still valid
      *
-     * NOTE: the objectLock must be locked when this is called!
+     * This is thread-safe on its own, but unless the objectLock is held the
+     * result might be outdated by the time you use it. So if you want to access
+     * @p obj afterwards, lock the objectLock before calling this.
      */
     bool isValidObject(QObject *obj) const;
 
@@ -160,6 +171,7 @@ private slots:
     void processQueuedObjectChanges();
     void handleObjectDestroyed(QObject *obj);
     void objectParentChanged();
+    void dispatchSignalEvents(const QVector<GammaRay::SignalEvent> &events);
 
 private:
     friend class ProbeCreator;
@@ -172,6 +184,10 @@ private:
     bool hasReliableObjectTracking() const;
 
     void objectFullyConstructed(QObject *obj);
+    /** Hands the objects collected in m_createdObjects to the object models in one batch
+     *  and emits objectCreated for them.
+     */
+    void announceCreatedObjects();
 
     void queueCreatedObject(QObject *obj);
     void queueDestroyedObject(QObject *obj);
@@ -181,6 +197,9 @@ private:
 
     void findExistingObjects();
 
+    bool computeFilterVerdict(QObject *obj) const;
+    void invalidateFilterCache(QObject *obj);
+
     /** Check if we are capable of showing widgets. */
     static bool canShowWidgets();
     void showInProcessUi();
@@ -196,22 +215,42 @@ private:
 
     ObjectListModel *m_objectListModel;
     ObjectTreeModel *m_objectTreeModel;
+    ObjectSearchIndex *m_objectSearchIndex;
     ToolManager *m_toolManager;
     QObject *m_window;
-    QSet<QObject *> m_validObjects;
+    ObjectRegistry *m_validObjects;
+
+    // filterObject() results for objects in our thread, only valid for the current generation
+    struct FilterVerdict {
+        bool filtered;
+        int generation;
+    };
+    mutable QHash<QObject *, FilterVerdict> m_filterCache;
+    QAtomicInt m_filterCacheGeneration;
+    bool m_filterCacheEnabled;
 
     // all delayed object changes need to go through a single queue, as the order is crucial
+    // the queue is protected by m_queueLock, not by the objectLock
+    mutable QMutex m_queueLock;
     struct ObjectChange {
-        QObject *obj;
+        QObject *obj; // nullptr for purged changes
         enum Type {
             Create,
             Destroy
         } type;
     };
     QVector<ObjectChange> m_queuedObjectChanges;
+    // position of pending Create changes in m_queuedObjectChanges
+    QHash<QObject *, int> m_queuedObjectCreations;
+
+    // fully constructed objects not yet announced to the object models and via objectCreated,
+    // collected while m_creationBatchDepth > 0
+    QVector<QObject *> m_createdObjects;
+    int m_creationBatchDepth;
 
     QList<QObject *> m_pendingReparents;
     QTimer *m_queueTimer;
+    SignalEventQueue *m_signalEventQueue;
     QVector<QObject *> m_globalEventFilters;
     QVector<SignalSpyCallbackSet> m_signalSpyCallbacks;
     SignalSpyCallbackSet m_previousSignalSpyCallbackSet;
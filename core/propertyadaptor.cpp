@@ -29,11 +29,51 @@
 #include "propertyadaptor.h"
 #include "propertydata.h"
 
+#include <QElapsedTimer>
+#include <QMetaType>
+
+#include <algorithm>
+
 using namespace GammaRay;
 
+static qint64 currentTime()
+{
+    static QElapsedTimer timer;
+    if (!timer.isValid())
+        timer.start();
+    return timer.elapsed();
+}
+
+// QVariant falls back to comparing the raw data of user types without registered comparators,
+// that misses changes behind pointers or shared data
+static bool isComparable(const QVariant &value)
+{
+    const int type = value.userType();
+    if (type < QMetaType::User)
+        return true;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 2, 0)
+    if (QMetaType::typeFlags(type) & (QMetaType::PointerToQObject | QMetaType::IsEnumeration))
+        return true;
+    return QMetaType::hasRegisteredComparators(type);
+#else
+    return false;
+#endif
+}
+
+static bool isSameProperty(const PropertyData &lhs, const PropertyData &rhs)
+{
+    return lhs.flags() == rhs.flags()
+           && lhs.typeName() == rhs.typeName()
+           && isComparable(lhs.value())
+           && lhs.value() == rhs.value();
+}
+
 PropertyAdaptor::PropertyAdaptor(QObject *parent)
     : QObject(parent)
 {
+    connect(this, SIGNAL(propertyChanged(int,int)), this, SLOT(invalidateCache(int,int)));
+    connect(this, SIGNAL(propertyAdded(int,int)), this, SLOT(insertCacheEntries(int,int)));
+    connect(this, SIGNAL(propertyRemoved(int,int)), this, SLOT(removeCacheEntries(int,int)));
 }
 
 PropertyAdaptor::~PropertyAdaptor()
@@ -48,9 +88,69 @@ const ObjectInstance &PropertyAdaptor::object() const
 void PropertyAdaptor::setObject(const ObjectInstance &oi)
 {
     m_oi = oi;
+    m_cache.clear();
     doSetObject(m_oi);
 }
 
+PropertyData PropertyAdaptor::cachedPropertyData(int index) const
+{
+    ensureCacheSize(index + 1);
+    auto &entry = m_cache[index];
+    const auto now = currentTime();
+    if (!entry.valid || (!entry.changed && now - entry.readTime >= UpdateInterval)) {
+        entry.data = propertyData(index);
+        entry.readTime = now;
+        entry.valid = true;
+    }
+    return entry.data;
+}
+
+QVector<int> PropertyAdaptor::updateChangedProperties()
+{
+    QVector<int> changed;
+    const auto size = std::min(m_cache.size(), count());
+    const auto now = currentTime();
+    for (int i = 0; i < size; ++i) {
+        auto &entry = m_cache[i];
+        if (!entry.changed)
+            continue;
+        entry.changed = false;
+
+        const auto data = propertyData(i);
+        if (!entry.valid || !isSameProperty(entry.data, data))
+            changed.push_back(i);
+        entry.data = data;
+        entry.readTime = now;
+        entry.valid = true;
+    }
+    return changed;
+}
+
+void PropertyAdaptor::ensureCacheSize(int size) const
+{
+    if (m_cache.size() < size)
+        m_cache.resize(std::max(size, count()));
+}
+
+void PropertyAdaptor::invalidateCache(int first, int last)
+{
+    ensureCacheSize(last + 1);
+    for (int i = first; i <= last; ++i)
+        m_cache[i].changed = true;
+}
+
+void PropertyAdaptor::insertCacheEntries(int first, int last)
+{
+    if (first <= m_cache.size())
+        m_cache.insert(first, last - first + 1, CachedProperty());
+}
+
+void PropertyAdaptor::removeCacheEntries(int first, int last)
+{
+    if (first < m_cache.size())
+        m_cache.remove(first, std::min(last, m_cache.size() - 1) - first + 1);
+}
+
 void PropertyAdaptor::writeProperty(int index, const QVariant &value)
 {
     Q_UNUSED(index);
@@ -31,13 +31,12 @@
 
 #include "gammaray_core_export.h"
 #include "objectinstance.h"
+#include "propertydata.h"
 
 #include <QObject>
 #include <QVector>
 
 namespace GammaRay {
-class PropertyData;
-
 /** Generic interface for accessing properties from various sources of an object. */
 class GAMMARAY_CORE_EXPORT PropertyAdaptor : public QObject
 {
@@ -46,6 +45,9 @@ public:
     explicit PropertyAdaptor(QObject *parent = nullptr);
     ~PropertyAdaptor();
 
+    /** Interval in ms in which property reads and change notifications are merged, about one frame. */
+    static const int UpdateInterval = 16;
+
     /** Returns the object instance who's properties this accesses. */
     const ObjectInstance &object() const;
     /** Set the object instance who's properties we want to access. */
@@ -57,6 +59,16 @@ public:
     /** Property data for all properties. */
     virtual PropertyData propertyData(int index) const = 0;
 
+    /** Cached version of propertyData(). A property is read at most once per frame,
+     *  and after it notified a change only by updateChangedProperties().
+     */
+    PropertyData cachedPropertyData(int index) const;
+
+    /** Re-reads the properties that notified a change since the last call.
+     *  Returns the indexes of those whose value differs from the cached one.
+     */
+    QVector<int> updateChangedProperties();
+
     /** Write a single property value. */
     virtual void writeProperty(int index, const QVariant &value);
 
@@ -85,8 +97,26 @@ signals:
 protected:
     virtual void doSetObject(const ObjectInstance &oi);
 
+private slots:
+    void invalidateCache(int first, int last);
+    void insertCacheEntries(int first, int last);
+    void removeCacheEntries(int first, int last);
+
 private:
+    struct CachedProperty {
+        CachedProperty()
+            : readTime(0)
+            , valid(false)
+            , changed(false) {}
+        PropertyData data;
+        qint64 readTime;
+        bool valid;
+        bool changed;
+    };
+    void ensureCacheSize(int size) const;
+
     ObjectInstance m_oi;
+    mutable QVector<CachedProperty> m_cache;
 };
 }
 
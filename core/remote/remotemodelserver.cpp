@@ -29,9 +29,13 @@
 #include "remotemodelserver.h"
 #include "server.h"
 #include <core/probeguard.h>
+#include <core/propertyadaptor.h>
 #include <common/protocol.h>
+#include <common/compactpayload.h>
 #include <common/message.h>
 #include <common/modelevent.h>
+#include <common/modelutils.h>
+#include <common/remotemodelroles.h>
 
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
@@ -39,22 +43,55 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QIcon>
+#include <QTimer>
 
 #include <iostream>
+#include <limits>
 
 using namespace GammaRay;
 using namespace std;
 
+// beyond this many disjoint ranges per parent we fall back to a single bounding rectangle
+static const int MaxRangesPerParent = 16;
+
+static void mergeRange(QVector<QRect> &ranges, QRect range)
+{
+    // absorb everything that overlaps or touches the new range, which might grow it further
+    for (int i = 0; i < ranges.size();) {
+        if (ranges.at(i).adjusted(-1, -1, 1, 1).intersects(range)) {
+            range |= ranges.at(i);
+            ranges.remove(i);
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+
+    if (ranges.size() >= MaxRangesPerParent) {
+        foreach (const auto &r, ranges)
+            range |= r;
+        ranges.clear();
+    }
+    ranges.push_back(range);
+}
+
 void(*RemoteModelServer::s_registerServerCallback)() = nullptr;
 
 RemoteModelServer::RemoteModelServer(const QString &objectName, QObject *parent)
     : QObject(parent)
     , m_model(nullptr)
     , m_dummyBuffer(new QBuffer(&m_dummyData, this))
+    , m_dataChangedTimer(new QTimer(this))
     , m_monitored(false)
 {
     setObjectName(objectName);
     m_dummyBuffer->open(QIODevice::WriteOnly);
+    m_fetchedRootRows.first = 1;
+    m_fetchedRootRows.last = 0;
+    m_dataChangedTimer->setSingleShot(true);
+    // merge dataChanged signals in the same window as property changes
+    m_dataChangedTimer->setInterval(PropertyAdaptor::UpdateInterval);
+    connect(m_dataChangedTimer, SIGNAL(timeout()), this, SLOT(sendDataChanged()));
     registerServer();
 }
 
@@ -90,20 +127,31 @@ void RemoteModelServer::connectModel()
 
     connect(m_model, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
             SLOT(headerDataChanged(Qt::Orientation,int,int)));
+    connect(m_model, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
+            SLOT(sendDataChanged()));
     connect(m_model, SIGNAL(rowsInserted(QModelIndex,int,int)),
             SLOT(rowsInserted(QModelIndex,int,int)));
     connect(m_model, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
             SLOT(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
     connect(m_model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
             SLOT(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    connect(m_model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+            SLOT(sendDataChanged()));
     connect(m_model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
             SLOT(rowsRemoved(QModelIndex,int,int)));
+    connect(m_model, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)),
+            SLOT(sendDataChanged()));
     connect(m_model, SIGNAL(columnsInserted(QModelIndex,int,int)),
             SLOT(columnsInserted(QModelIndex,int,int)));
+    connect(m_model, SIGNAL(columnsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
+            SLOT(sendDataChanged()));
     connect(m_model, SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
             SLOT(columnsMoved(QModelIndex,int,int,QModelIndex,int)));
+    connect(m_model, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)),
+            SLOT(sendDataChanged()));
     connect(m_model, SIGNAL(columnsRemoved(QModelIndex,int,int)),
             SLOT(columnsRemoved(QModelIndex,int,int)));
+    connect(m_model, SIGNAL(layoutAboutToBeChanged()), SLOT(sendDataChanged()));
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
     connect(m_model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
             SLOT(dataChanged(QModelIndex,QModelIndex)));
@@ -129,20 +177,31 @@ void RemoteModelServer::disconnectModel()
 
     disconnect(m_model, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
                this, SLOT(headerDataChanged(Qt::Orientation,int,int)));
+    disconnect(m_model, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
+               this, SLOT(sendDataChanged()));
     disconnect(m_model, SIGNAL(rowsInserted(QModelIndex,int,int)),
                this, SLOT(rowsInserted(QModelIndex,int,int)));
     disconnect(m_model, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
                this, SLOT(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
     disconnect(m_model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
                this, SLOT(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    disconnect(m_model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+               this, SLOT(sendDataChanged()));
     disconnect(m_model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
                this, SLOT(rowsRemoved(QModelIndex,int,int)));
+    disconnect(m_model, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)),
+               this, SLOT(sendDataChanged()));
     disconnect(m_model, SIGNAL(columnsInserted(QModelIndex,int,int)),
                this, SLOT(columnsInserted(QModelIndex,int,int)));
+    disconnect(m_model, SIGNAL(columnsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
+               this, SLOT(sendDataChanged()));
     disconnect(m_model, SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
                this, SLOT(columnsMoved(QModelIndex,int,int,QModelIndex,int)));
+    disconnect(m_model, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)),
+               this, SLOT(sendDataChanged()));
     disconnect(m_model, SIGNAL(columnsRemoved(QModelIndex,int,int)),
                this, SLOT(columnsRemoved(QModelIndex,int,int)));
+    disconnect(m_model, SIGNAL(layoutAboutToBeChanged()), this, SLOT(sendDataChanged()));
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
     disconnect(m_model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
                this, SLOT(dataChanged(QModelIndex,QModelIndex)));
@@ -189,34 +248,104 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
 
     case Protocol::ModelContentRequest:
     {
+        const bool compact = payloadEncoding() == Protocol::CompactEncoding;
+        CompactPayloadReader reader(compact ? msg.rawPayload() : QByteArray());
         quint32 size;
-        msg >> size;
+        if (compact)
+            size = reader.readUInt();
+        else
+            msg >> size;
         Q_ASSERT(size > 0);
 
         QVector<QModelIndex> indexes;
         indexes.reserve(size);
         for (quint32 i = 0; i < size; ++i) {
             Protocol::ModelIndex index;
-            msg >> index;
+            if (compact)
+                index = reader.readModelIndex();
+            else
+                msg >> index;
+            if (reader.hasError())
+                break;
             const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
             if (!qmIndex.isValid())
                 continue;
+            markFetched(qmIndex);
             indexes.push_back(qmIndex);
         }
         if (indexes.isEmpty())
             break;
 
         Message msg(m_myAddress, Protocol::ModelContentReply);
-        msg << quint32(indexes.size());
-        foreach (const auto &qmIndex, indexes)
-            msg << Protocol::fromQModelIndex(qmIndex)
-                          << filterItemData(m_model->itemData(qmIndex))
-                          << qint32(m_model->flags(qmIndex));
+        if (compact) {
+            CompactPayloadWriter writer(&msg.rawPayload(), indexes.size() * 64);
+            writer.writeUInt(indexes.size());
+            foreach (const auto &qmIndex, indexes) {
+                writer.writeModelIndex(Protocol::fromQModelIndex(qmIndex));
+                writer.writeItemData(filterItemData(m_model->itemData(qmIndex)));
+                writer.writeUInt(static_cast<quint32>(m_model->flags(qmIndex)));
+            }
+        } else {
+            msg << quint32(indexes.size());
+            foreach (const auto &qmIndex, indexes)
+                msg << Protocol::fromQModelIndex(qmIndex)
+                              << filterItemData(m_model->itemData(qmIndex))
+                              << qint32(m_model->flags(qmIndex));
+        }
 
         sendMessage(msg);
         break;
     }
 
+    case Protocol::ModelAppendedContentRequest:
+    {
+        // the client knows the first knownSize elements already, send it the rest
+        quint32 size;
+        msg >> size;
+
+        QVector<Protocol::ModelIndex> indexes;
+        QVector<qint32> roles;
+        QVector<qint32> offsets;
+        QVector<QVariant> tails;
+        for (quint32 i = 0; i < size; ++i) {
+            Protocol::ModelIndex index;
+            qint32 role, knownSize;
+            msg >> index >> role >> knownSize;
+            const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
+            if (!qmIndex.isValid())
+                continue;
+            // the client's content might not be a prefix of the current value anymore, make
+            // sure it learns about that before it gets the tail of the new value
+            if (hasPendingFullChange(qmIndex))
+                sendDataChanged();
+
+            const QVariant value = m_model->data(qmIndex, role);
+            const int valueSize = ModelUtils::appendableSize(value);
+            qint32 offset = -1; // not appendable (anymore), client needs to refetch
+            QVariant tail;
+            if (valueSize >= 0 && knownSize <= valueSize) {
+                offset = knownSize;
+                tail = ModelUtils::appendableMid(value, knownSize);
+            } else if (valueSize >= 0) {
+                offset = 0; // shrunk, replace it entirely
+                tail = value;
+            }
+            indexes.push_back(index);
+            roles.push_back(role);
+            offsets.push_back(offset);
+            tails.push_back(tail);
+        }
+        if (indexes.isEmpty())
+            break;
+
+        Message reply(m_myAddress, Protocol::ModelAppendedContentReply);
+        reply << quint32(indexes.size());
+        for (int i = 0; i < indexes.size(); ++i)
+            reply << indexes.at(i) << roles.at(i) << offsets.at(i) << tails.at(i);
+        sendMessage(reply);
+        break;
+    }
+
     case Protocol::ModelHeaderRequest:
     {
         qint8 orientation;
@@ -330,6 +459,8 @@ void RemoteModelServer::modelMonitored(bool monitored)
     if (m_monitored == monitored)
         return;
     m_monitored = monitored;
+    // a client (re)starting to monitor us has nothing cached yet
+    resetChangeTracking();
     if (m_model) {
         if (m_monitored)
             connectModel();
@@ -338,14 +469,159 @@ void RemoteModelServer::modelMonitored(bool monitored)
     }
 }
 
+RemoteModelServer::FetchedRows *RemoteModelServer::fetchedRows(const QModelIndex &parent,
+                                                               bool create)
+{
+    if (!parent.isValid()) {
+        if (create || m_fetchedRootRows.first <= m_fetchedRootRows.last)
+            return &m_fetchedRootRows;
+        return nullptr;
+    }
+
+    for (auto it = m_fetchedRows.begin(); it != m_fetchedRows.end();) {
+        if (!it->parent.isValid()) { // parent got removed meanwhile
+            it = m_fetchedRows.erase(it);
+            continue;
+        }
+        if (it->parent == parent)
+            return &*it;
+        ++it;
+    }
+    if (!create)
+        return nullptr;
+
+    FetchedRows rows;
+    rows.parent = parent;
+    rows.first = 1;
+    rows.last = 0;
+    m_fetchedRows.push_back(rows);
+    return &m_fetchedRows.last();
+}
+
+void RemoteModelServer::markFetched(const QModelIndex &index)
+{
+    auto rows = fetchedRows(index.parent(), true);
+    if (rows->first > rows->last) {
+        rows->first = rows->last = index.row();
+    } else {
+        rows->first = qMin(rows->first, index.row());
+        rows->last = qMax(rows->last, index.row());
+    }
+}
+
+void RemoteModelServer::markAllFetched(const QModelIndex &parent)
+{
+    auto rows = fetchedRows(parent, true);
+    rows->first = 0;
+    rows->last = std::numeric_limits<int>::max();
+}
+
+void RemoteModelServer::resetChangeTracking()
+{
+    m_dataChangedTimer->stop();
+    m_pendingDataChanges.clear();
+    m_fetchedRows.clear();
+    m_fetchedRootRows.first = 1;
+    m_fetchedRootRows.last = 0;
+}
+
 void RemoteModelServer::dataChanged(const QModelIndex &begin, const QModelIndex &end,
                                     const QVector<int> &roles)
 {
-    if (!isConnected())
+    if (!isConnected() || !begin.isValid() || !end.isValid())
         return;
-    Message msg(m_myAddress, Protocol::ModelContentChanged);
-    msg << Protocol::fromQModelIndex(begin) << Protocol::fromQModelIndex(end) << roles;
-    sendMessage(msg);
+
+    const bool appendOnly = roles.contains(RemoteModelRole::AppendOnly);
+    const QModelIndex parent = begin.parent();
+    DataChange *change = nullptr;
+    for (auto it = m_pendingDataChanges.begin(); it != m_pendingDataChanges.end(); ++it) {
+        if (it->parent == parent) {
+            change = &*it;
+            break;
+        }
+    }
+    if (!change) {
+        DataChange newChange;
+        newChange.parent = parent;
+        newChange.allRoles = false;
+        newChange.appendOnly = appendOnly;
+        m_pendingDataChanges.push_back(newChange);
+        change = &m_pendingDataChanges.last();
+    } else if (!appendOnly) {
+        change->appendOnly = false;
+    }
+
+    mergeRange(change->ranges, QRect(QPoint(begin.column(), begin.row()),
+                                     QPoint(end.column(), end.row())));
+    if (roles.isEmpty()) {
+        change->allRoles = true;
+        change->roles.clear();
+    } else if (!change->allRoles) {
+        foreach (int role, roles) {
+            if (!change->roles.contains(role))
+                change->roles.push_back(role);
+        }
+    }
+    // a single full change among the merged ones requires a full refetch of all of them
+    if (!change->appendOnly) {
+        const int i = change->roles.indexOf(RemoteModelRole::AppendOnly);
+        if (i >= 0)
+            change->roles.remove(i);
+    }
+
+    if (!m_dataChangedTimer->isActive())
+        m_dataChangedTimer->start();
+}
+
+bool RemoteModelServer::hasPendingFullChange(const QModelIndex &index) const
+{
+    const QModelIndex parent = index.parent();
+    foreach (const auto &change, m_pendingDataChanges) {
+        if (change.parent != parent)
+            continue;
+        if (change.appendOnly)
+            return false;
+        foreach (const auto &range, change.ranges) {
+            if (range.contains(index.column(), index.row()))
+                return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+void RemoteModelServer::sendDataChanged()
+{
+    m_dataChangedTimer->stop();
+    if (m_pendingDataChanges.isEmpty())
+        return;
+
+    QVector<DataChange> changes;
+    changes.swap(m_pendingDataChanges);
+    if (!m_model || !isConnected())
+        return;
+
+    foreach (const auto &change, changes) {
+        // rows the client never asked for have nothing cached that could be outdated
+        const auto rows = fetchedRows(change.parent);
+        if (!rows)
+            continue;
+        const QVector<int> roles = change.allRoles ? QVector<int>() : change.roles;
+        foreach (const auto &range, change.ranges) {
+            const int top = qMax(range.top(), rows->first);
+            const int bottom = qMin(range.bottom(), rows->last);
+            if (top > bottom)
+                continue;
+            const auto begin = m_model->index(top, range.left(), change.parent);
+            const auto end = m_model->index(bottom, range.right(), change.parent);
+            if (!begin.isValid() || !end.isValid())
+                continue;
+
+            Message msg(m_myAddress, Protocol::ModelContentChanged);
+            msg << Protocol::fromQModelIndex(begin) << Protocol::fromQModelIndex(end) << roles;
+            sendMessage(msg);
+        }
+    }
 }
 
 void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first, int last)
@@ -359,6 +635,15 @@ void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first
 
 void RemoteModelServer::rowsInserted(const QModelIndex &parent, int start, int end)
 {
+    if (auto rows = fetchedRows(parent)) {
+        const int count = end - start + 1;
+        if (start <= rows->first) {
+            rows->first += count;
+            rows->last += count;
+        } else if (start <= rows->last) {
+            rows->last += count;
+        }
+    }
     sendAddRemoveMessage(Protocol::ModelRowsAdded, parent, start, end);
 }
 
@@ -369,6 +654,7 @@ void RemoteModelServer::rowsAboutToBeMoved(const QModelIndex &sourceParent, int
     Q_UNUSED(sourceStart);
     Q_UNUSED(sourceEnd);
     Q_UNUSED(destinationRow);
+    sendDataChanged();
     m_preOpIndexes.push_back(Protocol::fromQModelIndex(sourceParent));
     m_preOpIndexes.push_back(Protocol::fromQModelIndex(destinationParent));
 }
@@ -376,8 +662,9 @@ void RemoteModelServer::rowsAboutToBeMoved(const QModelIndex &sourceParent, int
 void RemoteModelServer::rowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd,
                                   const QModelIndex &destinationParent, int destinationRow)
 {
-    Q_UNUSED(sourceParent);
-    Q_UNUSED(destinationParent);
+    // the client moves its cached content along, so we can't tell which rows it has anymore
+    markAllFetched(sourceParent);
+    markAllFetched(destinationParent);
     Q_ASSERT(m_preOpIndexes.size() >= 2);
     const auto destParentIdx = m_preOpIndexes.takeLast();
     const auto sourceParentIdx = m_preOpIndexes.takeLast();
@@ -387,6 +674,25 @@ void RemoteModelServer::rowsMoved(const QModelIndex &sourceParent, int sourceSta
 
 void RemoteModelServer::rowsRemoved(const QModelIndex &parent, int start, int end)
 {
+    if (auto rows = fetchedRows(parent)) {
+        const int count = end - start + 1;
+        if (end < rows->first) {
+            rows->first -= count;
+            rows->last -= count;
+        } else if (start <= rows->last) {
+            // overlapping, what remains of the fetched rows moves up to start
+            rows->last = end >= rows->last ? start - 1 : rows->last - count;
+            rows->first = qMin(rows->first, start);
+            if (rows->first > rows->last) {
+                if (parent.isValid()) {
+                    m_fetchedRows.remove(rows - m_fetchedRows.data());
+                } else {
+                    rows->first = 1;
+                    rows->last = 0;
+                }
+            }
+        }
+    }
     sendAddRemoveMessage(Protocol::ModelRowsRemoved, parent, start, end);
 }
 
@@ -432,6 +738,13 @@ void RemoteModelServer::layoutChanged(const QList<QPersistentModelIndex> &parent
 void RemoteModelServer::sendLayoutChanged(const QVector< Protocol::ModelIndex > &parents,
                                           quint32 hint)
 {
+    for (auto it = m_fetchedRows.begin(); it != m_fetchedRows.end(); ++it) {
+        it->first = 0;
+        it->last = std::numeric_limits<int>::max();
+    }
+    if (m_fetchedRootRows.first <= m_fetchedRootRows.last)
+        markAllFetched(QModelIndex());
+
     if (!isConnected())
         return;
     Message msg(m_myAddress, Protocol::ModelLayoutChanged);
@@ -441,6 +754,7 @@ void RemoteModelServer::sendLayoutChanged(const QVector< Protocol::ModelIndex >
 
 void RemoteModelServer::modelReset()
 {
+    resetChangeTracking();
     if (!isConnected())
         return;
     sendMessage(Message(m_myAddress, Protocol::ModelReset));
@@ -473,6 +787,7 @@ void RemoteModelServer::sendMoveMessage(Protocol::MessageType type,
 void RemoteModelServer::modelDeleted()
 {
     m_model = nullptr;
+    resetChangeTracking();
     if (m_monitored)
         modelReset();
 }
@@ -499,6 +814,11 @@ void RemoteModelServer::sendMessage(const Message &msg) const
     Endpoint::send(msg);
 }
 
+Protocol::PayloadEncoding RemoteModelServer::payloadEncoding() const
+{
+    return Endpoint::payloadEncoding();
+}
+
 bool RemoteModelServer::proxyDynamicSortFilter() const
 {
     if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
@@ -32,11 +32,15 @@
 #include <common/protocol.h>
 
 #include <QObject>
+#include <QPersistentModelIndex>
 #include <QPointer>
+#include <QRect>
 #include <QRegExp>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QBuffer;
+class QTimer;
 class QAbstractItemModel;
 QT_END_NAMESPACE
 
@@ -87,6 +91,28 @@ private:
         quint32 hint = 0);
     bool canSerialize(const QVariant &value) const;
 
+    /** Pending dataChanged ranges below one parent, columns as x and rows as y. */
+    struct DataChange {
+        QPersistentModelIndex parent;
+        QVector<QRect> ranges;
+        QVector<int> roles;
+        bool allRoles;
+        // all merged changes were flagged with RemoteModelRole::AppendOnly
+        bool appendOnly;
+    };
+    /** Rows below @p parent the client has requested content for. */
+    struct FetchedRows {
+        QPersistentModelIndex parent;
+        int first;
+        int last;
+    };
+    FetchedRows *fetchedRows(const QModelIndex &parent, bool create = false);
+    void markFetched(const QModelIndex &index);
+    void markAllFetched(const QModelIndex &parent);
+    void resetChangeTracking();
+    /// @c true if a not yet sent dataChanged() for @p index isn't limited to appended elements
+    bool hasPendingFullChange(const QModelIndex &index) const;
+
     // proxy model settings
     bool proxyDynamicSortFilter() const;
     void setProxyDynamicSortFilter(bool dynamicSortFilter);
@@ -102,9 +128,11 @@ private:
     void registerServer();
     virtual bool isConnected() const;
     virtual void sendMessage(const Message &msg) const;
+    virtual Protocol::PayloadEncoding payloadEncoding() const;
     friend class FakeRemoteModelServer;
 
 private slots:
+    void sendDataChanged();
     void dataChanged(const QModelIndex &begin, const QModelIndex &end,
                      const QVector<int> &roles = QVector<int>());
     void headerDataChanged(Qt::Orientation orientation, int first, int last);
@@ -139,6 +167,11 @@ private:
     // the serialized index (move to sub-tree of source parent for example)
     // as operations can occur nested, we need to have a stack for this
     QList<Protocol::ModelIndex> m_preOpIndexes;
+    // dataChanged signals are merged and sent out with a slight delay, see sendDataChanged()
+    QVector<DataChange> m_pendingDataChanges;
+    QTimer *m_dataChangedTimer;
+    QVector<FetchedRows> m_fetchedRows;
+    FetchedRows m_fetchedRootRows;
     Protocol::ObjectAddress m_myAddress;
     bool m_monitored;
 };
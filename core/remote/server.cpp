@@ -155,7 +155,7 @@ void Server::sendServerGreeting()
     // send greeting message for protocol version check
     {
         Message msg(endpointAddress(), Protocol::ServerVersion);
-        msg << Protocol::version();
+        msg << Protocol::version() << Protocol::supportedPayloadEncodings();
         send(msg);
     }
 
@@ -194,6 +194,14 @@ void Server::messageReceived(const Message &msg)
                                       Q_ARG(bool, msg.type() == Protocol::ObjectMonitored));
             break;
         }
+        case Protocol::PayloadEncodingSelected:
+        {
+            quint8 encoding;
+            msg >> encoding;
+            if (encoding < 8 && (Protocol::supportedPayloadEncodings() & (1 << encoding)))
+                setPayloadEncoding(static_cast<Protocol::PayloadEncoding>(encoding));
+            break;
+        }
         }
     } else {
         dispatchMessage(msg);
@@ -30,6 +30,8 @@
 
 #include <core/remote/server.h>
 
+#include <common/remoteviewframe.h>
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QMouseEvent>
@@ -41,19 +43,31 @@
 
 using namespace GammaRay;
 
+// bounds for the delay between a source change and grabbing it, ~60 fps at most
+static const int MinUpdateInterval = 16;
+static const int MaxUpdateInterval = 500;
+
+// a region covering everything, for changes we don't know the extent of
+static QRegion everything()
+{
+    static const int extent = 1 << 24;
+    return QRegion(-extent, -extent, 2 * extent, 2 * extent);
+}
+
 RemoteViewServer::RemoteViewServer(const QString &name, QObject *parent)
     : RemoteViewInterface(name, parent)
     , m_eventReceiver(nullptr)
     , m_updateTimer(new QTimer(this))
+    , m_grabDuration(0)
     , m_clientActive(false)
-    , m_sourceChanged(false)
     , m_clientReady(true)
+    , m_inlineFrames(false)
 {
     Server::instance()->registerMonitorNotifier(Endpoint::instance()->objectAddress(
                                                     name), this, "clientConnectedChanged");
 
     m_updateTimer->setSingleShot(true);
-    m_updateTimer->setInterval(100);
+    m_updateTimer->setInterval(MinUpdateInterval);
     connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(requestUpdateTimeout()));
 }
 
@@ -74,6 +88,7 @@ void RemoteViewServer::pickElementId(const GammaRay::ObjectId &id)
 
 void RemoteViewServer::resetView()
 {
+    m_imageEncoder.reset();
     if (isActive())
         emit reset();
 }
@@ -85,26 +100,112 @@ bool RemoteViewServer::isActive() const
 
 void RemoteViewServer::sendFrame(const RemoteViewFrame &frame)
 {
+    if (m_grabTimer.isValid()) {
+        m_grabDuration = static_cast<int>((3 * m_grabDuration + m_grabTimer.elapsed()) / 4);
+        m_grabTimer.invalidate();
+    }
+
     m_clientReady = false;
-    emit frameUpdated(frame);
+    if (!Endpoint::isConnected()) { // in-process UI, nothing to encode
+        emit frameUpdated(frame);
+        return;
+    }
+
+    // only send what the client actually shows, at the resolution it shows it
+    RemoteViewFrame deltaFrame(frame);
+    deltaFrame.reduceImage(m_viewportRect, m_viewportSize);
+    if (canUseSharedMemory() && deltaFrame.encodeImageSharedMemory(&m_sharedMemoryEncoder)) {
+        // the next delta can't be based on an image the delta encoder hasn't seen
+        m_imageEncoder.reset();
+    } else {
+        // the client acknowledged the previous frame before we got here, so it can apply a delta
+        deltaFrame.encodeImageDelta(&m_imageEncoder);
+    }
+    emit frameUpdated(deltaFrame);
+}
+
+QRectF RemoteViewServer::clientViewportRect() const
+{
+    return m_viewportRect;
+}
+
+QSize RemoteViewServer::clientViewportSize() const
+{
+    return m_viewportSize;
+}
+
+QRegion RemoteViewServer::dirtyRegion() const
+{
+    return m_dirtyRegion;
 }
 
 void RemoteViewServer::sourceChanged()
 {
-    m_sourceChanged = true;
+    m_dirtyRegion = everything();
+    checkRequestUpdate();
+}
+
+void RemoteViewServer::addDirtyRegion(const QRegion &region)
+{
+    if (!isActive() || region.isEmpty())
+        return;
+    m_dirtyRegion += region;
+    // changes outside of the visible area don't trigger an update (see isDirty()), and are
+    // dropped with the next grab, changing the viewport requests a complete frame anyway
+    if (m_dirtyRegion.rectCount() > 64)
+        m_dirtyRegion = m_dirtyRegion.boundingRect();
     checkRequestUpdate();
 }
 
+bool RemoteViewServer::isDirty() const
+{
+    if (m_viewportRect.isValid())
+        return m_dirtyRegion.intersects(m_viewportRect.toAlignedRect());
+    return !m_dirtyRegion.isEmpty();
+}
+
 void RemoteViewServer::clientViewUpdated()
 {
     m_clientReady = true;
     checkRequestUpdate();
 }
 
+void RemoteViewServer::requestCompleteFrame()
+{
+    m_imageEncoder.reset();
+    sourceChanged();
+}
+
+void RemoteViewServer::requestInlineFrames()
+{
+    m_inlineFrames = true;
+    sourceChanged();
+}
+
+bool RemoteViewServer::canUseSharedMemory() const
+{
+    // a local socket implies the client runs on the same host, which doesn't mean it
+    // can access our shared memory, the client tells us if that's not the case
+    return !m_inlineFrames && Server::instance()->serverAddress().scheme() == QLatin1String("local");
+}
+
+void RemoteViewServer::setViewport(const QRectF &rect, const QSize &size)
+{
+    if (m_viewportRect == rect && m_viewportSize == size)
+        return;
+    m_viewportRect = rect;
+    m_viewportSize = size;
+    sourceChanged();
+}
+
 void RemoteViewServer::checkRequestUpdate()
 {
-    if (isActive() && !m_updateTimer->isActive() && m_clientReady && m_sourceChanged)
-        m_updateTimer->start();
+    if (!isActive() || m_updateTimer->isActive() || !m_clientReady || !isDirty())
+        return;
+
+    // the client acknowledging frames bounds the frame rate already, additionally keep
+    // sources that are expensive to grab from spending more than half their time on that
+    m_updateTimer->start(qBound(MinUpdateInterval, m_grabDuration, MaxUpdateInterval));
 }
 
 void RemoteViewServer::sendKeyEvent(int type, int key, int modifiers, const QString &text,
@@ -182,6 +283,7 @@ void RemoteViewServer::setViewActive(bool active)
 {
     m_clientActive = active;
     m_clientReady = active;
+    m_imageEncoder.reset();
     if (active)
         sourceChanged();
     else
@@ -190,12 +292,15 @@ void RemoteViewServer::setViewActive(bool active)
 
 void RemoteViewServer::clientConnectedChanged(bool connected)
 {
-    if (!connected)
+    if (!connected) {
         setViewActive(false);
+        m_inlineFrames = false;
+    }
 }
 
 void RemoteViewServer::requestUpdateTimeout()
 {
+    m_grabTimer.start();
     emit requestUpdate();
-    m_sourceChanged = false;
+    m_dirtyRegion = QRegion();
 }
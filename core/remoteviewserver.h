@@ -34,6 +34,10 @@
 #include "gammaray_core_export.h"
 
 #include <common/remoteviewinterface.h>
+#include <common/transferimage.h>
+
+#include <QElapsedTimer>
+#include <QRegion>
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -67,9 +71,20 @@ public:
     /// sends a new frame to the client
     void sendFrame(const RemoteViewFrame &frame);
 
+    /// the part of the source visible on the client, in view coordinates, invalid if unknown
+    QRectF clientViewportRect() const;
+    /// device pixels used by the client for showing clientViewportRect()
+    QSize clientViewportSize() const;
+
+    /// the part of the source that changed since the last requestUpdate(), in view coordinates
+    QRegion dirtyRegion() const;
+
 public slots:
     /// call this to indicate the source has changed and the client requires an update
     void sourceChanged();
+    /// call this to indicate @p region (in view coordinates) of the source has changed,
+    /// the client is only updated if that is visible there
+    void addDirtyRegion(const QRegion &region);
 
 signals:
     void elementsAtRequested(const QPoint &pos, GammaRay::RemoteViewInterface::RequestMode mode);
@@ -91,8 +106,13 @@ private:
                         Q_DECL_OVERRIDE;
     void setViewActive(bool active) Q_DECL_OVERRIDE;
     void clientViewUpdated() Q_DECL_OVERRIDE;
+    void requestCompleteFrame() Q_DECL_OVERRIDE;
+    void setViewport(const QRectF &rect, const QSize &size) Q_DECL_OVERRIDE;
+    void requestInlineFrames() Q_DECL_OVERRIDE;
 
     void checkRequestUpdate();
+    bool isDirty() const;
+    bool canUseSharedMemory() const;
 
 private slots:
     void clientConnectedChanged(bool connected);
@@ -101,9 +121,17 @@ private slots:
 private:
     EventReceiver *m_eventReceiver;
     QTimer *m_updateTimer;
+    TransferImageDeltaEncoder m_imageEncoder;
+    TransferImageSharedMemoryEncoder m_sharedMemoryEncoder;
+    QRectF m_viewportRect;
+    QSize m_viewportSize;
+    QRegion m_dirtyRegion;
+    // time from requestUpdate() to sendFrame(), averaged, to throttle expensive sources
+    QElapsedTimer m_grabTimer;
+    int m_grabDuration;
     bool m_clientActive;
-    bool m_sourceChanged;
     bool m_clientReady;
+    bool m_inlineFrames; // client can't access our shared memory
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     std::unique_ptr<QTouchDevice> m_touchDevice;
 #endif
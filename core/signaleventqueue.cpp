@@ -0,0 +1,295 @@
+/*
+  signaleventqueue.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "signaleventqueue.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QThreadStorage>
+#include <QTimer>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace GammaRay;
+
+// needs to be a power of two
+static const int RingCapacity = 8192;
+// [ms]
+static const int DrainInterval = 10;
+
+static inline int atomicLoad(QAtomicInt &value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    return value.loadAcquire();
+#else
+    return value.fetchAndAddAcquire(0);
+#endif
+}
+
+static inline void atomicStore(QAtomicInt &value, int newValue)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    value.storeRelease(newValue);
+#else
+    value.fetchAndStoreRelease(newValue);
+#endif
+}
+
+namespace GammaRay {
+struct SignalEventRing
+{
+    SignalEventRing()
+        : threadId(QThread::currentThreadId())
+        , orphaned(false)
+    {
+    }
+
+    SignalEvent events[RingCapacity];
+    QAtomicInt head; // only written by the producing thread
+    QAtomicInt tail; // only written by the draining thread
+    QAtomicInt dropped;
+    Qt::HANDLE threadId;
+    bool orphaned; // the producing thread is gone, protected by s_ringLock
+};
+}
+
+struct PendingEmission
+{
+    QObject *sender;
+    int methodIndex;
+    bool filtered;
+};
+
+Q_DECLARE_TYPEINFO(PendingEmission, Q_PRIMITIVE_TYPE);
+
+struct ThreadSignalState
+{
+    ThreadSignalState()
+        : ring(nullptr)
+        , generation(-1)
+    {
+    }
+
+    ~ThreadSignalState();
+
+    SignalEventRing *ring;
+    int generation; // the queue instance ring belongs to
+    // emissions currently in progress in this thread, to match up begin and end
+    QVector<PendingEmission> emissions;
+};
+
+Q_GLOBAL_STATIC(QMutex, s_ringLock)
+static QThreadStorage<ThreadSignalState *> s_threadStates;
+static SignalEventQueue *s_queue = nullptr;
+static int s_generation = 0;
+
+ThreadSignalState::~ThreadSignalState()
+{
+    // the ring is owned by the queue, which still needs to drain it
+    QMutexLocker lock(s_ringLock());
+    if (ring && s_queue && generation == s_generation)
+        ring->orphaned = true;
+}
+
+static ThreadSignalState *threadState()
+{
+    if (!s_threadStates.hasLocalData())
+        s_threadStates.setLocalData(new ThreadSignalState);
+    return s_threadStates.localData();
+}
+
+SignalEventQueue::SignalEventQueue(QObject *parent)
+    : QObject(parent)
+    , m_drainTimer(new QTimer(this))
+    , m_drainScheduled(0)
+    , m_enabled(0)
+    , m_generation(0)
+    , m_overflowReported(false)
+{
+    m_drainTimer->setSingleShot(true);
+    m_drainTimer->setInterval(DrainInterval);
+    connect(m_drainTimer, SIGNAL(timeout()), this, SLOT(drain()));
+
+    QMutexLocker lock(s_ringLock());
+    Q_ASSERT(!s_queue);
+    m_generation = ++s_generation;
+    s_queue = this;
+}
+
+SignalEventQueue::~SignalEventQueue()
+{
+    QMutexLocker lock(s_ringLock());
+    if (s_queue == this)
+        s_queue = nullptr;
+    qDeleteAll(m_rings);
+}
+
+void SignalEventQueue::setEnabled(bool enabled)
+{
+    atomicStore(m_enabled, enabled ? 1 : 0);
+}
+
+SignalEventQueue *SignalEventQueue::activeInstance()
+{
+    SignalEventQueue *queue = s_queue;
+    if (!queue || !atomicLoad(queue->m_enabled))
+        return nullptr;
+    return queue;
+}
+
+SignalEventRing *SignalEventQueue::ringForCurrentThread()
+{
+    ThreadSignalState *state = threadState();
+    if (state->generation != m_generation) {
+        // first emission in this thread, or the previous ring belonged to an earlier probe instance
+        state->ring = new SignalEventRing;
+        state->generation = m_generation;
+        QMutexLocker lock(s_ringLock());
+        m_rings.push_back(state->ring);
+    }
+    return state->ring;
+}
+
+void SignalEventQueue::recordBegin(QObject *sender, const QMetaObject *metaObject,
+                                   int methodIndex, bool filtered)
+{
+    SignalEventQueue *queue = activeInstance();
+    if (!queue)
+        return;
+
+    const PendingEmission emission = { sender, methodIndex, filtered };
+    threadState()->emissions.push_back(emission);
+    if (!filtered)
+        queue->push(queue->ringForCurrentThread(), sender, metaObject, methodIndex,
+                    SignalEvent::Begin);
+}
+
+void SignalEventQueue::recordEnd(QObject *sender)
+{
+    SignalEventQueue *queue = activeInstance();
+    if (!queue || !s_threadStates.hasLocalData())
+        return;
+
+    // this is unbalanced if we got enabled in the middle of an emission
+    QVector<PendingEmission> &emissions = s_threadStates.localData()->emissions;
+    if (emissions.isEmpty() || emissions.last().sender != sender)
+        return;
+
+    const PendingEmission emission = emissions.last();
+    emissions.pop_back();
+    if (!emission.filtered)
+        queue->push(queue->ringForCurrentThread(), sender, nullptr, emission.methodIndex,
+                    SignalEvent::End);
+}
+
+void SignalEventQueue::push(SignalEventRing *ring, QObject *sender,
+                            const QMetaObject *metaObject, int methodIndex,
+                            SignalEvent::Type type)
+{
+    const uint head = atomicLoad(ring->head);
+    const uint tail = atomicLoad(ring->tail);
+    if (head - tail >= static_cast<uint>(RingCapacity)) {
+        ring->dropped.ref();
+        return;
+    }
+
+    SignalEvent &event = ring->events[head & (RingCapacity - 1)];
+    event.sender = sender;
+    event.metaObject = metaObject;
+    event.methodIndex = methodIndex;
+    event.type = type;
+    event.timestamp = SignalEvent::currentTimestamp();
+    event.threadId = ring->threadId;
+    atomicStore(ring->head, head + 1);
+
+    if (m_drainScheduled.testAndSetOrdered(0, 1))
+        scheduleDrain();
+}
+
+void SignalEventQueue::scheduleDrain()
+{
+    if (thread() == QThread::currentThread())
+        m_drainTimer->start();
+    else
+        QMetaObject::invokeMethod(m_drainTimer, "start", Qt::QueuedConnection);
+}
+
+static bool signalEventLessThan(const SignalEvent &lhs, const SignalEvent &rhs)
+{
+    return lhs.timestamp < rhs.timestamp;
+}
+
+void SignalEventQueue::drain()
+{
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    // reset first, so anything pushed from now on re-schedules us
+    m_drainScheduled.fetchAndStoreOrdered(0);
+
+    QVector<SignalEvent> events;
+    int sourceRings = 0;
+    int dropped = 0;
+    {
+        QMutexLocker lock(s_ringLock());
+        for (auto it = m_rings.begin(); it != m_rings.end();) {
+            SignalEventRing *ring = *it;
+            const uint tail = atomicLoad(ring->tail);
+            const uint head = atomicLoad(ring->head);
+            if (head != tail) {
+                ++sourceRings;
+                events.reserve(events.size() + (head - tail));
+                for (uint i = tail; i != head; ++i)
+                    events.push_back(ring->events[i & (RingCapacity - 1)]);
+                atomicStore(ring->tail, head);
+            }
+            dropped += ring->dropped.fetchAndStoreRelaxed(0);
+
+            if (ring->orphaned) {
+                delete ring;
+                it = m_rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (dropped > 0 && !m_overflowReported) {
+        std::cerr << "Signal event buffer overflow, dropped " << dropped
+                  << " signal emission records." << std::endl;
+        m_overflowReported = true;
+    }
+
+    if (events.isEmpty())
+        return;
+
+    // each ring is ordered already, but consumers expect a consistent timeline across threads
+    if (sourceRings > 1)
+        std::stable_sort(events.begin(), events.end(), signalEventLessThan);
+
+    emit eventsAvailable(events);
+}
@@ -0,0 +1,96 @@
+/*
+  signaleventqueue.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SIGNALEVENTQUEUE_H
+#define GAMMARAY_SIGNALEVENTQUEUE_H
+
+#include "signalspycallbackset.h"
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+struct SignalEventRing;
+
+/**
+ * Collects signal emission records from the signal spy hooks.
+ *
+ * Each emitting thread writes into its own fixed-size single-producer ring buffer
+ * without taking any locks, the probe thread drains all rings periodically and
+ * hands the records out in one batch. If a ring overflows before it gets drained
+ * the surplus records are dropped.
+ */
+class SignalEventQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SignalEventQueue(QObject *parent = nullptr);
+    ~SignalEventQueue();
+
+    /** Only record events while there are consumers for them. */
+    void setEnabled(bool enabled);
+
+    /**
+     * Record the start of a signal emission, arbitrary thread.
+     * Filtered emissions are not recorded, but are needed for matching up with recordEnd().
+     */
+    static void recordBegin(QObject *sender, const QMetaObject *metaObject, int methodIndex,
+                            bool filtered);
+    /**
+     * Record the end of the last signal emission of @p sender, arbitrary thread.
+     * Does not dereference @p sender, so it's safe to call this if @p sender got deleted meanwhile.
+     */
+    static void recordEnd(QObject *sender);
+
+signals:
+    void eventsAvailable(const QVector<GammaRay::SignalEvent> &events);
+
+public slots:
+    void drain();
+
+private:
+    static SignalEventQueue *activeInstance();
+    SignalEventRing *ringForCurrentThread();
+    void push(SignalEventRing *ring, QObject *sender, const QMetaObject *metaObject,
+              int methodIndex, SignalEvent::Type type);
+    void scheduleDrain();
+
+    QVector<SignalEventRing *> m_rings; // protected by s_ringLock
+    QTimer *m_drainTimer;
+    QAtomicInt m_drainScheduled;
+    QAtomicInt m_enabled;
+    int m_generation;
+    bool m_overflowReported;
+};
+}
+
+#endif // GAMMARAY_SIGNALEVENTQUEUE_H
@@ -0,0 +1,167 @@
+/*
+  signalindexcache.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config-gammaray.h>
+
+#include "signalindexcache.h"
+#include "util.h"
+
+#include <QAtomicPointer>
+#include <QMetaMethod>
+#include <QMetaObject>
+#include <QVector>
+
+#ifdef HAVE_PRIVATE_QT_HEADERS
+#include <private/qobject_p.h>
+#endif
+
+using namespace GammaRay;
+
+struct SignalTable
+{
+    const QMetaObject *metaObject;
+    const uint *data; // detects a different class at the same address, after plugin unloading
+    QVector<int> methodIndexes; // by signal index
+    QVector<QByteArray> signatures; // by method index, empty for non-signals
+};
+
+// fixed size open addressing hash, slots are only ever set once
+struct SignalTables
+{
+    enum {
+        Capacity = 4096, // power of two
+        MaxProbes = 32
+    };
+
+    ~SignalTables()
+    {
+        for (int i = 0; i < Capacity; ++i)
+            delete static_cast<SignalTable *>(tables[i]);
+    }
+
+    QAtomicPointer<SignalTable> tables[Capacity];
+};
+
+Q_GLOBAL_STATIC(SignalTables, s_signalTables)
+
+static inline SignalTable *atomicLoad(QAtomicPointer<SignalTable> &value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    return value.loadAcquire();
+#else
+    return value.fetchAndAddAcquire(0);
+#endif
+}
+
+static QByteArray methodSignature(const QMetaMethod &method)
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    return method.signature();
+#else
+    return method.methodSignature();
+#endif
+}
+
+static SignalTable *createTable(const QMetaObject *metaObject)
+{
+    SignalTable *table = new SignalTable;
+    table->metaObject = metaObject;
+    table->data = metaObject->d.data;
+    table->signatures.resize(metaObject->methodCount());
+    // signal indexes are assigned in method order, base classes first
+    for (int i = 0; i < metaObject->methodCount(); ++i) {
+        const QMetaMethod method = metaObject->method(i);
+        if (method.methodType() != QMetaMethod::Signal)
+            continue;
+        table->methodIndexes.push_back(i);
+        table->signatures[i] = methodSignature(method);
+    }
+    return table;
+}
+
+static const SignalTable *tableForMetaObject(const QMetaObject *metaObject)
+{
+    SignalTables *tables = s_signalTables();
+    if (!tables) // during shutdown
+        return nullptr;
+
+    const quintptr hash = reinterpret_cast<quintptr>(metaObject) >> 4;
+    SignalTable *newTable = nullptr;
+    for (int i = 0; i < SignalTables::MaxProbes; ++i) {
+        QAtomicPointer<SignalTable> &slot = tables->tables[(hash + i) & (SignalTables::Capacity - 1)];
+        SignalTable *table = atomicLoad(slot);
+        if (!table) {
+            if (!newTable)
+                newTable = createTable(metaObject);
+            if (slot.testAndSetOrdered(nullptr, newTable))
+                return newTable;
+            table = atomicLoad(slot); // lost against another thread
+        }
+        if (table->metaObject == metaObject) {
+            delete newTable;
+            return table->data == metaObject->d.data ? table : nullptr;
+        }
+    }
+
+    // too many classes, take the slow path
+    delete newTable;
+    return nullptr;
+}
+
+const QMetaObject *SignalIndexCache::cacheableMetaObject(QObject *obj)
+{
+#ifdef HAVE_PRIVATE_QT_HEADERS
+    if (QObjectPrivate::get(obj)->metaObject)
+        return nullptr;
+    return obj->metaObject();
+#else
+    Q_UNUSED(obj);
+    return nullptr;
+#endif
+}
+
+int SignalIndexCache::methodIndex(const QMetaObject *metaObject, int signalIndex)
+{
+    if (signalIndex < 0)
+        return signalIndex;
+
+    const SignalTable *table = tableForMetaObject(metaObject);
+    if (!table || signalIndex >= table->methodIndexes.size())
+        return Util::signalIndexToMethodIndex(metaObject, signalIndex);
+    return table->methodIndexes.at(signalIndex);
+}
+
+QByteArray SignalIndexCache::signalSignature(const QMetaObject *metaObject, int methodIndex)
+{
+    if (methodIndex < 0 || methodIndex >= metaObject->methodCount())
+        return QByteArray();
+
+    const SignalTable *table = tableForMetaObject(metaObject);
+    if (!table)
+        return methodSignature(metaObject->method(methodIndex));
+    return table->signatures.at(methodIndex);
+}
@@ -0,0 +1,73 @@
+/*
+  signalindexcache.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SIGNALINDEXCACHE_H
+#define GAMMARAY_SIGNALINDEXCACHE_H
+
+#include "gammaray_core_export.h"
+
+#include <QByteArray>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+struct QMetaObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/**
+ * Lock-free per-class lookup tables for the signal information needed on the signal spy hot path.
+ *
+ * Tables are built lazily the first time a class emits a signal and are never discarded,
+ * therefore only static meta objects are cached. All methods are safe to call from any thread.
+ */
+class GAMMARAY_CORE_EXPORT SignalIndexCache
+{
+public:
+    /**
+     * Returns the meta object of @p obj if it is a static one, nullptr for dynamic meta objects
+     * such as the ones of QML objects. Unlike @p obj, the result stays valid after @p obj got deleted.
+     */
+    static const QMetaObject *cacheableMetaObject(QObject *obj);
+
+    /**
+     * Maps the signal index passed to the Qt5 signal spy callbacks to a method index.
+     * @p metaObject must have been obtained from cacheableMetaObject().
+     */
+    static int methodIndex(const QMetaObject *metaObject, int signalIndex);
+
+    /**
+     * Returns the signature of the signal with method index @p methodIndex.
+     * @p metaObject must have been obtained from cacheableMetaObject().
+     */
+    static QByteArray signalSignature(const QMetaObject *metaObject, int methodIndex);
+
+private:
+    SignalIndexCache();
+};
+}
+
+#endif // GAMMARAY_SIGNALINDEXCACHE_H
@@ -28,18 +28,38 @@
 
 #include "signalspycallbackset.h"
 
+#include <QElapsedTimer>
+
 using namespace GammaRay;
 
+struct MonotonicClock
+{
+    MonotonicClock()
+    {
+        timer.start();
+    }
+
+    QElapsedTimer timer;
+};
+
+Q_GLOBAL_STATIC(MonotonicClock, s_clock)
+
+qint64 SignalEvent::currentTimestamp()
+{
+    return s_clock()->timer.nsecsElapsed();
+}
+
 SignalSpyCallbackSet::SignalSpyCallbackSet()
     : signalBeginCallback(nullptr)
     , signalEndCallback(nullptr)
     , slotBeginCallback(nullptr)
     , slotEndCallback(nullptr)
+    , signalEventCallback(nullptr)
 {
 }
 
 bool SignalSpyCallbackSet::isNull() const
 {
     return signalBeginCallback == nullptr && signalEndCallback == nullptr && slotBeginCallback == nullptr
-           && slotEndCallback == nullptr;
+           && slotEndCallback == nullptr && signalEventCallback == nullptr;
 }
@@ -32,12 +32,46 @@
 #include "gammaray_core_export.h"
 
 #include <qglobal.h>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QObject;
+struct QMetaObject;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+/** @brief A single signal emission record.
+ *
+ *  These are recorded by the probe in the emitting thread and delivered
+ *  in batches to SignalSpyCallbackSet::signalEventCallback in the probe thread.
+ *
+ *  @since 2.7
+ */
+struct GAMMARAY_CORE_EXPORT SignalEvent
+{
+    enum Type {
+        Begin,
+        End
+    };
+
+    /** The emitting object. Never dereference this without checking Probe::isValidObject() first! */
+    QObject *sender;
+    /** The meta object of the sender for Begin events, unless that is a dynamic one.
+     *  Unlike @c sender this is safe to access, see SignalIndexCache::signalSignature().
+     */
+    const QMetaObject *metaObject;
+    /** The method index of the emitted signal. */
+    int methodIndex;
+    Type type;
+    /** Monotonic timestamp in nanoseconds, see currentTimestamp(). */
+    qint64 timestamp;
+    /** The thread the signal has been emitted in. */
+    Qt::HANDLE threadId;
+
+    /** Returns the current time of the monotonic clock used for @c timestamp. */
+    static qint64 currentTimestamp();
+};
+
 /** @brief Callbacks for tracing signal emissions and slot invocation.
  *
  *  @since 2.3
@@ -49,12 +83,22 @@ struct GAMMARAY_CORE_EXPORT SignalSpyCallbackSet
 
     typedef void (*BeginCallback)(QObject *caller, int methodIndex, void **argv);
     typedef void (*EndCallback)(QObject *caller, int methodIndex);
+    /** Unlike the other callbacks, this is not called synchronously from the emitting thread,
+     *  but from the probe thread with all signal emissions recorded since the last call.
+     *  Prefer this if you don't need access to the signal arguments, it is a lot cheaper
+     *  for the inspected application.
+     *  @since 2.7
+     */
+    typedef void (*EventCallback)(const QVector<SignalEvent> &events);
 
     BeginCallback signalBeginCallback;
     EndCallback signalEndCallback;
     BeginCallback slotBeginCallback;
     EndCallback slotEndCallback;
+    EventCallback signalEventCallback;
 };
 }
 
+Q_DECLARE_TYPEINFO(GammaRay::SignalEvent, Q_PRIMITIVE_TYPE);
+
 #endif
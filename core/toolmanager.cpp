@@ -37,6 +37,7 @@
 #include "tools/localeinspector/localeinspector.h"
 #include "tools/metatypebrowser/metatypebrowser.h"
 #include "tools/objectinspector/objectinspector.h"
+#include "tools/objectsnapshot/objectsnapshot.h"
 #include "tools/resourcebrowser/resourcebrowser.h"
 #include "tools/messagehandler/messagehandler.h"
 #include "tools/metaobjectbrowser/metaobjectbrowser.h"
@@ -62,6 +63,7 @@ ToolManager::ToolManager(QObject *parent)
     addToolFactory(new MetaTypeBrowserFactory(this));
     addToolFactory(new MessageHandlerFactory(this));
     addToolFactory(new LocaleInspectorFactory(this));
+    addToolFactory(new ObjectSnapshotFactory(this));
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     addToolFactory(new StandardPathsFactory(this));
 #endif
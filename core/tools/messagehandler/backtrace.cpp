@@ -0,0 +1,155 @@
+/*
+  backtrace.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "backtrace.h"
+
+#include <QDataStream>
+#include <QHash>
+#include <QMutex>
+
+// upper bound for the number of distinct call stacks we keep for sharing
+static const int MaxSharedBacktraces = 4096;
+// upper bound for the number of symbolized return addresses we keep
+static const int MaxCachedSymbols = 16384;
+
+// protects the two caches below, backtraces are captured from any thread
+static QMutex s_mutex;
+static QHash<uint, QVector<quintptr> > s_backtraces;
+static QHash<quintptr, QString> s_symbols;
+
+static uint hashAddresses(const QVector<quintptr> &addresses)
+{
+    uint hash = 0;
+    foreach (quintptr address, addresses)
+        hash = 31 * hash + qHash(address);
+    return hash;
+}
+
+Backtrace::Backtrace()
+{
+}
+
+Backtrace::Backtrace(const QVector<quintptr> &addresses)
+{
+    const uint hash = hashAddresses(addresses);
+    QMutexLocker lock(&s_mutex);
+    const auto it = s_backtraces.constFind(hash);
+    if (it != s_backtraces.constEnd() && it.value() == addresses) {
+        m_addresses = it.value();
+        return;
+    }
+
+    if (s_backtraces.size() >= MaxSharedBacktraces)
+        s_backtraces.clear();
+    s_backtraces.insert(hash, addresses);
+    m_addresses = addresses;
+}
+
+Backtrace::Backtrace(const QStringList &frames)
+    : m_frames(frames)
+{
+}
+
+bool Backtrace::isEmpty() const
+{
+    return m_addresses.isEmpty() && m_frames.isEmpty();
+}
+
+int Backtrace::size() const
+{
+    return m_addresses.isEmpty() ? m_frames.size() : m_addresses.size();
+}
+
+QStringList Backtrace::frames() const
+{
+    if (m_addresses.isEmpty())
+        return m_frames;
+
+    // symbols of this backtrace, the shared cache might get cleared in between
+    QHash<quintptr, QString> symbols;
+    QVector<quintptr> unknownAddresses;
+    {
+        QMutexLocker lock(&s_mutex);
+        foreach (quintptr address, m_addresses) {
+            if (symbols.contains(address) || unknownAddresses.contains(address))
+                continue;
+            const auto it = s_symbols.constFind(address);
+            if (it != s_symbols.constEnd())
+                symbols.insert(address, it.value());
+            else
+                unknownAddresses.push_back(address);
+        }
+    }
+
+    if (!unknownAddresses.isEmpty()) {
+        // symbolize outside of the lock, this is slow
+        const QStringList resolved = symbolizeBacktrace(unknownAddresses);
+
+        QMutexLocker lock(&s_mutex);
+        if (s_symbols.size() + unknownAddresses.size() > MaxCachedSymbols)
+            s_symbols.clear();
+        for (int i = 0; i < unknownAddresses.size(); ++i) {
+            const QString symbol = i < resolved.size() ? resolved.at(i) : QString();
+            s_symbols.insert(unknownAddresses.at(i), symbol);
+            symbols.insert(unknownAddresses.at(i), symbol);
+        }
+    }
+
+    QStringList frames;
+    frames.reserve(m_addresses.size());
+    foreach (quintptr address, m_addresses)
+        frames.push_back(symbols.value(address));
+    return frames;
+}
+
+QDataStream &operator<<(QDataStream &stream, const Backtrace &backtrace)
+{
+    stream << static_cast<quint32>(backtrace.m_addresses.size());
+    foreach (quintptr address, backtrace.m_addresses)
+        stream << static_cast<quint64>(address);
+    stream << backtrace.m_frames;
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, Backtrace &backtrace)
+{
+    quint32 size;
+    stream >> size;
+    QVector<quintptr> addresses;
+    addresses.reserve(size);
+    for (quint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i) {
+        quint64 address;
+        stream >> address;
+        addresses.push_back(static_cast<quintptr>(address));
+    }
+
+    QStringList frames;
+    stream >> frames;
+    backtrace = addresses.isEmpty() ? Backtrace(frames) : Backtrace(addresses);
+    return stream;
+}
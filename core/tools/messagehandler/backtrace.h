@@ -31,9 +31,47 @@
 #define GAMMARAY_MESSAGEHANDLER_BACKTRACE_H
 
 #include <QStringList>
+#include <QVector>
 
-typedef QStringList Backtrace;
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
 
-Backtrace getBacktrace(int levels = -1);
+/** A call stack, captured as raw return addresses and only symbolized on demand.
+ *  Identical call stacks share their data.
+ */
+class Backtrace
+{
+public:
+    Backtrace();
+    /// from raw return addresses, innermost frame first
+    explicit Backtrace(const QVector<quintptr> &addresses);
+    /// from already symbolized frames, for platforms not providing addresses
+    explicit Backtrace(const QStringList &frames);
+
+    bool isEmpty() const;
+    int size() const;
+    /// the symbolized frames, symbols are cached across all backtraces
+    QStringList frames() const;
+
+private:
+    friend QDataStream &operator<<(QDataStream &stream, const Backtrace &backtrace);
+    friend QDataStream &operator>>(QDataStream &stream, Backtrace &backtrace);
+    QVector<quintptr> m_addresses;
+    QStringList m_frames;
+};
+
+QDataStream &operator<<(QDataStream &stream, const Backtrace &backtrace);
+QDataStream &operator>>(QDataStream &stream, Backtrace &backtrace);
+
+/** Captures the current call stack, omitting getBacktrace() itself and the @p skip
+ *  frames calling it, and keeping at most @p levels frames.
+ *  Skipping is best-effort: frames are counted as they appear on the stack, so inlined
+ *  or tail called functions of the caller shift what is skipped.
+ */
+Backtrace getBacktrace(int levels = -1, int skip = 0);
+
+/// @internal platform specific symbolization of return addresses
+QStringList symbolizeBacktrace(const QVector<quintptr> &addresses);
 
 #endif // BACKTRACE_H
@@ -28,8 +28,15 @@
 
 #include "backtrace.h"
 
-Backtrace getBacktrace(int levels)
+Backtrace getBacktrace(int levels, int skip)
 {
     Q_UNUSED(levels);
+    Q_UNUSED(skip);
     return Backtrace();
 }
+
+QStringList symbolizeBacktrace(const QVector<quintptr> &addresses)
+{
+    Q_UNUSED(addresses);
+    return QStringList();
+}
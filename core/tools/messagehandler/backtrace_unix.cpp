@@ -68,28 +68,45 @@ static QString maybeDemangleName(char *name)
 
 #endif
 
-Backtrace getBacktrace(int levels)
+Backtrace getBacktrace(int levels, int skip)
 {
-    QStringList s;
 #ifdef HAVE_BACKTRACE
     void *trace[256];
-    int n = backtrace(trace, 256);
-    if (!n)
-        return s;
-    char **strings = backtrace_symbols(trace, n);
+    const int n = backtrace(trace, 256);
+    // skip ourselves as well
+    const int first = qMin(n, skip + 1);
+    const int last = levels == -1 ? n : qMin(n, first + levels);
+
+    QVector<quintptr> addresses;
+    addresses.reserve(last - first);
+    for (int i = first; i < last; ++i)
+        addresses.push_back(reinterpret_cast<quintptr>(trace[i]));
+    return Backtrace(addresses);
+#else
+    Q_UNUSED(levels);
+    Q_UNUSED(skip);
+    return Backtrace();
+#endif
+}
 
-    if (levels != -1)
-        n = qMin(n, levels);
+QStringList symbolizeBacktrace(const QVector<quintptr> &addresses)
+{
+    QStringList s;
+#ifdef HAVE_BACKTRACE
+    QVector<void *> trace;
+    trace.reserve(addresses.size());
+    foreach (quintptr address, addresses)
+        trace.push_back(reinterpret_cast<void *>(address));
+    char **strings = backtrace_symbols(trace.data(), trace.size());
+    if (!strings)
+        return s;
 
-    s.reserve(n);
-    for (int i = 0; i < n; ++i)
+    s.reserve(trace.size());
+    for (int i = 0; i < trace.size(); ++i)
         s << maybeDemangleName(strings[i]);
-
-    if (strings)
-        free(strings);
-
+    free(strings);
 #else
-    Q_UNUSED(levels);
+    Q_UNUSED(addresses);
 #endif
     return s;
 }
@@ -65,10 +65,23 @@ private:
 
 static StackWalkerToQStringList *stackWalkerToQStringList = 0;
 
-Backtrace getBacktrace(int /*levels*/)
+Backtrace getBacktrace(int levels, int skip)
 {
-    // FIXME: Perhaps take the levels into account
     if (!stackWalkerToQStringList)
         stackWalkerToQStringList = new StackWalkerToQStringList();
-    return stackWalkerToQStringList->getStackWalkerBacktrace();
+    // StackWalker only provides symbolized frames, including its own ones
+    QStringList frames = stackWalkerToQStringList->getStackWalkerBacktrace();
+    int first = 0;
+    for (int i = 0; i < frames.size(); ++i) {
+        if (frames.at(i).contains(QLatin1String("getBacktrace")))
+            first = i + 1;
+    }
+    frames = frames.mid(qMin(frames.size(), first + skip), levels);
+    return Backtrace(frames);
+}
+
+QStringList symbolizeBacktrace(const QVector<quintptr> &addresses)
+{
+    Q_UNUSED(addresses);
+    return QStringList();
 }
@@ -35,6 +35,7 @@
 #include "backtrace.h"
 
 #include <core/probeguard.h>
+#include <core/probesettings.h>
 #include <core/remote/serverproxymodel.h>
 
 #include "common/objectbroker.h"
@@ -91,19 +92,12 @@ static void handleMessage(QtMsgType type, const QMessageLogContext &context, con
 
     if (type == QtCriticalMsg || type == QtFatalMsg
         || (type == QtWarningMsg && !ProbeGuard::insideProbe())) {
-        message.backtrace = getBacktrace(50);
-        // remove trailing internal functions
-        // be a bit careful and first make sure that we find this function...
+        // skip ourselves, only capture the addresses here, symbolization is expensive
+        // and only done when someone looks at this
+        // this is best-effort, we are only called through a function pointer and thus never
+        // inlined, but there's no reliable way to find our own frame by address without symbols
         // TODO: go even higher until qWarning/qFatal/qDebug/... ?
-        int removeUntil = -1;
-        for (int i = 0; i < message.backtrace.size(); ++i) {
-            if (message.backtrace.at(i).contains(QLatin1String("handleMessage"))) {
-                removeUntil = i;
-                break;
-            }
-        }
-        if (removeUntil != -1)
-            message.backtrace = message.backtrace.mid(removeUntil + 1);
+        message.backtrace = getBacktrace(50, 1);
     }
 
     if (!message.backtrace.isEmpty()
@@ -113,7 +107,7 @@ static void handleMessage(QtMsgType type, const QMessageLogContext &context, con
                 qApp->applicationFilePath()) << ')' << std::endl;
         std::cerr << "START BACKTRACE:" << std::endl;
         int i = 0;
-        foreach (const QString &frame, message.backtrace)
+        foreach (const QString &frame, message.backtrace.frames())
             std::cerr << (++i) << "\t" << qPrintable(frame) << std::endl;
         std::cerr << "END BACKTRACE" << std::endl;
     }
@@ -162,11 +156,15 @@ MessageHandler::MessageHandler(ProbeInterface *probe, QObject *parent)
 {
     Q_ASSERT(s_model == nullptr);
     s_model = m_messageModel;
+    const qint64 memoryBudget = ProbeSettings::value(QStringLiteral("MessageMemoryBudget"),
+                                                     m_messageModel->memoryBudget()).toLongLong();
+    if (memoryBudget > 0)
+        m_messageModel->setMemoryBudget(memoryBudget);
 
     auto proxy = new ServerProxyModel<QSortFilterProxyModel>(this);
     proxy->addRole(MessageModelRole::Type);
     proxy->addRole(MessageModelRole::Line);
-    proxy->addRole(MessageModelRole::Backtrace);
+    proxy->addRole(MessageModelRole::MessageId);
     proxy->setSourceModel(m_messageModel);
     proxy->setSortRole(MessageModelRole::Sort);
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.MessageModel"), proxy);
@@ -211,12 +209,18 @@ void MessageHandler::ensureHandlerInstalled()
         s_handler = prevHandler;
 }
 
+void MessageHandler::requestBacktrace(int messageId)
+{
+    emit backtraceAvailable(messageId, m_messageModel->backtrace(messageId));
+}
+
 void MessageHandler::handleFatalMessage(const DebugMessage &message)
 {
     const QString app = qApp->applicationName().isEmpty()
                         ? qApp->applicationFilePath()
                         : qApp->applicationName();
-    emit fatalMessageReceived(app, message.message, message.time, message.backtrace);
+    emit fatalMessageReceived(app, message.message, message.time,
+                              message.backtrace.frames());
     if (Endpoint::isConnected())
         Endpoint::instance()->waitForMessagesWritten();
 }
@@ -48,6 +48,9 @@ public:
     explicit MessageHandler(ProbeInterface *probe, QObject *parent = nullptr);
     ~MessageHandler();
 
+public slots:
+    void requestBacktrace(int messageId) Q_DECL_OVERRIDE;
+
 private slots:
     void ensureHandlerInstalled();
     void handleFatalMessage(const GammaRay::DebugMessage &message);
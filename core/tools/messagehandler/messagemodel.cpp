@@ -30,14 +30,37 @@
 
 #include <common/tools/messagehandler/messagemodelroles.h>
 
-#include <QDebug>
+#include <QDataStream>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <limits>
 
 using namespace GammaRay;
 
+// number of messages between two entries in the spill file index
+static const int SpillBlockSize = 64;
+// fraction of the memory budget available for messages paged in from the spill file
+static const int SpilledBlocksBudgetDivisor = 4;
+
+static qint64 messageSize(const DebugMessage &message)
+{
+    // interned strings and backtraces are shared, so this is an upper bound
+    return sizeof(DebugMessage) + message.message.size() * sizeof(QChar)
+           + message.backtrace.size() * sizeof(quintptr);
+}
+
 MessageModel::MessageModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , m_messages(1024)
+    , m_memoryBudget(0)
+    , m_memoryUsage(0)
+    , m_spillFile(new QTemporaryFile(QDir::tempPath() + QLatin1String("/gammaray-messages-XXXXXX"), this))
+    , m_spillFileFailed(false)
+    , m_droppedCount(0)
 {
     qRegisterMetaType<DebugMessage>();
+    setMemoryBudget(16 * 1024 * 1024);
 }
 
 MessageModel::~MessageModel()
@@ -49,9 +72,164 @@ void MessageModel::addMessage(const DebugMessage &message)
     ///WARNING: do not trigger *any* kind of debug output here
     ///         this would trigger an infinite loop and hence crash!
 
-    beginInsertRows(QModelIndex(), m_messages.count(), m_messages.count());
-    m_messages << message;
+    DebugMessage msg(message);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    msg.category = intern(message.category);
+    msg.file = intern(message.file);
+    msg.function = intern(message.function);
+#endif
+
+    const int row = rowCount();
+    beginInsertRows(QModelIndex(), row, row);
+    if (m_messages.isFull())
+        m_messages.setCapacity(m_messages.capacity() * 2);
+    m_messages.append(msg);
+    m_memoryUsage += messageSize(msg);
     endInsertRows();
+
+    spillMessages();
+}
+
+qint64 MessageModel::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void MessageModel::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+    m_spilledBlocks.setMaxCost(static_cast<int>(qMin<qint64>(bytes / SpilledBlocksBudgetDivisor,
+                                                              std::numeric_limits<int>::max())));
+    spillMessages();
+}
+
+QString MessageModel::intern(const QString &str) const
+{
+    const auto it = m_strings.constFind(str);
+    if (it != m_strings.constEnd())
+        return *it;
+    m_strings.insert(str);
+    return str;
+}
+
+void MessageModel::writeMessage(QDataStream &stream, const DebugMessage &message) const
+{
+    stream << static_cast<qint32>(message.type) << message.message << message.time
+           << message.backtrace;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    stream << message.category << message.file << message.function
+           << static_cast<qint32>(message.line);
+#endif
+}
+
+void MessageModel::readMessage(QDataStream &stream, DebugMessage &message) const
+{
+    qint32 type;
+    stream >> type >> message.message >> message.time >> message.backtrace;
+    message.type = static_cast<QtMsgType>(type);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    qint32 line;
+    stream >> message.category >> message.file >> message.function >> line;
+    message.category = intern(message.category);
+    message.file = intern(message.file);
+    message.function = intern(message.function);
+    message.line = line;
+#endif
+}
+
+void MessageModel::spillMessages()
+{
+    ///WARNING: do not trigger *any* kind of debug output here either
+
+    if (m_memoryUsage <= m_memoryBudget || m_messages.count() <= 1)
+        return;
+
+    if (!m_spillFileFailed && !m_spillFile->isOpen()) {
+        // nothing spilled yet, so block offsets line up with message numbers
+        m_spillFileFailed = m_droppedCount > 0 || !m_spillFile->open();
+    }
+
+    QDataStream stream(m_spillFile);
+    while (m_memoryUsage > m_memoryBudget && m_messages.count() > 1) {
+        const int index = m_messages.firstIndex();
+        m_memoryUsage -= messageSize(m_messages.first());
+
+        if (m_spillFileFailed) {
+            // we have no place to keep them, so drop them entirely
+            beginRemoveRows(QModelIndex(), 0, 0);
+            m_messages.removeFirst();
+            ++m_droppedCount;
+            endRemoveRows();
+            continue;
+        }
+
+        if (index % SpillBlockSize == 0)
+            m_spillBlockOffsets.push_back(m_spillFile->pos());
+        writeMessage(stream, m_messages.first());
+        if (stream.status() != QDataStream::Ok) {
+            // what got spilled so far can't be paged back in reliably either, and
+            // m_droppedCount can only account for the oldest messages, so drop all of it
+            m_spillFileFailed = true;
+            beginRemoveRows(QModelIndex(), 0, index - m_droppedCount);
+            m_messages.removeFirst();
+            m_droppedCount = index + 1;
+            m_spillBlockOffsets.clear();
+            m_spilledBlocks.clear();
+            m_spillFile->close();
+            endRemoveRows();
+            continue;
+        }
+        m_messages.removeFirst();
+        // a previously paged in copy of this block is incomplete now
+        m_spilledBlocks.remove(index / SpillBlockSize);
+    }
+}
+
+QVector<DebugMessage> *MessageModel::loadSpilledBlock(int block) const
+{
+    auto messages = new QVector<DebugMessage>;
+    messages->reserve(SpillBlockSize);
+
+    const qint64 writePos = m_spillFile->pos();
+    const qint64 end = block + 1 < m_spillBlockOffsets.size() ? m_spillBlockOffsets.at(block + 1) : writePos;
+    qint64 cost = 0;
+    if (m_spillFile->seek(m_spillBlockOffsets.at(block))) {
+        QDataStream stream(m_spillFile);
+        while (m_spillFile->pos() < end && stream.status() == QDataStream::Ok) {
+            DebugMessage message;
+            readMessage(stream, message);
+            cost += messageSize(message);
+            messages->push_back(message);
+        }
+    }
+    m_spillFile->seek(writePos);
+
+    // QCache deletes objects exceeding its capacity right away
+    m_spilledBlocks.insert(block, messages, static_cast<int>(qMin<qint64>(cost, m_spilledBlocks.maxCost())));
+    return messages;
+}
+
+DebugMessage MessageModel::message(int row) const
+{
+    const int index = row + m_droppedCount;
+    if (m_messages.containsIndex(index))
+        return m_messages.at(index);
+
+    const int block = index / SpillBlockSize;
+    QVector<DebugMessage> *messages = m_spilledBlocks.object(block);
+    if (!messages)
+        messages = loadSpilledBlock(block);
+    if (index % SpillBlockSize < messages->size())
+        return messages->at(index % SpillBlockSize);
+    return DebugMessage();
+}
+
+QStringList MessageModel::backtrace(int messageId) const
+{
+    const int row = messageId - m_droppedCount;
+    if (row < 0 || row >= rowCount())
+        return QStringList();
+    return message(row).backtrace.frames();
 }
 
 int MessageModel::columnCount(const QModelIndex &parent) const
@@ -69,15 +247,15 @@ int MessageModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
 
-    return m_messages.count();
+    return m_messages.lastIndex() + 1 - m_droppedCount;
 }
 
 QVariant MessageModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() > rowCount() || index.column() > columnCount())
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount())
         return QVariant();
 
-    const DebugMessage &msg = m_messages.at(index.row());
+    const DebugMessage msg = message(index.row());
 
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
@@ -116,7 +294,9 @@ QVariant MessageModel::data(const QModelIndex &index, int role) const
         return msg.line;
 #endif
     } else if (role == MessageModelRole::Backtrace && index.column() == 0) {
-        return msg.backtrace;
+        return msg.backtrace.frames();
+    } else if (role == MessageModelRole::MessageId && index.column() == 0) {
+        return index.row() + m_droppedCount;
     }
 
     return QVariant();
@@ -33,9 +33,17 @@
 #include <common/tools/messagehandler/messagemodelroles.h>
 
 #include <QAbstractTableModel>
+#include <QCache>
+#include <QContiguousCache>
+#include <QSet>
 #include <QTime>
 #include <QVector>
 
+QT_BEGIN_NAMESPACE
+class QDataStream;
+class QTemporaryFile;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 struct DebugMessage {
     QtMsgType type;
@@ -57,6 +65,10 @@ QT_BEGIN_NAMESPACE
 QT_END_NAMESPACE
 
 namespace GammaRay {
+/** Model of all debug messages.
+ *  To keep memory usage flat in long running sessions, only the most recent messages
+ *  are kept in memory, older ones are moved to a temporary file and read back on demand.
+ */
 class MessageModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -70,11 +82,41 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation,
                         int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
 
+    /** Approximate number of bytes used for keeping messages in memory. */
+    qint64 memoryBudget() const;
+    void setMemoryBudget(qint64 bytes);
+
+    /** Symbolized backtrace of the message with MessageModelRole::MessageId @p messageId. */
+    QStringList backtrace(int messageId) const;
+
 public slots:
     void addMessage(const GammaRay::DebugMessage &message);
 
 private:
-    QVector<DebugMessage> m_messages;
+    QString intern(const QString &str) const;
+    void writeMessage(QDataStream &stream, const DebugMessage &message) const;
+    void readMessage(QDataStream &stream, DebugMessage &message) const;
+    /// returns a copy, a paged in block can be evicted again by the next load
+    DebugMessage message(int row) const;
+    QVector<DebugMessage> *loadSpilledBlock(int block) const;
+    /// move the oldest messages to the spill file until we are within our memory budget
+    void spillMessages();
+
+    // indexed by message number, holds the most recent ones
+    QContiguousCache<DebugMessage> m_messages;
+    qint64 m_memoryBudget;
+    qint64 m_memoryUsage;
+    // category, file and function names, shared between all messages
+    mutable QSet<QString> m_strings;
+
+    // append-only log of the messages no longer in m_messages, with the file offsets
+    // of every SpillBlockSize messages, for paging them back in
+    QTemporaryFile *m_spillFile;
+    QVector<qint64> m_spillBlockOffsets;
+    mutable QCache<int, QVector<DebugMessage> > m_spilledBlocks;
+    bool m_spillFileFailed;
+    // messages we had no place to spill to, row = message number - m_droppedCount
+    int m_droppedCount;
 };
 }
 
@@ -27,6 +27,7 @@
 */
 
 #include "objectinspector.h"
+#include "objectsearchproxymodel.h"
 #include "propertycontroller.h"
 #include "probeinterface.h"
 #include "methodsextension.h"
@@ -40,8 +41,6 @@
 #include <common/objectmodel.h>
 #include <remote/serverproxymodel.h>
 
-#include <3rdparty/kde/krecursivefilterproxymodel.h>
-
 #include <QCoreApplication>
 #include <QItemSelectionModel>
 
@@ -55,7 +54,7 @@ ObjectInspector::ObjectInspector(ProbeInterface *probe, QObject *parent)
     m_propertyController = new PropertyController(QStringLiteral(
                                                       "com.kdab.GammaRay.ObjectInspector"), this);
 
-    auto proxy = new ServerProxyModel<KRecursiveFilterProxyModel>(this);
+    auto proxy = new ServerProxyModel<ObjectSearchProxyModel>(this);
     proxy->setSourceModel(probe->objectTreeModel());
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.ObjectInspectorTree"), proxy);
 
@@ -0,0 +1,287 @@
+/*
+  objectsnapshot.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsnapshot.h"
+#include "objectsnapshotlistmodel.h"
+#include "objectsnapshotmodel.h"
+
+#include <core/objecttreemodel.h>
+#include <core/probe.h>
+#include <core/probesettings.h>
+#include <core/remote/serverproxymodel.h>
+
+#include <common/tools/objectsnapshot/objectsnapshotroles.h>
+
+#include <3rdparty/kde/krecursivefilterproxymodel.h>
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSortFilterProxyModel>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+using namespace GammaRay;
+
+struct ObjectSnapshot::EncoderLink
+{
+    EncoderLink()
+        : receiver(nullptr)
+    {
+    }
+
+    QMutex mutex;
+    ObjectSnapshot *receiver;
+};
+
+/** Serializes a captured snapshot in a pool thread. */
+class ObjectSnapshot::Encoder : public QRunnable
+{
+public:
+    Encoder(const QSharedPointer<EncoderLink> &link, int snapshotId, const ObjectSnapshotData &snapshot)
+        : m_link(link)
+        , m_snapshotId(snapshotId)
+        , m_snapshot(snapshot)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        const QByteArray data = m_snapshot.encode();
+        QMutexLocker lock(&m_link->mutex);
+        if (m_link->receiver) {
+            QMetaObject::invokeMethod(m_link->receiver, "snapshotEncoded", Qt::QueuedConnection,
+                                      Q_ARG(int, m_snapshotId), Q_ARG(QByteArray, data));
+        }
+    }
+
+private:
+    QSharedPointer<EncoderLink> m_link;
+    int m_snapshotId;
+    ObjectSnapshotData m_snapshot;
+};
+
+ObjectSnapshot::ObjectSnapshot(ProbeInterface *probe, QObject *parent)
+    : ObjectSnapshotInterface(parent)
+    , m_objectTreeModel(static_cast<ObjectTreeModel *>(Probe::instance()->objectTreeModel()))
+    , m_snapshotListModel(new ObjectSnapshotListModel(this))
+    , m_snapshotModel(new ObjectSnapshotModel(this))
+    , m_captureTimer(new QTimer(this))
+    , m_encoderLink(new EncoderLink)
+    , m_nextSnapshotId(0)
+    , m_selectedId(-1)
+    , m_diffBaseId(-1)
+{
+    m_encoderLink->receiver = this;
+
+    const QString propertyNames = ProbeSettings::value(
+        QStringLiteral("ObjectSnapshotProperties"),
+        QStringLiteral("enabled,visible,geometry,x,y,width,height,opacity,text,checked,currentIndex")).toString();
+    foreach (const QString &name, propertyNames.split(QLatin1Char(','), QString::SkipEmptyParts))
+        m_propertyNames.push_back(name.trimmed().toUtf8());
+
+    m_snapshotListModel->setMaxSnapshots(ProbeSettings::value(QStringLiteral("ObjectSnapshotCount"), 16).toInt());
+    connect(m_snapshotListModel, SIGNAL(snapshotRemoved(int)), this, SLOT(snapshotRemoved(int)));
+    auto listProxy = new ServerProxyModel<QSortFilterProxyModel>(this);
+    listProxy->setSourceModel(m_snapshotListModel);
+    listProxy->addRole(ObjectSnapshotRoles::SnapshotIdRole);
+    probe->registerModel(QStringLiteral("com.kdab.GammaRay.ObjectSnapshotListModel"), listProxy);
+
+    auto snapshotProxy = new ServerProxyModel<KRecursiveFilterProxyModel>(this);
+    snapshotProxy->setSourceModel(m_snapshotModel);
+    snapshotProxy->addRole(ObjectSnapshotRoles::DiffStateRole);
+    probe->registerModel(QStringLiteral("com.kdab.GammaRay.ObjectSnapshotModel"), snapshotProxy);
+
+    m_captureTimer->setInterval(ProbeSettings::value(QStringLiteral("ObjectSnapshotInterval"), 250).toInt());
+    connect(m_captureTimer, SIGNAL(timeout()), this, SLOT(takeSnapshot()));
+}
+
+ObjectSnapshot::~ObjectSnapshot()
+{
+    QMutexLocker lock(&m_encoderLink->mutex);
+    m_encoderLink->receiver = nullptr;
+}
+
+void ObjectSnapshot::takeSnapshot()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const ObjectSnapshotData snapshot = capture();
+
+    ObjectSnapshotListModel::Snapshot entry;
+    entry.id = m_nextSnapshotId++;
+    entry.timestamp = QDateTime::currentDateTime();
+    entry.captureTime = timer.nsecsElapsed() / 1000;
+    entry.objectCount = snapshot.objects.size();
+    m_snapshotListModel->addSnapshot(entry);
+
+    QThreadPool::globalInstance()->start(new Encoder(m_encoderLink, entry.id, snapshot));
+}
+
+void ObjectSnapshot::setContinuousCapture(bool enabled)
+{
+    if (enabled)
+        m_captureTimer->start();
+    else
+        m_captureTimer->stop();
+}
+
+void ObjectSnapshot::selectSnapshot(int snapshotId)
+{
+    if (m_selectedId == snapshotId)
+        return;
+    m_selectedId = snapshotId;
+    updateSnapshotModel();
+}
+
+void ObjectSnapshot::setDiffBase(int snapshotId)
+{
+    if (m_diffBaseId == snapshotId)
+        return;
+    m_diffBaseId = snapshotId;
+    m_snapshotListModel->setDiffBase(snapshotId);
+    updateSnapshotModel();
+}
+
+void ObjectSnapshot::snapshotEncoded(int snapshotId, const QByteArray &data)
+{
+    m_snapshotListModel->setSnapshotData(snapshotId, data);
+    if (snapshotId == m_selectedId || snapshotId == m_diffBaseId)
+        updateSnapshotModel();
+}
+
+void ObjectSnapshot::snapshotRemoved(int snapshotId)
+{
+    if (snapshotId == m_diffBaseId)
+        setDiffBase(-1);
+    if (snapshotId == m_selectedId)
+        selectSnapshot(-1);
+}
+
+ObjectSnapshotData ObjectSnapshot::capture()
+{
+    ObjectSnapshotData snapshot;
+    snapshot.propertyNames = m_propertyNames;
+    QHash<const QMetaObject *, quint16> classIds;
+
+    // the object tree model knows all parent/child relations already, walk that in pre-order
+    // rather than asking every object for its children
+    QVector<QPair<QObject *, qint32> > pending;
+    const QVector<QObject *> topLevelObjects = m_objectTreeModel->childObjects(nullptr);
+    for (int i = topLevelObjects.size() - 1; i >= 0; --i)
+        pending.push_back(qMakePair(topLevelObjects.at(i), qint32(-1)));
+
+    while (!pending.isEmpty()) {
+        const QPair<QObject *, qint32> entry = pending.last();
+        pending.pop_back();
+        QObject *obj = entry.first;
+
+        // only hold the object lock for the shallow copies, threads creating or destroying
+        // objects would otherwise be blocked for the entire capture
+        const QMetaObject *mo = nullptr;
+        ObjectSnapshotData::Object captured;
+        bool ownThread = false;
+        {
+            QMutexLocker lock(Probe::objectLock());
+            if (!Probe::instance()->isValidObject(obj))
+                continue; // about to be removed from the object tree, along with its children
+            mo = obj->metaObject();
+            captured.objectName = obj->objectName();
+            ownThread = obj->thread() == thread();
+        }
+
+        auto classIt = classIds.constFind(mo);
+        if (classIt == classIds.constEnd()) {
+            classIt = classIds.insert(mo, snapshot.classNames.size());
+            snapshot.classNames.push_back(QByteArray(mo->className()));
+        }
+
+        captured.address = reinterpret_cast<quintptr>(obj);
+        captured.parent = entry.second;
+        captured.classId = classIt.value();
+        // objects of our own thread cannot be destroyed behind our back, so their properties can be
+        // read without the lock, reading properties of objects living in other threads is not safe at all
+        if (ownThread)
+            captureProperties(obj, mo, captured);
+
+        const qint32 index = snapshot.objects.size();
+        snapshot.objects.push_back(captured);
+
+        const QVector<QObject *> children = m_objectTreeModel->childObjects(obj);
+        for (int i = children.size() - 1; i >= 0; --i)
+            pending.push_back(qMakePair(children.at(i), index));
+    }
+
+    return snapshot;
+}
+
+void ObjectSnapshot::captureProperties(QObject *obj, const QMetaObject *mo,
+                                       ObjectSnapshotData::Object &captured)
+{
+    auto it = m_propertyIndexes.constFind(mo);
+    if (it == m_propertyIndexes.constEnd()) {
+        QVector<QPair<quint16, int> > indexes;
+        for (int i = 0; i < m_propertyNames.size(); ++i) {
+            const int index = mo->indexOfProperty(m_propertyNames.at(i).constData());
+            if (index >= 0)
+                indexes.push_back(qMakePair(static_cast<quint16>(i), index));
+        }
+        it = m_propertyIndexes.insert(mo, indexes);
+    }
+
+    const QVector<QPair<quint16, int> > &indexes = it.value();
+    for (int i = 0; i < indexes.size(); ++i) {
+        const QVariant value = ObjectSnapshotData::capturedValue(mo->property(indexes.at(i).second).read(obj));
+        if (!value.isValid())
+            continue;
+        ObjectSnapshotData::PropertyValue prop;
+        prop.propertyId = indexes.at(i).first;
+        prop.value = value;
+        captured.properties.push_back(prop);
+    }
+}
+
+void ObjectSnapshot::updateSnapshotModel()
+{
+    const ObjectSnapshotListModel::Snapshot *selected = m_snapshotListModel->snapshot(m_selectedId);
+    if (!selected || selected->data.isEmpty()) {
+        m_snapshotModel->setSnapshot(ObjectSnapshotData());
+        return;
+    }
+
+    const ObjectSnapshotData snapshot = ObjectSnapshotData::decode(selected->data);
+    const ObjectSnapshotListModel::Snapshot *base = m_snapshotListModel->snapshot(m_diffBaseId);
+    if (!base || base->data.isEmpty() || m_diffBaseId == m_selectedId) {
+        m_snapshotModel->setSnapshot(snapshot);
+        return;
+    }
+
+    const ObjectSnapshotData baseSnapshot = ObjectSnapshotData::decode(base->data);
+    m_snapshotModel->setSnapshot(snapshot, &baseSnapshot);
+}
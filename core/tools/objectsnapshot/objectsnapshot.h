@@ -0,0 +1,108 @@
+/*
+  objectsnapshot.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOT_H
+#define GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOT_H
+
+#include "objectsnapshotdata.h"
+
+#include <core/toolfactory.h>
+
+#include <common/tools/objectsnapshot/objectsnapshotinterface.h>
+
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+
+class ObjectSnapshotListModel;
+class ObjectSnapshotModel;
+class ObjectTreeModel;
+
+/** Captures the object tree into a ring of compact binary snapshots.
+ *  Capturing only takes shallow copies on the main thread, serialization happens in the background.
+ */
+class ObjectSnapshot : public ObjectSnapshotInterface
+{
+    Q_OBJECT
+    Q_INTERFACES(GammaRay::ObjectSnapshotInterface)
+public:
+    explicit ObjectSnapshot(ProbeInterface *probe, QObject *parent = nullptr);
+    ~ObjectSnapshot();
+
+public slots:
+    void takeSnapshot() Q_DECL_OVERRIDE;
+    void setContinuousCapture(bool enabled) Q_DECL_OVERRIDE;
+    void selectSnapshot(int snapshotId) Q_DECL_OVERRIDE;
+    void setDiffBase(int snapshotId) Q_DECL_OVERRIDE;
+
+private slots:
+    void snapshotEncoded(int snapshotId, const QByteArray &data);
+    void snapshotRemoved(int snapshotId);
+
+private:
+    class Encoder;
+    struct EncoderLink;
+
+    ObjectSnapshotData capture();
+    void captureProperties(QObject *obj, const QMetaObject *mo, ObjectSnapshotData::Object &captured);
+    void updateSnapshotModel();
+
+    ObjectTreeModel *m_objectTreeModel;
+    ObjectSnapshotListModel *m_snapshotListModel;
+    ObjectSnapshotModel *m_snapshotModel;
+    QTimer *m_captureTimer;
+    // shared with running encoders, to avoid them calling back into us after destruction
+    QSharedPointer<EncoderLink> m_encoderLink;
+
+    QVector<QByteArray> m_propertyNames;
+    // captured properties per class, as pairs of property id and property index
+    QHash<const QMetaObject *, QVector<QPair<quint16, int> > > m_propertyIndexes;
+
+    int m_nextSnapshotId;
+    int m_selectedId;
+    int m_diffBaseId;
+};
+
+class ObjectSnapshotFactory : public QObject, public StandardToolFactory<QObject, ObjectSnapshot>
+{
+    Q_OBJECT
+    Q_INTERFACES(GammaRay::ToolFactory)
+public:
+    explicit ObjectSnapshotFactory(QObject *parent)
+        : QObject(parent)
+    {
+    }
+};
+}
+
+#endif // GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOT_H
@@ -0,0 +1,126 @@
+/*
+  objectsnapshotdata.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsnapshotdata.h"
+
+#include <core/varianthandler.h>
+
+#include <QDataStream>
+
+using namespace GammaRay;
+
+static const quint8 FormatVersion = 1;
+
+QByteArray ObjectSnapshotData::encode() const
+{
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << FormatVersion << classNames << propertyNames << quint32(objects.size());
+        foreach (const Object &obj, objects) {
+            stream << obj.address << obj.parent << obj.classId << obj.objectName
+                   << quint16(obj.properties.size());
+            foreach (const PropertyValue &prop, obj.properties)
+                stream << prop.propertyId << prop.value;
+        }
+    }
+    return qCompress(data);
+}
+
+ObjectSnapshotData ObjectSnapshotData::decode(const QByteArray &data)
+{
+    ObjectSnapshotData snapshot;
+    const QByteArray uncompressed = qUncompress(data);
+    QDataStream stream(uncompressed);
+
+    quint8 version;
+    quint32 objectCount;
+    stream >> version;
+    if (version != FormatVersion)
+        return ObjectSnapshotData();
+    stream >> snapshot.classNames >> snapshot.propertyNames >> objectCount;
+    if (stream.status() != QDataStream::Ok)
+        return ObjectSnapshotData();
+
+    snapshot.objects.resize(objectCount);
+    for (quint32 i = 0; i < objectCount; ++i) {
+        Object &obj = snapshot.objects[i];
+        quint16 propertyCount;
+        stream >> obj.address >> obj.parent >> obj.classId >> obj.objectName >> propertyCount;
+        if (stream.status() != QDataStream::Ok || obj.parent >= qint32(i)
+            || obj.classId >= snapshot.classNames.size())
+            return ObjectSnapshotData();
+
+        obj.properties.resize(propertyCount);
+        for (int j = 0; j < obj.properties.size(); ++j) {
+            PropertyValue &prop = obj.properties[j];
+            stream >> prop.propertyId >> prop.value;
+            if (prop.propertyId >= snapshot.propertyNames.size())
+                return ObjectSnapshotData();
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        return ObjectSnapshotData();
+    return snapshot;
+}
+
+QVariant ObjectSnapshotData::capturedValue(const QVariant &value)
+{
+    if (!value.isValid())
+        return QVariant();
+
+    switch (value.userType()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::QChar:
+    case QMetaType::QString:
+    case QMetaType::QStringList:
+    case QMetaType::QByteArray:
+    case QMetaType::QUrl:
+    case QMetaType::QDate:
+    case QMetaType::QTime:
+    case QMetaType::QDateTime:
+    case QMetaType::QSize:
+    case QMetaType::QSizeF:
+    case QMetaType::QPoint:
+    case QMetaType::QPointF:
+    case QMetaType::QRect:
+    case QMetaType::QRectF:
+        // plain value types, streamed as-is in the background
+        return value;
+    }
+
+    // pointers, types without stream operators, or values that might refer to data
+    // owned by the application, capture the display form while we still can
+    return VariantHandler::displayString(value);
+}
@@ -0,0 +1,80 @@
+/*
+  objectsnapshotdata.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTDATA_H
+#define GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTDATA_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+namespace GammaRay {
+
+/** Content of one object tree snapshot.
+ *  Objects are stored in pre-order, so parents always precede their children.
+ *  Values only hold implicitly shared data, copying a snapshot is therefore cheap and does
+ *  not deep-copy anything still in use by the application.
+ */
+class ObjectSnapshotData
+{
+public:
+    struct PropertyValue {
+        quint16 propertyId; // index into propertyNames
+        QVariant value;
+    };
+
+    struct Object {
+        quint64 address;
+        qint32 parent; // index into objects, -1 for top-level objects
+        quint16 classId; // index into classNames
+        QString objectName;
+        QVector<PropertyValue> properties;
+    };
+
+    QVector<QByteArray> classNames;
+    QVector<QByteArray> propertyNames;
+    QVector<Object> objects;
+
+    /** Serializes the snapshot into its compressed binary form. */
+    QByteArray encode() const;
+    /** Restores a snapshot from the output of encode(), returns an empty snapshot on failure. */
+    static ObjectSnapshotData decode(const QByteArray &data);
+
+    /** Converts a property value into something we can safely hold on to and serialize.
+     *  Must be called in the thread of the object the value was read from.
+     */
+    static QVariant capturedValue(const QVariant &value);
+};
+}
+
+QT_BEGIN_NAMESPACE
+Q_DECLARE_TYPEINFO(GammaRay::ObjectSnapshotData::PropertyValue, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(GammaRay::ObjectSnapshotData::Object, Q_MOVABLE_TYPE);
+QT_END_NAMESPACE
+
+#endif // GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTDATA_H
@@ -0,0 +1,190 @@
+/*
+  objectsnapshotlistmodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsnapshotlistmodel.h"
+
+#include <common/tools/objectsnapshot/objectsnapshotroles.h>
+
+#include <algorithm>
+
+using namespace GammaRay;
+
+static bool snapshotIdLessThan(const ObjectSnapshotListModel::Snapshot &lhs, int rhs)
+{
+    return lhs.id < rhs;
+}
+
+ObjectSnapshotListModel::ObjectSnapshotListModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_maxSnapshots(16)
+    , m_diffBaseId(-1)
+{
+}
+
+ObjectSnapshotListModel::~ObjectSnapshotListModel()
+{
+}
+
+int ObjectSnapshotListModel::maxSnapshots() const
+{
+    return m_maxSnapshots;
+}
+
+void ObjectSnapshotListModel::setMaxSnapshots(int count)
+{
+    m_maxSnapshots = qMax(1, count);
+    removeExcessSnapshots();
+}
+
+void ObjectSnapshotListModel::addSnapshot(const Snapshot &snapshot)
+{
+    Q_ASSERT(m_snapshots.isEmpty() || m_snapshots.last().id < snapshot.id);
+    beginInsertRows(QModelIndex(), m_snapshots.size(), m_snapshots.size());
+    m_snapshots.push_back(snapshot);
+    endInsertRows();
+    removeExcessSnapshots();
+}
+
+void ObjectSnapshotListModel::setSnapshotData(int snapshotId, const QByteArray &data)
+{
+    const int row = rowForId(snapshotId);
+    if (row < 0)
+        return;
+    m_snapshots[row].data = data;
+    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+}
+
+const ObjectSnapshotListModel::Snapshot *ObjectSnapshotListModel::snapshot(int snapshotId) const
+{
+    const int row = rowForId(snapshotId);
+    if (row < 0)
+        return nullptr;
+    return &m_snapshots.at(row);
+}
+
+void ObjectSnapshotListModel::setDiffBase(int snapshotId)
+{
+    if (m_diffBaseId == snapshotId)
+        return;
+    const int oldRow = rowForId(m_diffBaseId);
+    m_diffBaseId = snapshotId;
+    if (oldRow >= 0)
+        emit dataChanged(index(oldRow, 0), index(oldRow, 0));
+    const int newRow = rowForId(m_diffBaseId);
+    if (newRow >= 0)
+        emit dataChanged(index(newRow, 0), index(newRow, 0));
+}
+
+int ObjectSnapshotListModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 4;
+}
+
+int ObjectSnapshotListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_snapshots.size();
+}
+
+QVariant ObjectSnapshotListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Snapshot &snapshot = m_snapshots.at(index.row());
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+        {
+            const QString time = snapshot.timestamp.toString(QStringLiteral("hh:mm:ss.zzz"));
+            if (snapshot.id == m_diffBaseId)
+                return tr("%1 (diff base)").arg(time);
+            return time;
+        }
+        case 1:
+            return snapshot.objectCount;
+        case 2:
+            if (snapshot.data.isEmpty())
+                return tr("encoding...");
+            return tr("%1 kB").arg(snapshot.data.size() / 1024.0, 0, 'f', 1);
+        case 3:
+            return tr("%1 ms").arg(snapshot.captureTime / 1000.0, 0, 'f', 2);
+        }
+    } else if (role == ObjectSnapshotRoles::SnapshotIdRole) {
+        return snapshot.id;
+    }
+
+    return QVariant();
+}
+
+QVariant ObjectSnapshotListModel::headerData(int section, Qt::Orientation orientation,
+                                             int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case 0:
+            return tr("Snapshot");
+        case 1:
+            return tr("Objects");
+        case 2:
+            return tr("Size");
+        case 3:
+            return tr("Capture Time");
+        }
+    }
+    return QVariant();
+}
+
+int ObjectSnapshotListModel::rowForId(int snapshotId) const
+{
+    const auto it = std::lower_bound(m_snapshots.constBegin(), m_snapshots.constEnd(),
+                                     snapshotId, snapshotIdLessThan);
+    if (it == m_snapshots.constEnd() || (*it).id != snapshotId)
+        return -1;
+    return std::distance(m_snapshots.constBegin(), it);
+}
+
+void ObjectSnapshotListModel::removeExcessSnapshots()
+{
+    const int excess = m_snapshots.size() - m_maxSnapshots;
+    if (excess <= 0)
+        return;
+
+    QVector<int> removedIds;
+    removedIds.reserve(excess);
+    for (int i = 0; i < excess; ++i)
+        removedIds.push_back(m_snapshots.at(i).id);
+
+    beginRemoveRows(QModelIndex(), 0, excess - 1);
+    m_snapshots.remove(0, excess);
+    endRemoveRows();
+
+    foreach (int snapshotId, removedIds)
+        emit snapshotRemoved(snapshotId);
+}
@@ -0,0 +1,86 @@
+/*
+  objectsnapshotlistmodel.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTLISTMODEL_H
+#define GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+
+namespace GammaRay {
+
+/** Ring of the most recent object tree snapshots. */
+class ObjectSnapshotListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    struct Snapshot {
+        int id;
+        QDateTime timestamp;
+        qint64 captureTime; // in microseconds
+        int objectCount;
+        QByteArray data; // encoded ObjectSnapshotData, empty while still being encoded
+    };
+
+    explicit ObjectSnapshotListModel(QObject *parent = nullptr);
+    ~ObjectSnapshotListModel();
+
+    int maxSnapshots() const;
+    void setMaxSnapshots(int count);
+
+    /** Appends @p snapshot, dropping the oldest ones beyond maxSnapshots().
+     *  Snapshot ids have to be increasing.
+     */
+    void addSnapshot(const Snapshot &snapshot);
+    void setSnapshotData(int snapshotId, const QByteArray &data);
+    /** Returns the snapshot with id @p snapshotId, or nullptr if it has been dropped already. */
+    const Snapshot *snapshot(int snapshotId) const;
+
+    void setDiffBase(int snapshotId);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+signals:
+    void snapshotRemoved(int snapshotId);
+
+private:
+    int rowForId(int snapshotId) const;
+    void removeExcessSnapshots();
+
+    QVector<Snapshot> m_snapshots;
+    int m_maxSnapshots;
+    int m_diffBaseId;
+};
+}
+
+#endif // GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTLISTMODEL_H
@@ -0,0 +1,269 @@
+/*
+  objectsnapshotmodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsnapshotmodel.h"
+
+#include <core/util.h>
+#include <core/varianthandler.h>
+
+#include <QHash>
+
+using namespace GammaRay;
+
+static QString addressString(quint64 address)
+{
+    return Util::addressToString(reinterpret_cast<const void *>(static_cast<quintptr>(address)));
+}
+
+static QString valueString(const QVariant &value)
+{
+    if (!value.isValid())
+        return QStringLiteral("-");
+    return VariantHandler::displayString(value);
+}
+
+static QHash<QByteArray, QVariant> propertyValues(const ObjectSnapshotData &snapshot,
+                                                  const ObjectSnapshotData::Object &obj)
+{
+    QHash<QByteArray, QVariant> values;
+    foreach (const ObjectSnapshotData::PropertyValue &prop, obj.properties)
+        values.insert(snapshot.propertyNames.at(prop.propertyId), prop.value);
+    return values;
+}
+
+ObjectSnapshotModel::ObjectSnapshotModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+ObjectSnapshotModel::~ObjectSnapshotModel()
+{
+}
+
+void ObjectSnapshotModel::setSnapshot(const ObjectSnapshotData &snapshot,
+                                      const ObjectSnapshotData *base)
+{
+    beginResetModel();
+    m_snapshot = snapshot;
+    m_base = base ? *base : ObjectSnapshotData();
+    m_nodes.clear();
+    m_topLevelNodes.clear();
+    m_nodes.reserve(m_snapshot.objects.size());
+
+    // objects are identified by address and type, addresses alone get reused too often
+    QHash<quint64, int> baseIndexes;
+    baseIndexes.reserve(m_base.objects.size());
+    for (int i = 0; i < m_base.objects.size(); ++i)
+        baseIndexes.insert(m_base.objects.at(i).address, i);
+    QVector<int> baseNodes(m_base.objects.size(), -1);
+
+    for (int i = 0; i < m_snapshot.objects.size(); ++i) {
+        const ObjectSnapshotData::Object &obj = m_snapshot.objects.at(i);
+        Node node;
+        node.objectIndex = i;
+        node.parent = obj.parent;
+        node.row = -1;
+        node.state = ObjectSnapshotRoles::Unchanged;
+        if (base) {
+            const auto it = baseIndexes.constFind(obj.address);
+            if (it == baseIndexes.constEnd()
+                || m_base.classNames.at(m_base.objects.at(it.value()).classId)
+                != m_snapshot.classNames.at(obj.classId)) {
+                node.state = ObjectSnapshotRoles::Added;
+            } else {
+                baseNodes[it.value()] = i;
+                node.changes = compareObjects(it.value(), i);
+                if (!node.changes.isEmpty())
+                    node.state = ObjectSnapshotRoles::Changed;
+            }
+        }
+        m_nodes.push_back(node);
+    }
+
+    // base objects are in pre-order as well, so the node of a removed parent always exists already
+    for (int i = 0; i < m_base.objects.size(); ++i) {
+        if (baseNodes.at(i) >= 0)
+            continue;
+        const ObjectSnapshotData::Object &obj = m_base.objects.at(i);
+        Node node;
+        node.objectIndex = i;
+        node.parent = obj.parent < 0 ? -1 : baseNodes.at(obj.parent);
+        node.row = -1;
+        node.state = ObjectSnapshotRoles::Removed;
+        baseNodes[i] = m_nodes.size();
+        m_nodes.push_back(node);
+    }
+
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        const int parentNode = m_nodes.at(i).parent;
+        QVector<int> &siblings = parentNode < 0 ? m_topLevelNodes : m_nodes[parentNode].children;
+        m_nodes[i].row = siblings.size();
+        siblings.push_back(i);
+    }
+
+    endResetModel();
+}
+
+int ObjectSnapshotModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 4;
+}
+
+int ObjectSnapshotModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    if (!parent.isValid())
+        return m_topLevelNodes.size();
+    return m_nodes.at(static_cast<int>(parent.internalId())).children.size();
+}
+
+QModelIndex ObjectSnapshotModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const QVector<int> &siblings = parent.isValid()
+                                   ? m_nodes.at(static_cast<int>(parent.internalId())).children
+                                   : m_topLevelNodes;
+    if (row < 0 || column < 0 || row >= siblings.size() || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column, siblings.at(row));
+}
+
+QModelIndex ObjectSnapshotModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+    const int parentNode = m_nodes.at(static_cast<int>(child.internalId())).parent;
+    if (parentNode < 0)
+        return QModelIndex();
+    return createIndex(m_nodes.at(parentNode).row, 0, parentNode);
+}
+
+QVariant ObjectSnapshotModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Node &node = m_nodes.at(static_cast<int>(index.internalId()));
+    const ObjectSnapshotData &snapshot = snapshotForNode(node);
+    const ObjectSnapshotData::Object &obj = snapshot.objects.at(node.objectIndex);
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return obj.objectName.isEmpty() ? addressString(obj.address) : obj.objectName;
+        case 1:
+            return QString::fromUtf8(snapshot.classNames.at(obj.classId));
+        case 2:
+            switch (node.state) {
+            case ObjectSnapshotRoles::Added:
+                return tr("added");
+            case ObjectSnapshotRoles::Removed:
+                return tr("removed");
+            case ObjectSnapshotRoles::Changed:
+                return tr("changed");
+            case ObjectSnapshotRoles::Unchanged:
+                break;
+            }
+            return QString();
+        case 3:
+        {
+            QStringList values;
+            foreach (const ObjectSnapshotData::PropertyValue &prop, obj.properties) {
+                values.push_back(QStringLiteral("%1: %2").arg(
+                                     QString::fromUtf8(snapshot.propertyNames.at(prop.propertyId)),
+                                     valueString(prop.value)));
+            }
+            return values.join(QStringLiteral(", "));
+        }
+        }
+    } else if (role == Qt::ToolTipRole) {
+        QStringList lines;
+        lines.push_back(tr("Address: %1").arg(addressString(obj.address)));
+        lines += node.changes;
+        return lines.join(QStringLiteral("\n"));
+    } else if (role == ObjectSnapshotRoles::DiffStateRole) {
+        return node.state;
+    }
+
+    return QVariant();
+}
+
+QVariant ObjectSnapshotModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case 0:
+            return tr("Object");
+        case 1:
+            return tr("Type");
+        case 2:
+            return tr("Change");
+        case 3:
+            return tr("Properties");
+        }
+    }
+    return QVariant();
+}
+
+const ObjectSnapshotData &ObjectSnapshotModel::snapshotForNode(const Node &node) const
+{
+    return node.state == ObjectSnapshotRoles::Removed ? m_base : m_snapshot;
+}
+
+QStringList ObjectSnapshotModel::compareObjects(int baseIndex, int index) const
+{
+    const ObjectSnapshotData::Object &baseObj = m_base.objects.at(baseIndex);
+    const ObjectSnapshotData::Object &obj = m_snapshot.objects.at(index);
+    QStringList changes;
+
+    if (baseObj.objectName != obj.objectName)
+        changes.push_back(tr("objectName: \"%1\" -> \"%2\"").arg(baseObj.objectName, obj.objectName));
+
+    const quint64 baseParent = baseObj.parent < 0 ? 0 : m_base.objects.at(baseObj.parent).address;
+    const quint64 parent = obj.parent < 0 ? 0 : m_snapshot.objects.at(obj.parent).address;
+    if (baseParent != parent)
+        changes.push_back(tr("parent: %1 -> %2").arg(addressString(baseParent), addressString(parent)));
+
+    const QHash<QByteArray, QVariant> baseValues = propertyValues(m_base, baseObj);
+    const QHash<QByteArray, QVariant> values = propertyValues(m_snapshot, obj);
+    QVector<QByteArray> names = m_snapshot.propertyNames;
+    foreach (const QByteArray &name, m_base.propertyNames) {
+        if (!names.contains(name))
+            names.push_back(name);
+    }
+    foreach (const QByteArray &name, names) {
+        const QVariant baseValue = baseValues.value(name);
+        const QVariant value = values.value(name);
+        if (baseValue == value)
+            continue;
+        changes.push_back(tr("%1: %2 -> %3").arg(QString::fromUtf8(name), valueString(baseValue),
+                                                 valueString(value)));
+    }
+
+    return changes;
+}
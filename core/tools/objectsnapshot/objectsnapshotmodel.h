@@ -0,0 +1,83 @@
+/*
+  objectsnapshotmodel.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTMODEL_H
+#define GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTMODEL_H
+
+#include "objectsnapshotdata.h"
+
+#include <common/tools/objectsnapshot/objectsnapshotroles.h>
+
+#include <QAbstractItemModel>
+#include <QStringList>
+
+namespace GammaRay {
+
+/** Object tree of one snapshot, optionally compared against an older or newer one.
+ *  Objects only present in the diff base are shown as removed, below their former parent.
+ */
+class ObjectSnapshotModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    explicit ObjectSnapshotModel(QObject *parent = nullptr);
+    ~ObjectSnapshotModel();
+
+    /** Shows @p snapshot, compared against @p base if that is not nullptr. */
+    void setSnapshot(const ObjectSnapshotData &snapshot, const ObjectSnapshotData *base = nullptr);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QModelIndex index(int row, int column,
+                      const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QModelIndex parent(const QModelIndex &child) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+private:
+    struct Node {
+        int objectIndex; // in m_snapshot, or in m_base for removed objects
+        int parent; // node index, -1 for top-level nodes
+        int row;
+        ObjectSnapshotRoles::DiffState state;
+        QVector<int> children;
+        QStringList changes;
+    };
+
+    const ObjectSnapshotData &snapshotForNode(const Node &node) const;
+    QStringList compareObjects(int baseIndex, int index) const;
+
+    ObjectSnapshotData m_snapshot;
+    ObjectSnapshotData m_base;
+    // nodes of m_snapshot have the same index as their object, removed ones follow after that
+    QVector<Node> m_nodes;
+    QVector<int> m_topLevelNodes;
+};
+}
+
+#endif // GAMMARAY_OBJECTSNAPSHOT_OBJECTSNAPSHOTMODEL_H
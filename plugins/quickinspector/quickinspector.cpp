@@ -30,6 +30,7 @@
 #include "quickitemmodel.h"
 #include "quickscenegraphmodel.h"
 #include "quickpaintanalyzerextension.h"
+#include "quickwindowreadback.h"
 #include "geometryextension/sggeometryextension.h"
 #include "materialextension/materialextension.h"
 
@@ -75,6 +76,7 @@
 
 #include <private/qquickanchors_p.h>
 #include <private/qquickitem_p.h>
+#include <private/qquickwindow_p.h>
 #include <private/qsgbatchrenderer_p.h>
 
 Q_DECLARE_METATYPE(QQmlError)
@@ -243,8 +245,12 @@ QuickInspector::QuickInspector(ProbeInterface *probe, QObject *parent)
     , m_sgPropertyController(new PropertyController(QStringLiteral(
                                                         "com.kdab.GammaRay.QuickSceneGraph"), this))
     , m_remoteView(new RemoteViewServer(QStringLiteral("com.kdab.GammaRay.QuickRemoteView"), this))
+    , m_readback(nullptr)
     , m_isGrabbingWindow(false)
 {
+    m_pendingDamage.everything = false;
+    m_pendingDamage.unknown = false;
+
     registerPCExtensions();
     registerMetaTypes();
     registerVariantHandlers();
@@ -315,6 +321,16 @@ void QuickInspector::selectWindow(QQuickWindow *window)
     if (m_window) {
         disconnect(m_window, nullptr, this, nullptr);
     }
+    // a read back still in flight for the previous window is not going to be delivered
+    delete m_readback;
+    m_readback = nullptr;
+    m_isGrabbingWindow = false;
+    {
+        QMutexLocker lock(&m_pendingDamage.mutex);
+        m_pendingDamage.region = QRegion();
+        m_pendingDamage.everything = false;
+        m_pendingDamage.unknown = false;
+    }
 
     m_window = window;
     m_itemModel->setWindow(window);
@@ -326,10 +342,19 @@ void QuickInspector::selectWindow(QQuickWindow *window)
         // make sure we have selected something for the property editor to not be entirely empty
         selectItem(m_window->contentItem());
 
+        // dirty items are only known until the scene graph has been synchronized with them
+        connect(window, &QQuickWindow::beforeSynchronizing, this, [this, window]() {
+            collectDirtyItems(window);
+        }, Qt::DirectConnection);
         // frame swapped isn't enough, we don't get that for FBO render targets such as in QQuickWidget
         connect(window, &QQuickWindow::afterRendering, this, &QuickInspector::slotSceneChanged);
         connect(window, &QQuickWindow::frameSwapped, this, &QuickInspector::slotSceneChanged);
 
+        // connected after the above, so scene changes caused by the read back itself are seen first
+        m_readback = new QuickWindowReadback(window, this);
+        connect(m_readback, &QuickWindowReadback::imageReady, this,
+                &QuickInspector::slotReadbackReady, Qt::QueuedConnection);
+
         m_window->update();
     }
 }
@@ -473,12 +498,72 @@ void QuickInspector::sendRenderedScene(const QImage &currentFrame)
                        | itemGeometry.boundingRect);
     frame.setData(QVariant::fromValue(itemGeometry));
     m_remoteView->sendFrame(frame);
+
+    // report what changed while we were grabbing
+    slotSceneChanged();
+}
+
+// items used as source for a ShaderEffectSource show up elsewhere in the scene as well
+static bool isEffectSource(QQuickItem *item)
+{
+    for (; item; item = item->parentItem()) {
+        const QQuickItemPrivate *itemPriv = QQuickItemPrivate::get(item);
+        if (itemPriv->extra.isAllocated() && itemPriv->extra->effectRefCount > 0)
+            return true;
+    }
+    return false;
+}
+
+void QuickInspector::collectDirtyItems(QQuickWindow *window)
+{
+    // called from the render thread, with the GUI thread blocked while synchronizing
+    QQuickWindowPrivate *winPriv = QQuickWindowPrivate::get(window);
+    QRegion region;
+    bool everything = false;
+    for (QQuickItem *item = winPriv->dirtyItemList; item;
+         item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        const QQuickItemPrivate *itemPriv = QQuickItemPrivate::get(item);
+        // anything but a content change can move the item or its children, and we
+        // neither know where they were before nor want to walk the sub-tree here
+        if ((itemPriv->dirtyAttributes & ~QQuickItemPrivate::Content) || isEffectSource(item)) {
+            everything = true;
+            break;
+        }
+        region += item->mapRectToScene(item->boundingRect()).toAlignedRect();
+    }
+
+    QMutexLocker lock(&m_pendingDamage.mutex);
+    if (!winPriv->dirtyItemList)
+        m_pendingDamage.unknown = true;
+    else if (everything)
+        m_pendingDamage.everything = true;
+    else
+        m_pendingDamage.region += region;
 }
 
 void QuickInspector::slotSceneChanged()
 {
-    if (!m_isGrabbingWindow)
+    QRegion region;
+    bool everything;
+    {
+        QMutexLocker lock(&m_pendingDamage.mutex);
+        if (m_isGrabbingWindow) {
+            // frames without item changes are most likely caused by grabbing itself, the
+            // other changes are reported once the grab is done
+            m_pendingDamage.unknown = false;
+            return;
+        }
+        region = m_pendingDamage.region;
+        everything = m_pendingDamage.everything || m_pendingDamage.unknown;
+        m_pendingDamage.region = QRegion();
+        m_pendingDamage.everything = false;
+        m_pendingDamage.unknown = false;
+    }
+
+    if (everything)
         m_remoteView->sourceChanged();
+    else
+        m_remoteView->addDirtyRegion(region);
 }
 
 void QuickInspector::slotGrabWindow()
@@ -493,6 +578,30 @@ void QuickInspector::slotGrabWindow()
             return;
     }
 
+    // read back asynchronously on the render thread where possible, grabWindow() blocks both threads
+    if (QuickWindowReadback::isSupported(m_window) && m_readback->requestImage())
+        return;
+
+    grabWindowSynchronously();
+}
+
+void QuickInspector::slotReadbackReady(const QImage &image)
+{
+    if (!m_isGrabbingWindow || !m_window)
+        return;
+
+    // read back failed or got interrupted by the scene graph being invalidated
+    if (image.isNull()) {
+        grabWindowSynchronously();
+        return;
+    }
+    // the frameSwapped() signal of the frame that delivered this is still queued, delay
+    // sending for the same reason as in grabWindowSynchronously()
+    QMetaObject::invokeMethod(this, "sendRenderedScene", Qt::QueuedConnection, Q_ARG(QImage, image));
+}
+
+void QuickInspector::grabWindowSynchronously()
+{
     // delay this so we can process the signals to slotSceneChanged first, while we are in the m_isGrabbingWindow state
     // otherwise we end up with an infinite update loop even on static scenes
     auto img = m_window->grabWindow();
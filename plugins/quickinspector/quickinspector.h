@@ -37,6 +37,7 @@
 #include <QQuickWindow>
 #include <QImage>
 #include <QMutex>
+#include <QRegion>
 
 QT_BEGIN_NAMESPACE
 class QQuickShaderEffectSource;
@@ -56,6 +57,7 @@ namespace GammaRay {
 class PropertyController;
 class QuickItemModel;
 class QuickSceneGraphModel;
+class QuickWindowReadback;
 class RemoteViewServer;
 class ObjectId;
 typedef QVector<ObjectId> ObjectIds;
@@ -98,6 +100,7 @@ protected:
 private slots:
     void slotSceneChanged();
     void slotGrabWindow();
+    void slotReadbackReady(const QImage &image);
     void itemSelectionChanged(const QItemSelection &selection);
     void sgSelectionChanged(const QItemSelection &selection);
     void sgNodeDeleted(QSGNode *node);
@@ -114,6 +117,8 @@ private:
     void registerPCExtensions();
     QString findSGNodeType(QSGNode *node) const;
     void applyRenderMode();
+    void collectDirtyItems(QQuickWindow *window);
+    void grabWindowSynchronously();
 
     GammaRay::ObjectIds recursiveItemsAt(QQuickItem *parent, const QPointF &pos,
                                          GammaRay::RemoteViewInterface::RequestMode mode, int& bestCandidate) const;
@@ -130,6 +135,7 @@ private:
     PropertyController *m_itemPropertyController;
     PropertyController *m_sgPropertyController;
     RemoteViewServer *m_remoteView;
+    QuickWindowReadback *m_readback;
     QImage m_currentFrame;
     QVector<GrabWindowCallback> m_grabWindowCallbacks;
     bool m_isGrabbingWindow;
@@ -139,6 +145,13 @@ private:
         QQuickWindow *window;
         QMutex mutex;
     } m_pendingRenderMode;
+    // scene changes collected during scene graph synchronization, see collectDirtyItems()
+    struct {
+        QRegion region;
+        bool everything; // geometry changes we can't locate
+        bool unknown;    // a frame without any item changes, e.g. due to QQuickWindow::update()
+        QMutex mutex;
+    } m_pendingDamage;
 };
 
 class QuickInspectorFactory : public QObject,
@@ -0,0 +1,298 @@
+/*
+  quickwindowreadback.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "quickwindowreadback.h"
+
+#include <QMutex>
+#include <QQuickWindow>
+#include <QRunnable>
+#include <QVector>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#endif
+
+#include <cstring>
+
+using namespace GammaRay;
+
+// one buffer can be filled while the one of the previous frame is mapped
+static const int RingSize = 2;
+
+struct QuickWindowReadback::State
+{
+    State()
+        : receiver(nullptr)
+        , requested(false)
+        , requestRatio(1.0)
+        , failed(false)
+        , nextBuffer(0)
+        , pendingBuffer(-1)
+        , pendingRatio(1.0)
+    {
+    }
+
+    void afterRendering(QQuickWindow *window);
+    void invalidate();
+    void deliver(const QImage &image);
+    void setFailed();
+
+    // shared with the GUI thread, protected by mutex
+    QMutex mutex;
+    QuickWindowReadback *receiver;
+    bool requested;
+    QSize requestSize;
+    qreal requestRatio;
+    bool failed;
+
+    // only accessed from the render thread
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    QVector<QOpenGLBuffer> buffers;
+    QVector<int> bufferSizes;
+#endif
+    int nextBuffer;
+    int pendingBuffer;
+    QSize pendingSize;
+    qreal pendingRatio;
+};
+
+void QuickWindowReadback::State::deliver(const QImage &image)
+{
+    QMutexLocker lock(&mutex);
+    if (receiver)
+        emit receiver->imageReady(image);
+}
+
+void QuickWindowReadback::State::setFailed()
+{
+    QMutexLocker lock(&mutex);
+    failed = true;
+}
+
+void QuickWindowReadback::State::afterRendering(QQuickWindow *window)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context)
+        return;
+
+    // the transfer started in the previous frame has completed by now, so mapping does not stall
+    if (pendingBuffer >= 0) {
+        QOpenGLBuffer &buffer = buffers[pendingBuffer];
+        pendingBuffer = -1;
+        const int bytesPerLine = pendingSize.width() * 4;
+        QImage image;
+        buffer.bind();
+        const auto data = static_cast<const uchar *>(buffer.mapRange(0, bytesPerLine * pendingSize.height(),
+                                                                     QOpenGLBuffer::RangeRead));
+        if (data) {
+            // OpenGL has the origin in the bottom left corner, flip while copying out of the buffer
+            image = QImage(pendingSize, QImage::Format_RGBA8888_Premultiplied);
+            for (int y = 0; y < pendingSize.height(); ++y)
+                memcpy(image.scanLine(pendingSize.height() - y - 1), data + y * bytesPerLine, bytesPerLine);
+            buffer.unmap();
+            image.setDevicePixelRatio(pendingRatio);
+        } else {
+            setFailed();
+        }
+        buffer.release();
+        deliver(image);
+    }
+
+    QSize size;
+    qreal ratio;
+    {
+        QMutexLocker lock(&mutex);
+        if (!requested || failed)
+            return;
+        requested = false;
+        size = requestSize;
+        ratio = requestRatio;
+    }
+
+    if (buffers.isEmpty()) {
+        for (int i = 0; i < RingSize; ++i)
+            buffers.push_back(QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer));
+        bufferSizes.fill(0, RingSize);
+    }
+
+    const int index = nextBuffer;
+    QOpenGLBuffer &buffer = buffers[index];
+    if (size.isEmpty() || (!buffer.isCreated() && !buffer.create())) {
+        setFailed();
+        deliver(QImage());
+        return;
+    }
+    nextBuffer = (nextBuffer + 1) % RingSize;
+
+    buffer.bind();
+    const int byteCount = size.width() * size.height() * 4;
+    if (bufferSizes.at(index) != byteCount) {
+        buffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+        buffer.allocate(byteCount);
+        bufferSizes[index] = byteCount;
+    }
+    // with a pixel pack buffer bound this only queues the transfer, rather than waiting for it
+    context->functions()->glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE,
+                                       nullptr);
+    buffer.release();
+
+    pendingBuffer = index;
+    pendingSize = size;
+    pendingRatio = ratio;
+
+    // static scenes would otherwise not render the frame picking this up
+    QMetaObject::invokeMethod(window, "update", Qt::QueuedConnection);
+#else
+    Q_UNUSED(window);
+#endif
+}
+
+void QuickWindowReadback::State::invalidate()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    for (auto it = buffers.begin(); it != buffers.end(); ++it)
+        it->destroy();
+    buffers.clear();
+    bufferSizes.clear();
+#endif
+    nextBuffer = 0;
+
+    bool interrupted = pendingBuffer >= 0;
+    pendingBuffer = -1;
+    {
+        QMutexLocker lock(&mutex);
+        interrupted = interrupted || requested;
+        requested = false;
+    }
+    if (interrupted)
+        deliver(QImage());
+}
+
+QuickWindowReadback::QuickWindowReadback(QQuickWindow *window, QObject *parent)
+    : QObject(parent)
+    , m_window(window)
+    , m_state(new State)
+{
+    m_state->receiver = this;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    // both signals are emitted on the render thread, the lambdas keep the state alive
+    // while they run, even if we are destroyed on the GUI thread in the meantime
+    const QSharedPointer<State> state = m_state;
+    m_afterRenderingConnection = connect(window, &QQuickWindow::afterRendering, [state, window]() {
+        state->afterRendering(window);
+    });
+    m_invalidatedConnection = connect(window, &QQuickWindow::sceneGraphInvalidated, [state]() {
+        state->invalidate();
+    });
+#endif
+}
+
+QuickWindowReadback::~QuickWindowReadback()
+{
+    disconnect(m_afterRenderingConnection);
+    disconnect(m_invalidatedConnection);
+    {
+        QMutexLocker lock(&m_state->mutex);
+        m_state->receiver = nullptr;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    class CleanupJob : public QRunnable
+    {
+    public:
+        explicit CleanupJob(const QSharedPointer<State> &state)
+            : m_state(state)
+        {
+        }
+
+        void run() Q_DECL_OVERRIDE
+        {
+            m_state->invalidate();
+        }
+
+    private:
+        QSharedPointer<State> m_state;
+    };
+
+    // buffers can only be released on the render thread, if the window is gone so is its context
+    if (m_window) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+        m_window->scheduleRenderJob(new CleanupJob(m_state), QQuickWindow::NoStage);
+#else
+        m_window->scheduleRenderJob(new CleanupJob(m_state), QQuickWindow::AfterSwapStage);
+#endif
+    }
+#endif
+}
+
+bool QuickWindowReadback::isSupported(QQuickWindow *window)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    // custom FBO render targets, e.g. QQuickWidget, are handled by grab window callbacks
+    if (!window || window->renderTarget())
+        return false;
+
+    // null for the software backend, and before the scene graph is initialized
+    const QOpenGLContext *context = window->openglContext();
+    if (!context)
+        return false;
+
+    // mapping buffers for reading needs OpenGL (ES) 3.0
+    return context->format().majorVersion() >= 3;
+#else
+    Q_UNUSED(window);
+    return false;
+#endif
+}
+
+bool QuickWindowReadback::requestImage()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    if (!m_window)
+        return false;
+
+    {
+        QMutexLocker lock(&m_state->mutex);
+        if (m_state->failed)
+            return false;
+        const qreal ratio = m_window->effectiveDevicePixelRatio();
+        m_state->requested = true;
+        m_state->requestSize = m_window->size() * ratio;
+        m_state->requestRatio = ratio;
+    }
+
+    m_window->update();
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,76 @@
+/*
+  quickwindowreadback.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef GAMMARAY_QUICKINSPECTOR_QUICKWINDOWREADBACK_H
+#define GAMMARAY_QUICKINSPECTOR_QUICKWINDOWREADBACK_H
+
+#include <QImage>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+
+QT_BEGIN_NAMESPACE
+class QQuickWindow;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/** Asynchronous read back of the content rendered into a QQuickWindow.
+ *  Pixels are read into a ring of pixel buffer objects on the render thread after a frame
+ *  has been rendered and are mapped when the next frame is done, so neither the render
+ *  nor the GUI thread waits for the GPU. Only available for the OpenGL scene graph backend
+ *  rendering directly into the window, use QQuickWindow::grabWindow() otherwise.
+ */
+class QuickWindowReadback : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QuickWindowReadback(QQuickWindow *window, QObject *parent = nullptr);
+    ~QuickWindowReadback();
+
+    /** Returns @c true if asynchronous read back can be used with @p window. */
+    static bool isSupported(QQuickWindow *window);
+
+    /** Request the content of the next frame, delivered via imageReady().
+     *  Returns @c false if that is not possible, e.g. because reading back previously failed.
+     */
+    bool requestImage();
+
+signals:
+    /** Emitted from the render thread, a null image indicates the read back failed. */
+    void imageReady(const QImage &image);
+
+private:
+    struct State;
+    QPointer<QQuickWindow> m_window;
+    QSharedPointer<State> m_state;
+    QMetaObject::Connection m_afterRenderingConnection;
+    QMetaObject::Connection m_invalidatedConnection;
+};
+}
+
+#endif // GAMMARAY_QUICKINSPECTOR_QUICKWINDOWREADBACK_H
@@ -129,6 +129,7 @@ void SceneInspector::sceneSelected(const QItemSelection &selection)
         disconnect(m_sceneModel->scene(), nullptr, this, nullptr);
 
     m_sceneModel->setScene(scene);
+    m_renderedArea = QRectF();
     connectToScene();
     // TODO remote support when a different graphics scene was selected
 // ui->graphicsSceneView->setGraphicsScene(scene);
@@ -143,7 +144,7 @@ void SceneInspector::connectToScene()
     connect(scene, SIGNAL(sceneRectChanged(QRectF)),
             this, SIGNAL(sceneRectChanged(QRectF)));
     connect(scene, SIGNAL(changed(QList<QRectF>)),
-            this, SIGNAL(sceneChanged()));
+            this, SLOT(sceneContentChanged(QList<QRectF>)));
 
     initializeGui();
 }
@@ -168,6 +169,23 @@ void SceneInspector::clientConnectedChanged(bool clientConnected)
     connectToScene();
 }
 
+void SceneInspector::sceneContentChanged(const QList<QRectF> &region)
+{
+    // an empty region means everything changed, otherwise only bother the client
+    // if something in the area it shows changed
+    if (region.isEmpty() || !m_renderedArea.isValid()) {
+        emit sceneChanged();
+        return;
+    }
+
+    foreach (const QRectF &rect, region) {
+        if (rect.intersects(m_renderedArea)) {
+            emit sceneChanged();
+            return;
+        }
+    }
+}
+
 void SceneInspector::renderScene(const QTransform &transform, const QSize &size)
 {
     if (!Endpoint::isConnected()) {
@@ -193,6 +211,7 @@ void SceneInspector::renderScene(const QTransform &transform, const QSize &size)
     area = transform.inverted().mapRect(area);
 
     scene->render(&painter, area, area, Qt::IgnoreAspectRatio);
+    m_renderedArea = area;
 
     QGraphicsItem *currentItem
         = m_itemSelectionModel->currentIndex().data(SceneModel::SceneItemRole).value<QGraphicsItem *>();
@@ -64,6 +64,7 @@ private slots:
     void sceneClicked(const QPointF &pos) Q_DECL_OVERRIDE;
 
     void clientConnectedChanged(bool clientConnected);
+    void sceneContentChanged(const QList<QRectF> &region);
 
 private:
     QString findBestType(QGraphicsItem *item);
@@ -75,6 +76,8 @@ private:
     SceneModel *m_sceneModel;
     QItemSelectionModel *m_itemSelectionModel;
     PropertyController *m_propertyController;
+    // scene area shown by the client, as of the last renderScene() call
+    QRectF m_renderedArea;
     bool m_clientConnected;
 };
 
@@ -0,0 +1,165 @@
+/*
+  signaleventstore.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "signaleventstore.h"
+
+using namespace GammaRay;
+
+static void appendVarint(QByteArray &data, quint64 value)
+{
+    while (value >= 0x80) {
+        data.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+static quint64 readVarint(const char *&it)
+{
+    quint64 value = 0;
+    int shift = 0;
+    uchar b;
+    do {
+        b = static_cast<uchar>(*it++);
+        value |= static_cast<quint64>(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return value;
+}
+
+SignalEventStore::SignalEventStore()
+    : m_size(0)
+{
+}
+
+qint64 SignalEventStore::lastTimestamp() const
+{
+    if (m_chunks.isEmpty())
+        return -1;
+    return m_chunks.last().lastTimestamp;
+}
+
+bool SignalEventStore::append(qint64 timestamp, int signalIndex)
+{
+    bool newChunk = false;
+    if (m_chunks.isEmpty() || m_chunks.last().signalIndexes.size() >= ChunkSize) {
+        Chunk chunk;
+        chunk.firstTimestamp = qMax(timestamp, lastTimestamp());
+        chunk.lastTimestamp = chunk.firstTimestamp;
+        chunk.signalIndexes.reserve(16);
+        m_chunks.push_back(chunk);
+        newChunk = true;
+    }
+
+    Chunk &chunk = m_chunks.last();
+    // events from different threads can be slightly out of order, don't go back in time
+    timestamp = qMax(timestamp, chunk.lastTimestamp);
+    appendVarint(chunk.timeDeltas, timestamp - chunk.lastTimestamp);
+    chunk.signalIndexes.push_back(signalIndex);
+    chunk.lastTimestamp = timestamp;
+    ++m_size;
+    return newChunk;
+}
+
+template<typename Func>
+void SignalEventStore::forEachEvent(qint64 from, qint64 to, Func func) const
+{
+    foreach (const Chunk &chunk, m_chunks) {
+        if (chunk.lastTimestamp < from)
+            continue;
+        if (chunk.firstTimestamp >= to)
+            break;
+        if (!forEachChunkEvent(chunk, from, to, func))
+            break;
+    }
+}
+
+template<typename Func>
+bool SignalEventStore::forEachChunkEvent(const Chunk &chunk, qint64 from, qint64 to, Func func)
+{
+    const char *it = chunk.timeDeltas.constData();
+    qint64 timestamp = chunk.firstTimestamp;
+    for (int i = 0; i < chunk.signalIndexes.size(); ++i) {
+        timestamp += readVarint(it);
+        if (timestamp >= to)
+            return false;
+        if (timestamp >= from)
+            func(timestamp, chunk.signalIndexes.at(i));
+    }
+    return true;
+}
+
+int SignalEventStore::count(qint64 from, qint64 to) const
+{
+    int result = 0;
+    foreach (const Chunk &chunk, m_chunks) {
+        if (chunk.lastTimestamp < from)
+            continue;
+        if (chunk.firstTimestamp >= to)
+            break;
+        // fully contained chunks don't need to be decoded
+        if (chunk.firstTimestamp >= from && chunk.lastTimestamp < to)
+            result += chunk.signalIndexes.size();
+        else
+            forEachChunkEvent(chunk, from, to, [&result](qint64, int) { ++result; });
+    }
+    return result;
+}
+
+QVector<qint64> SignalEventStore::events(qint64 from, qint64 to) const
+{
+    QVector<qint64> result;
+    forEachEvent(from, to, [&result](qint64 timestamp, int signalIndex) {
+        result.push_back(packEvent(timestamp, signalIndex));
+    });
+    return result;
+}
+
+QVector<qint64> SignalEventStore::density(qint64 from, qint64 to, int buckets) const
+{
+    QVector<qint64> result;
+    if (buckets <= 0 || to <= from)
+        return result;
+
+    result.resize(buckets);
+    const qint64 interval = to - from;
+    forEachEvent(from, to, [&](qint64 timestamp, int) {
+        ++result[(timestamp - from) * buckets / interval];
+    });
+    return result;
+}
+
+int SignalEventStore::evictOldestChunk()
+{
+    if (m_chunks.isEmpty())
+        return 0;
+
+    const int count = m_chunks.first().signalIndexes.size();
+    m_chunks.remove(0);
+    m_size -= count;
+    return count;
+}
@@ -0,0 +1,100 @@
+/*
+  signaleventstore.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SIGNALEVENTSTORE_H
+#define GAMMARAY_SIGNALEVENTSTORE_H
+
+#include <QByteArray>
+#include <QVector>
+
+namespace GammaRay {
+/** Signal emissions of a single object, stored in a compact columnar form.
+ *
+ *  Events are grouped into chunks of at most ChunkSize entries. Within a chunk
+ *  timestamps (in microseconds) are stored as variable-length encoded deltas to
+ *  their predecessor, and the signal indexes are kept in a separate column.
+ *  Old chunks can be dropped individually to bound the memory usage.
+ */
+class SignalEventStore
+{
+public:
+    enum {
+        ChunkSize = 4096
+    };
+
+    SignalEventStore();
+
+    bool isEmpty() const { return m_size == 0; }
+    /** Number of stored events. */
+    int size() const { return m_size; }
+    /** Timestamp of the most recent event, -1 if there is none. */
+    qint64 lastTimestamp() const;
+
+    /** Adds an event at @p timestamp (in microseconds), timestamps must not decrease.
+     *  Returns @c true if this started a new chunk.
+     */
+    bool append(qint64 timestamp, int signalIndex);
+
+    /** Number of events in the time range [@p from, @p to). */
+    int count(qint64 from, qint64 to) const;
+    /** Events in the time range [@p from, @p to), packed as in SignalHistoryModel::EventsRole. */
+    QVector<qint64> events(qint64 from, qint64 to) const;
+    /** Number of events in each of @p buckets equally sized parts of the time range [@p from, @p to). */
+    QVector<qint64> density(qint64 from, qint64 to, int buckets) const;
+
+    /** Drops the oldest chunk, returns the number of events removed with it. */
+    int evictOldestChunk();
+
+    static qint64 packEvent(qint64 timestamp, int signalIndex) { return (timestamp << 16) | signalIndex; }
+
+private:
+    struct Chunk
+    {
+        Chunk()
+            : firstTimestamp(0)
+            , lastTimestamp(0)
+        {
+        }
+
+        qint64 firstTimestamp;
+        qint64 lastTimestamp;
+        QByteArray timeDeltas;
+        QVector<quint16> signalIndexes;
+    };
+
+    template<typename Func>
+    void forEachEvent(qint64 from, qint64 to, Func func) const;
+    /** Returns @c false if the end of the range has been reached. */
+    template<typename Func>
+    static bool forEachChunkEvent(const Chunk &chunk, qint64 from, qint64 to, Func func);
+
+    QVector<Chunk> m_chunks;
+    int m_size;
+};
+}
+
+#endif // GAMMARAY_SIGNALEVENTSTORE_H
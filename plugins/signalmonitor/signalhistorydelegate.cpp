@@ -88,12 +88,42 @@ void SignalHistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem
     if (t1 >= 0)
         painter->fillRect(x1, y0 + 1, x2, dy - 2, option.palette.window());
 
+    // event timestamps are in microseconds
+    const qint64 startTimeUs = startTime * 1000;
+    const qint64 endTimeUs = endTime * 1000;
+    const qint64 intervalUs = interval * 1000;
+
+    const QVector<qint64> &density
+        = model->data(index, SignalHistoryModel::EventDensityRole).value<QVector<qint64> >();
+    if (density.size() > 2) {
+        const qint64 bucketWidth = density.at(1);
+        qint64 maxCount = 1;
+        for (int i = 2; i < density.size(); ++i)
+            maxCount = qMax(maxCount, density.at(i));
+
+        QColor color = option.palette.color(QPalette::WindowText);
+        for (int i = 2; i < density.size(); ++i) {
+            const qint64 count = density.at(i);
+            if (count == 0)
+                continue;
+            const qint64 bucketStart = density.at(0) + (i - 2) * bucketWidth;
+            const int xa = qMax<qint64>(x0, x0 + dx * (bucketStart - startTimeUs) / intervalUs);
+            const int xb = qMin<qint64>(x0 + dx,
+                                        x0 + dx * (bucketStart + bucketWidth - startTimeUs) / intervalUs);
+            if (xb < xa)
+                continue;
+            color.setAlphaF(0.25 + 0.75 * count / maxCount);
+            painter->fillRect(xa, y0 + 1, qMax(1, xb - xa), dy - 2, color);
+        }
+        return;
+    }
+
     painter->setPen(option.palette.color(QPalette::WindowText));
 
     foreach (qint64 ev, events) {
         const qint64 ts = SignalHistoryModel::timestamp(ev);
-        if (ts >= startTime && ts < endTime) {
-            const int x = x0 + dx * (ts - startTime) / interval;
+        if (ts >= startTimeUs && ts < endTimeUs) {
+            const int x = x0 + dx * (ts - startTimeUs) / intervalUs;
             painter->drawLine(x, y0 + 1, x, y0 + dy - 2);
         }
     }
@@ -158,17 +188,30 @@ QString SignalHistoryDelegate::toolTipAt(const QModelIndex &index, int position,
     const QVector<qint64> &events
         = model->data(index, SignalHistoryModel::EventsRole).value<QVector<qint64> >();
 
-    const qint64 t = m_visibleInterval * position / width + m_visibleOffset;
+    // in microseconds, like the event timestamps
+    const qint64 t = m_visibleInterval * 1000 * position / width + m_visibleOffset * 1000;
+
+    const QVector<qint64> &density
+        = model->data(index, SignalHistoryModel::EventDensityRole).value<QVector<qint64> >();
+    if (density.size() > 2) {
+        const int bucket = (t - density.at(0)) / density.at(1) + 2;
+        if (t < density.at(0) || bucket >= density.size() || density.at(bucket) == 0)
+            return QString();
+        const QString &ts = QLocale().toString((density.at(0) + (bucket - 2) * density.at(1)) / 1000);
+        return tr("%n signal(s) around %1 ms", nullptr, density.at(bucket)).arg(ts);
+    }
+
     qint64 dtMin = std::numeric_limits<qint64>::max();
     int signalIndex = -1;
     qint64 signalTimestamp = -1;
 
     for (int i = 0; i < events.size(); ++i) {
-        signalTimestamp = SignalHistoryModel::timestamp(events.at(i));
-        const qint64 dt = qAbs(signalTimestamp - t);
+        const qint64 timestamp = SignalHistoryModel::timestamp(events.at(i));
+        const qint64 dt = qAbs(timestamp - t);
 
         if (dt < dtMin) {
             signalIndex = SignalHistoryModel::signalIndex(events.at(i));
+            signalTimestamp = timestamp;
             dtMin = dt;
         }
     }
@@ -186,6 +229,6 @@ QString SignalHistoryDelegate::toolTipAt(const QModelIndex &index, int position,
     else
         signalName = it.value();
 
-    const QString &ts = QLocale().toString(signalTimestamp);
+    const QString &ts = QLocale().toString(signalTimestamp / 1000.0, 'f', 3);
     return tr("%1 at %2 ms").arg(signalName, ts);
 }
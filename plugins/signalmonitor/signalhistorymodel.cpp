@@ -33,14 +33,19 @@
 #include <core/probeinterface.h>
 #include <core/util.h>
 #include <core/probe.h>
+#include <core/signalindexcache.h>
 
 #include <common/objectid.h>
+#include <common/remotemodelroles.h>
 
 #include <QLocale>
 #include <QMutex>
 #include <QSet>
 #include <QThread>
 
+#include <algorithm>
+#include <limits>
+
 using namespace GammaRay;
 
 /// Tries to reuse an already existing instances of \param str by checking
@@ -65,30 +70,28 @@ static T internString(const T &str)
 
 static SignalHistoryModel *s_historyModel = nullptr;
 
-static void signal_begin_callback(QObject *caller, int method_index, void **argv)
+static void signal_event_callback(const QVector<SignalEvent> &events)
 {
-    Q_UNUSED(argv);
-    if (s_historyModel) {
-        const int signalIndex = method_index + 1; // offset 1, so unknown signals end up at 0
-        static const QMetaMethod m = s_historyModel->metaObject()->method(
-            s_historyModel->metaObject()->indexOfMethod("onSignalEmitted(QObject*,int)"));
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-        Q_ASSERT(m.isValid());
-#endif
-        m.invoke(s_historyModel, Qt::AutoConnection, Q_ARG(QObject *, caller),
-                 Q_ARG(int, signalIndex));
-    }
+    if (s_historyModel)
+        s_historyModel->onSignalEvents(events);
 }
 
 SignalHistoryModel::SignalHistoryModel(ProbeInterface *probe, QObject *parent)
     : QAbstractTableModel(parent)
+    , m_eventCount(0)
+    , m_maxEventCount(4 * 1024 * 1024)
+    , m_clockOffset(RelativeClock::sinceAppStart()->mSecs() * 1000
+                    - SignalEvent::currentTimestamp() / 1000)
+    , m_windowStart(0)
+    , m_windowEnd(0)
+    , m_windowBuckets(0)
 {
     connect(probe->probe(), SIGNAL(objectCreated(QObject*)), this, SLOT(onObjectAdded(QObject*)));
     connect(probe->probe(), SIGNAL(objectDestroyed(QObject*)), this,
             SLOT(onObjectRemoved(QObject*)));
 
     SignalSpyCallbackSet spy;
-    spy.signalBeginCallback = signal_begin_callback;
+    spy.signalEventCallback = signal_event_callback;
     probe->registerSignalSpyCallbackSet(spy);
 
     s_historyModel = this;
@@ -140,8 +143,32 @@ QVariant SignalHistoryModel::data(const QModelIndex &index, int role) const
         break;
 
     case EventColumn:
-        if (role == EventsRole)
-            return QVariant::fromValue(item(index)->events);
+        if (role == EventsRole || role == EventDensityRole) {
+            const SignalEventStore &events = item(index)->events;
+            if (m_windowBuckets <= 0) {
+                if (role == EventsRole)
+                    return QVariant::fromValue(events.events(std::numeric_limits<qint64>::min(),
+                                                                std::numeric_limits<qint64>::max()));
+                return QVariant::fromValue(QVector<qint64>());
+            }
+            // zoomed out too far to show individual events
+            const bool useDensity = events.count(m_windowStart, m_windowEnd) > m_windowBuckets;
+            if (role == EventsRole) {
+                if (useDensity)
+                    return QVariant::fromValue(QVector<qint64>());
+                return QVariant::fromValue(events.events(m_windowStart, m_windowEnd));
+            }
+            if (!useDensity)
+                return QVariant::fromValue(QVector<qint64>());
+            QVector<qint64> density;
+            density.reserve(m_windowBuckets + 2);
+            density << m_windowStart
+                    << qMax<qint64>(1, (m_windowEnd - m_windowStart) / m_windowBuckets);
+            density << events.density(m_windowStart,
+                                      m_windowStart + density.at(1) * m_windowBuckets,
+                                      m_windowBuckets);
+            return QVariant::fromValue(density);
+        }
         if (role == StartTimeRole)
             return item(index)->startTime;
         if (role == EndTimeRole)
@@ -179,9 +206,59 @@ QMap< int, QVariant > SignalHistoryModel::itemData(const QModelIndex &index) con
     d.insert(EndTimeRole, data(index, EndTimeRole));
     d.insert(SignalMapRole, data(index, SignalMapRole));
     d.insert(ObjectIdRole, data(index, ObjectIdRole));
+    d.insert(EventDensityRole, data(index, EventDensityRole));
     return d;
 }
 
+void SignalHistoryModel::setVisibleWindow(qint64 startTime, qint64 endTime, int buckets)
+{
+    m_windowStart = startTime * 1000;
+    m_windowEnd = endTime * 1000;
+    m_windowBuckets = endTime > startTime ? buckets : 0;
+    if (!m_tracedObjects.isEmpty())
+        emit dataChanged(index(0, EventColumn), index(m_tracedObjects.size() - 1, EventColumn));
+}
+
+int SignalHistoryModel::maxEventCount() const
+{
+    return m_maxEventCount;
+}
+
+void SignalHistoryModel::setMaxEventCount(int count)
+{
+    m_maxEventCount = count;
+    foreach (int row, evictEvents())
+        emit dataChanged(index(row, EventColumn), index(row, EventColumn));
+}
+
+QVector<int> SignalHistoryModel::evictEvents()
+{
+    // chunks were created in chronological order, so this drops the oldest events first
+    QVector<int> rows;
+    while (m_eventCount > m_maxEventCount && !m_chunkOwners.isEmpty()) {
+        const int row = m_chunkOwners.dequeue();
+        m_eventCount -= m_tracedObjects.at(row)->events.evictOldestChunk();
+        rows.push_back(row);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+QVector<int> SignalHistoryModel::changedEventRoles(const Item *item, int added) const
+{
+    // new events are the most recent ones, so individual events only get appended
+    QVector<int> roles;
+    if (m_windowBuckets <= 0)
+        return roles << EventsRole << RemoteModelRole::AppendOnly;
+    const int count = item->events.count(m_windowStart, m_windowEnd);
+    if (count <= m_windowBuckets)
+        return roles << EventsRole << RemoteModelRole::AppendOnly;
+    if (count - added > m_windowBuckets)
+        return roles << EventDensityRole;
+    return roles; // switched from individual events to density data
+}
+
 void SignalHistoryModel::onObjectAdded(QObject *object)
 {
     Q_ASSERT(thread() == QThread::currentThread());
@@ -218,35 +295,69 @@ void SignalHistoryModel::onObjectRemoved(QObject *object)
     emit dataChanged(index(itemIndex, EventColumn), index(itemIndex, EventColumn));
 }
 
-void SignalHistoryModel::onSignalEmitted(QObject *sender, int signalIndex)
+void SignalHistoryModel::onSignalEvents(const QVector<SignalEvent> &events)
 {
     Q_ASSERT(thread() == QThread::currentThread());
-    const qint64 timestamp = RelativeClock::sinceAppStart()->mSecs();
 
-    const auto it = m_itemIndex.constFind(sender);
-    if (it == m_itemIndex.constEnd())
-        return;
-    const int itemIndex = *it;
+    QVector<int> changedItems;
+    foreach (const auto &event, events) {
+        if (event.type != SignalEvent::Begin)
+            continue;
+
+        const auto it = m_itemIndex.constFind(event.sender);
+        if (it == m_itemIndex.constEnd())
+            continue;
+        const int itemIndex = *it;
+
+        Item *data = m_tracedObjects.at(itemIndex);
+        Q_ASSERT(data->object == event.sender);
+        const int signalIndex = event.methodIndex + 1; // offset 1, so unknown signals end up at 0
+        // ensure the item is known
+        if (signalIndex > 0 && !data->signalNames.contains(signalIndex)) {
+            QByteArray signalName;
+            if (event.metaObject) {
+                signalName = SignalIndexCache::signalSignature(event.metaObject, signalIndex - 1);
+            } else {
+                // dynamic meta object, protect dereferencing of sender here
+                QMutexLocker lock(Probe::objectLock());
+                if (!Probe::instance()->isValidObject(event.sender))
+                    continue;
+                signalName = event.sender->metaObject()->method(signalIndex - 1)
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+                             .signature();
+#else
+                             .methodSignature();
+#endif
+            }
+            data->signalNames.insert(signalIndex, internString(signalName));
+        }
 
-    Item *data = m_tracedObjects.at(itemIndex);
-    Q_ASSERT(data->object == sender);
-    // ensure the item is known
-    if (signalIndex > 0 && !data->signalNames.contains(signalIndex)) {
-        // protect dereferencing of sender here
-        QMutexLocker lock(Probe::objectLock());
-        if (!Probe::instance()->isValidObject(sender))
-            return;
-        const QByteArray signalName = sender->metaObject()->method(signalIndex - 1)
+        const qint64 timestamp = event.timestamp / 1000 + m_clockOffset;
+        if (data->events.append(timestamp, signalIndex))
+            m_chunkOwners.enqueue(itemIndex);
+        ++m_eventCount;
+        changedItems.push_back(itemIndex);
+    }
+    // rows that lost their oldest events need a full update, all others just got appended to
+    const QVector<int> evictedItems = evictEvents();
+    foreach (int row, evictedItems)
+        emit dataChanged(index(row, EventColumn), index(row, EventColumn));
+
+    std::sort(changedItems.begin(), changedItems.end());
+    for (auto it = changedItems.constBegin(); it != changedItems.constEnd();) {
+        const auto next = std::upper_bound(it, changedItems.constEnd(), *it);
+        if (std::binary_search(evictedItems.constBegin(), evictedItems.constEnd(), *it)) {
+            it = next;
+            continue;
+        }
+        const QModelIndex idx = index(*it, EventColumn);
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-                                      .signature();
+        emit dataChanged(idx, idx);
 #else
-                                      .methodSignature();
+        emit dataChanged(idx, idx, changedEventRoles(m_tracedObjects.at(*it), next - it));
 #endif
-        data->signalNames.insert(signalIndex, internString(signalName));
+        it = next;
     }
-
-    data->events.push_back((timestamp << 16) | signalIndex);
-    emit dataChanged(index(itemIndex, EventColumn), index(itemIndex, EventColumn));
 }
 
 SignalHistoryModel::Item::Item(QObject *obj)
@@ -263,7 +374,7 @@ qint64 SignalHistoryModel::Item::endTime() const
     if (object)
         return -1; // still alive
     if (!events.isEmpty())
-        return timestamp(events.size() - 1);
+        return events.lastTimestamp() / 1000;
 
     return startTime;
 }
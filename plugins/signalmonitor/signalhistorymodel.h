@@ -29,13 +29,17 @@
 #ifndef GAMMARAY_SIGNALHISTORYMODEL_H
 #define GAMMARAY_SIGNALHISTORYMODEL_H
 
+#include "signaleventstore.h"
+
 #include <common/objectmodel.h>
+#include <core/signalspycallbackset.h>
 
 #include <QAbstractTableModel>
 #include <QHash>
 #include <QIcon>
 #include <QMetaMethod>
 #include <QByteArray>
+#include <QQueue>
 
 namespace GammaRay {
 class ProbeInterface;
@@ -54,12 +58,9 @@ private:
         QString objectName;
         QByteArray objectType;
         QIcon decoration;
-        QVector<qint64> events;
+        SignalEventStore events; // timestamps in microseconds
         const qint64 startTime; // FIXME: make them all methods
         qint64 endTime() const;
-
-        qint64 timestamp(int i) const { return SignalHistoryModel::timestamp(events.at(i)); }
-        int signalIndex(int i) const { return SignalHistoryModel::signalIndex(events.at(i)); }
     };
 
 public:
@@ -70,11 +71,15 @@ public:
     };
 
     enum RoleId {
+        /// events inside the visible window, packed as (timestamp in µs << 16) | signal index
         EventsRole = ObjectModel::UserRole + 1,
         StartTimeRole,
         EndTimeRole,
         SignalMapRole,
-        ObjectIdRole
+        ObjectIdRole,
+        /// instead of EventsRole if there are more events than buckets in the visible window:
+        /// start of the first bucket and bucket width (both in µs), followed by the bucket counts
+        EventDensityRole
     };
 
     explicit SignalHistoryModel(ProbeInterface *probe, QObject *parent = nullptr);
@@ -90,17 +95,42 @@ public:
     static qint64 timestamp(qint64 ev) { return ev >> 16; }
     static int signalIndex(qint64 ev) { return ev & 0xffff; }
 
+    /** Restricts EventsRole and EventDensityRole to the time range [@p startTime, @p endTime)
+     *  (in milliseconds), divided into @p buckets parts for the density data.
+     */
+    void setVisibleWindow(qint64 startTime, qint64 endTime, int buckets);
+
+    /** Maximum number of events kept in total, the oldest ones beyond that are discarded. */
+    int maxEventCount() const;
+    void setMaxEventCount(int count);
+
+    /// internal, called from the signal spy callback
+    void onSignalEvents(const QVector<SignalEvent> &events);
+
 private:
     Item *item(const QModelIndex &index) const;
+    /// discards the oldest events beyond m_maxEventCount, returns the affected rows in order
+    QVector<int> evictEvents();
+    /// roles of EventColumn affected by adding @p added events to @p item
+    QVector<int> changedEventRoles(const Item *item, int added) const;
 
 private slots:
     void onObjectAdded(QObject *object);
     void onObjectRemoved(QObject *object);
-    void onSignalEmitted(QObject *sender, int signalIndex);
 
 private:
     QVector<Item *> m_tracedObjects;
     QHash<QObject *, int> m_itemIndex;
+    // rows of the owners of all event chunks, oldest first
+    QQueue<int> m_chunkOwners;
+    int m_eventCount;
+    int m_maxEventCount;
+    // offset from SignalEvent timestamps to our clock, in µs
+    qint64 m_clockOffset;
+    // visible window in µs, m_windowBuckets is 0 if unrestricted
+    qint64 m_windowStart;
+    qint64 m_windowEnd;
+    int m_windowBuckets;
 };
 } // namespace GammaRay
 
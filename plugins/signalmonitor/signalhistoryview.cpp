@@ -29,7 +29,11 @@
 #include "signalhistoryview.h"
 #include "signalhistorydelegate.h"
 #include "signalhistorymodel.h"
+#include "signalmonitorinterface.h"
 
+#include <common/objectbroker.h>
+
+#include <QHeaderView>
 #include <QHelpEvent>
 #include <QScrollBar>
 #include <QToolTip>
@@ -40,6 +44,9 @@ SignalHistoryView::SignalHistoryView(QWidget *parent)
     : DeferredTreeView(parent)
     , m_eventDelegate(new SignalHistoryDelegate(this))
     , m_eventScrollBar(nullptr)
+    , m_requestedStart(0)
+    , m_requestedEnd(0)
+    , m_requestedWidth(0)
 {
     setDeferredResizeMode(0, QHeaderView::Interactive);
     setDeferredResizeMode(1, QHeaderView::Interactive);
@@ -52,6 +59,7 @@ SignalHistoryView::SignalHistoryView(QWidget *parent)
     connect(m_eventDelegate, SIGNAL(visibleIntervalChanged(qint64)), this,
             SLOT(eventDelegateChanged()));
     connect(m_eventDelegate, SIGNAL(totalIntervalChanged()), this, SLOT(eventDelegateChanged()));
+    connect(header(), SIGNAL(sectionResized(int,int,int)), this, SLOT(updateVisibleWindow()));
 }
 
 void SignalHistoryView::eventDelegateChanged()
@@ -74,6 +82,30 @@ void SignalHistoryView::eventDelegateChanged()
 
         m_eventScrollBar->blockSignals(signalsBlocked);
     }
+
+    updateVisibleWindow();
+}
+
+void SignalHistoryView::updateVisibleWindow()
+{
+    const qint64 start = m_eventDelegate->visibleOffset();
+    const qint64 interval = m_eventDelegate->visibleInterval();
+    const int width = eventColumnWidth();
+    if (interval <= 0 || width <= 0)
+        return;
+
+    if (width == m_requestedWidth && m_requestedEnd - m_requestedStart == 3 * interval
+        && start >= m_requestedStart && start + interval <= m_requestedEnd)
+        return;
+
+    // request one extra page on either side, so scrolling and the live view only
+    // need a new window once per page
+    m_requestedStart = start - interval;
+    m_requestedEnd = start + 2 * interval;
+    m_requestedWidth = width;
+    ObjectBroker::object<SignalMonitorInterface *>()->setVisibleWindow(m_requestedStart,
+                                                                       m_requestedEnd,
+                                                                       3 * width);
 }
 
 void SignalHistoryView::setEventScrollBar(QScrollBar *scrollBar)
@@ -60,10 +60,15 @@ protected:
 private slots:
     void eventDelegateChanged();
     void eventScrollBarSliderMoved(int value);
+    void updateVisibleWindow();
 
 private:
     SignalHistoryDelegate * const m_eventDelegate;
     QScrollBar *m_eventScrollBar;
+    // time window and column width last reported to the server
+    qint64 m_requestedStart;
+    qint64 m_requestedEnd;
+    int m_requestedWidth;
 };
 } // namespace GammaRay
 
@@ -31,6 +31,7 @@
 #include "relativeclock.h"
 #include "signalmonitorcommon.h"
 
+#include <core/probesettings.h>
 #include <core/remote/serverproxymodel.h>
 
 #include <common/objectbroker.h>
@@ -46,10 +47,15 @@ SignalMonitor::SignalMonitor(ProbeInterface *probe, QObject *parent)
 {
     StreamOperators::registerSignalMonitorStreamOperators();
 
-    SignalHistoryModel *model = new SignalHistoryModel(probe, this);
+    m_historyModel = new SignalHistoryModel(probe, this);
+    const int maxEvents = ProbeSettings::value(QStringLiteral("SignalHistoryMaxEvents"),
+                                               m_historyModel->maxEventCount()).toInt();
+    if (maxEvents > 0)
+        m_historyModel->setMaxEventCount(maxEvents);
+
     auto proxy = new ServerProxyModel<QSortFilterProxyModel>(this);
     proxy->setDynamicSortFilter(true);
-    proxy->setSourceModel(model);
+    proxy->setSourceModel(m_historyModel);
     m_objModel = proxy;
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.SignalHistoryModel"), proxy);
     m_objSelectionModel = ObjectBroker::selectionModel(proxy);
@@ -79,6 +85,11 @@ void SignalMonitor::sendClockUpdates(bool enabled)
         m_clock->stop();
 }
 
+void SignalMonitor::setVisibleWindow(qlonglong startTime, qlonglong endTime, int buckets)
+{
+    m_historyModel->setVisibleWindow(startTime, endTime, buckets);
+}
+
 void SignalMonitor::objectSelected(QObject* obj)
 {
     const auto indexList = m_objModel->match(m_objModel->index(0, 0), SignalHistoryModel::ObjectIdRole,
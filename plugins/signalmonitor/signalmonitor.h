@@ -39,6 +39,8 @@ class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class SignalHistoryModel;
+
 class SignalMonitor : public SignalMonitorInterface
 {
     Q_OBJECT
@@ -49,6 +51,7 @@ public:
 
 public slots:
     void sendClockUpdates(bool enabled) Q_DECL_OVERRIDE;
+    void setVisibleWindow(qlonglong startTime, qlonglong endTime, int buckets) Q_DECL_OVERRIDE;
 
 private slots:
     void timeout();
@@ -56,6 +59,7 @@ private slots:
 
 private:
     QTimer *m_clock;
+    SignalHistoryModel *m_historyModel;
     QAbstractItemModel *m_objModel;
     QItemSelectionModel *m_objSelectionModel;
 };
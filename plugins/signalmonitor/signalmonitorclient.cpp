@@ -46,3 +46,9 @@ void SignalMonitorClient::sendClockUpdates(bool enabled)
     Endpoint::instance()->invokeObject(objectName(), "sendClockUpdates",
                                        QVariantList() << QVariant::fromValue(enabled));
 }
+
+void SignalMonitorClient::setVisibleWindow(qlonglong startTime, qlonglong endTime, int buckets)
+{
+    Endpoint::instance()->invokeObject(objectName(), "setVisibleWindow",
+                                       QVariantList() << startTime << endTime << buckets);
+}
@@ -29,14 +29,14 @@
 #ifndef GAMMARAY_SIGNALMONITORCOMMON_H
 #define GAMMARAY_SIGNALMONITORCOMMON_H
 
+#include <common/metatypedeclarations.h>
+
 #include <QByteArray>
 #include <QHash>
 #include <QMetaType>
 #include <QVector>
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-Q_DECLARE_METATYPE(QVector<qlonglong>)
-
 typedef QHash<int, QByteArray> IntByteArrayHash;
 Q_DECLARE_METATYPE(IntByteArrayHash)
 #endif
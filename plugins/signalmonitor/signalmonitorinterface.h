@@ -41,6 +41,10 @@ public:
 
 public slots:
     virtual void sendClockUpdates(bool enabled) = 0;
+    /** Limit the event data in the history model to the time range shown by the client,
+     *  @p buckets is the resolution up to which individual events are transferred.
+     */
+    virtual void setVisibleWindow(qlonglong startTime, qlonglong endTime, int buckets) = 0;
 
 signals:
     void clock(qlonglong msecs);
@@ -29,20 +29,57 @@
 #include "timerinfo.h"
 #include "timermodel.h"
 
+#include <core/signalspycallbackset.h>
 #include <core/util.h>
 
 #include <QObject>
+#include <QThread>
 
 using namespace GammaRay;
 
-static const int maxTimeoutEvents = 1000;
-static const int maxTimeSpan = 10000;
+// number of recent events kept per timer
+static const int maxTimeoutEvents = 128;
+// time span for the wakeup rate and average statistics, in nanoseconds
+static const qint64 maxTimeSpan = Q_INT64_C(10000000000);
+
+// execution time histogram layout: exact below SubBuckets nanoseconds, SubBuckets buckets
+// per power of two above, ie. values are accurate to 1/SubBuckets
+static const int SubBucketBits = 3;
+static const int SubBuckets = 1 << SubBucketBits;
+// halve all histogram counts once reaching this, to favor recent behavior
+static const quint32 maxHistogramCount = 1 << 24;
+
+static int histogramBucket(qint64 value)
+{
+    if (value < SubBuckets)
+        return static_cast<int>(qMax<qint64>(value, 0));
+    int exponent = 0;
+    while ((value >> exponent) >= 2 * SubBuckets)
+        ++exponent;
+    return (exponent + 1) * SubBuckets + static_cast<int>((value >> exponent) - SubBuckets);
+}
+
+static qint64 histogramBucketUpperBound(int bucket)
+{
+    if (bucket < SubBuckets)
+        return bucket;
+    const int exponent = bucket / SubBuckets - 1;
+    return ((static_cast<qint64>(SubBuckets + bucket % SubBuckets) + 1) << exponent) - 1;
+}
+
+static QString formatMicroseconds(qint64 nsecs)
+{
+    return QString::number(nsecs / 1000.0, 'f', 1);
+}
 
 TimerInfo::TimerInfo(QObject *timer)
     : m_type(QQmlTimerType)
     , m_totalWakeups(0)
     , m_timer(timer)
     , m_timerId(-1)
+    , m_nextEvent(0)
+    , m_executionTimesCount(0)
+    , m_maxExecutionTime(0)
     , m_lastReceiver(nullptr)
 {
     if (QTimer *t = qobject_cast<QTimer *>(timer)) {
@@ -55,6 +92,9 @@ TimerInfo::TimerInfo(int timerId)
     : m_type(QObjectType)
     , m_totalWakeups(0)
     , m_timerId(timerId)
+    , m_nextEvent(0)
+    , m_executionTimesCount(0)
+    , m_maxExecutionTime(0)
 {
 }
 
@@ -65,9 +105,36 @@ TimerInfo::Type TimerInfo::type() const
 
 void TimerInfo::addEvent(const TimeoutEvent &timeoutEvent)
 {
-    m_timeoutEvents.append(timeoutEvent);
-    removeOldEvents();
+    if (m_timeoutEvents.size() < maxTimeoutEvents) {
+        if (m_timeoutEvents.isEmpty())
+            m_timeoutEvents.reserve(maxTimeoutEvents);
+        m_timeoutEvents.push_back(timeoutEvent);
+        m_nextEvent = m_timeoutEvents.size() % maxTimeoutEvents;
+    } else {
+        m_timeoutEvents[m_nextEvent] = timeoutEvent;
+        m_nextEvent = (m_nextEvent + 1) % maxTimeoutEvents;
+    }
     m_totalWakeups++;
+
+    if (timeoutEvent.executionTime < 0)
+        return;
+    const int bucket = histogramBucket(timeoutEvent.executionTime);
+    if (bucket >= m_executionTimes.size())
+        m_executionTimes.resize(bucket + 1);
+    ++m_executionTimes[bucket];
+    if (++m_executionTimesCount >= maxHistogramCount) {
+        m_executionTimesCount = 0;
+        for (int i = 0; i < m_executionTimes.size(); ++i) {
+            m_executionTimes[i] /= 2;
+            m_executionTimesCount += m_executionTimes.at(i);
+        }
+    }
+    m_maxExecutionTime = qMax(m_maxExecutionTime, timeoutEvent.executionTime);
+}
+
+const TimerInfo::TimeoutEvent &TimerInfo::event(int i) const
+{
+    return m_timeoutEvents.at((m_nextEvent + i) % m_timeoutEvents.size());
 }
 
 int TimerInfo::numEvents() const
@@ -92,31 +159,25 @@ int TimerInfo::timerId() const
     return m_timerId;
 }
 
-FunctionCallTimer *TimerInfo::functionCallTimer()
-{
-    return &m_functionCallTimer;
-}
-
 QString TimerInfo::wakeupsPerSec() const
 {
+    const qint64 now = SignalEvent::currentTimestamp();
     int totalWakeups = 0;
-    int start = 0;
-    int end = m_timeoutEvents.size() - 1;
-    for (int i = end; i >= 0; i--) {
-        const TimeoutEvent &event = m_timeoutEvents.at(i);
-        if (event.timeStamp.msecsTo(QTime::currentTime()) > maxTimeSpan) {
-            start = i;
+    qint64 startTime = 0;
+    for (int i = m_timeoutEvents.size() - 1; i >= 0; i--) {
+        const TimeoutEvent &e = event(i);
+        if (now - e.timeStamp > maxTimeSpan)
             break;
-        }
+        startTime = e.timeStamp;
         totalWakeups++;
     }
 
-    if (totalWakeups > 0 && end > start) {
-        const QTime startTime = m_timeoutEvents[start].timeStamp;
-        const QTime endTime = m_timeoutEvents[end].timeStamp;
-        const int timeSpan = startTime.msecsTo(endTime);
-        const float wakeupsPerSec = totalWakeups / (float)timeSpan * 1000.0f;
-        return QString::number(wakeupsPerSec, 'f', 1);
+    if (totalWakeups > 1) {
+        const qint64 endTime = event(m_timeoutEvents.size() - 1).timeStamp;
+        if (endTime > startTime) {
+            const double wakeupsPerSec = (totalWakeups - 1) / double(endTime - startTime) * 1.0e9;
+            return QString::number(wakeupsPerSec, 'f', 1);
+        }
     }
     return QStringLiteral("0");
 }
@@ -126,18 +187,19 @@ QString TimerInfo::timePerWakeup() const
     if (m_type == QObjectType)
         return QStringLiteral("N/A");
 
+    const qint64 now = SignalEvent::currentTimestamp();
     int totalWakeups = 0;
-    int totalTime = 0;
+    qint64 totalTime = 0;
     for (int i = m_timeoutEvents.size() - 1; i >= 0; i--) {
-        const TimeoutEvent &event = m_timeoutEvents.at(i);
-        if (event.timeStamp.msecsTo(QTime::currentTime()) > maxTimeSpan)
+        const TimeoutEvent &e = event(i);
+        if (now - e.timeStamp > maxTimeSpan)
             break;
         totalWakeups++;
-        totalTime += event.executionTime;
+        totalTime += e.executionTime;
     }
 
     if (totalWakeups > 0)
-        return QString::number(totalTime / (float)totalWakeups, 'f', 1);
+        return formatMicroseconds(totalTime / totalWakeups);
     return QStringLiteral("N/A");
 }
 
@@ -145,14 +207,60 @@ QString TimerInfo::maxWakeupTime() const
 {
     if (m_type == QObjectType)
         return QStringLiteral("N/A");
+    return formatMicroseconds(m_maxExecutionTime);
+}
 
-    int max = 0;
-    for (int i = 0; i < m_timeoutEvents.size(); i++) {
-        const TimeoutEvent &event = m_timeoutEvents.at(i);
-        if (event.executionTime > max)
-            max = event.executionTime;
+QString TimerInfo::wakeupTimePercentile(int percent) const
+{
+    if (m_type == QObjectType || m_executionTimesCount == 0)
+        return QStringLiteral("N/A");
+
+    const quint64 target = qMax<quint64>(1, (quint64(m_executionTimesCount) * percent + 99) / 100);
+    quint64 count = 0;
+    for (int bucket = 0; bucket < m_executionTimes.size(); ++bucket) {
+        count += m_executionTimes.at(bucket);
+        if (count >= target)
+            return formatMicroseconds(qMin(histogramBucketUpperBound(bucket), m_maxExecutionTime));
+    }
+    return formatMicroseconds(m_maxExecutionTime);
+}
+
+int TimerInfo::expectedInterval() const
+{
+    switch (m_type) {
+    case QTimerType:
+        if (const QTimer *t = timer())
+            return t->interval();
+        break;
+    case QQmlTimerType:
+        if (const QObject *obj = timerObject())
+            return obj->property("interval").toInt();
+        break;
+    case QObjectType:
+        break;
     }
-    return QString::number(max);
+    return -1;
+}
+
+QString TimerInfo::jitter() const
+{
+    const qint64 now = SignalEvent::currentTimestamp();
+    int first = m_timeoutEvents.size();
+    while (first > 0 && now - event(first - 1).timeStamp <= maxTimeSpan)
+        --first;
+    const int intervals = m_timeoutEvents.size() - first - 1;
+    if (intervals <= 0)
+        return QStringLiteral("N/A");
+
+    // compare against the configured interval if we know it, the average one otherwise
+    qint64 expected = qint64(expectedInterval()) * 1000000;
+    if (expected <= 0)
+        expected = (event(m_timeoutEvents.size() - 1).timeStamp - event(first).timeStamp) / intervals;
+
+    qint64 deviation = 0;
+    for (int i = first + 1; i < m_timeoutEvents.size(); ++i)
+        deviation += qAbs((event(i).timeStamp - event(i - 1).timeStamp) - expected);
+    return formatMicroseconds(deviation / intervals);
 }
 
 int TimerInfo::totalWakeups() const
@@ -194,12 +302,6 @@ QString TimerInfo::state() const
     return QString();
 }
 
-void TimerInfo::removeOldEvents()
-{
-    if (m_timeoutEvents.size() > maxTimeoutEvents)
-        m_timeoutEvents.removeFirst();
-}
-
 void TimerInfo::setLastReceiver(QObject *receiver)
 {
     m_lastReceiver = receiver;
@@ -221,3 +323,9 @@ QString TimerInfo::displayName() const
     Q_ASSERT(false);
     return QString();
 }
+
+QThread *TimerInfo::thread() const
+{
+    const QObject *obj = m_type == QObjectType ? m_lastReceiver.data() : m_timer.data();
+    return obj ? obj->thread() : nullptr;
+}
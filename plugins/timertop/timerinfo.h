@@ -28,13 +28,15 @@
 #ifndef GAMMARAY_TIMERTOP_TIMERINFO_H
 #define GAMMARAY_TIMERTOP_TIMERINFO_H
 
-#include "functioncalltimer.h"
-
 #include <QSharedPointer>
 #include <QPointer>
 #include <QTimer>
-#include <QTime>
 #include <QMetaType>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
 
 namespace GammaRay {
 class TimerInfo
@@ -48,8 +50,8 @@ public:
 
     struct TimeoutEvent
     {
-        QTime timeStamp;
-        int executionTime;
+        qint64 timeStamp; // monotonic, in nanoseconds, see SignalEvent::currentTimestamp()
+        qint64 executionTime; // in nanoseconds, -1 if unknown
     };
 
     explicit TimerInfo(QObject *timer);
@@ -61,15 +63,22 @@ public:
     QTimer *timer() const;
     QObject *timerObject() const;
     int timerId() const;
-    FunctionCallTimer *functionCallTimer();
     QString wakeupsPerSec() const;
     QString timePerWakeup() const;
     QString maxWakeupTime() const;
+    /// wakeup time below which @p percent of all wakeups finished
+    QString wakeupTimePercentile(int percent) const;
+    /// mean deviation of the time between wakeups from the expected interval
+    QString jitter() const;
     int totalWakeups() const;
     QString state() const;
     QString displayName() const;
+    QThread *thread() const;
 
 private:
+    const TimeoutEvent &event(int i) const;
+    int expectedInterval() const;
+
     Type m_type;
     int m_totalWakeups;
 
@@ -77,13 +86,17 @@ private:
     QPointer<QObject> m_timer;
 
     int m_timerId;
-    FunctionCallTimer m_functionCallTimer;
-    QList<TimeoutEvent> m_timeoutEvents;
+    // ring buffer of the most recent events, m_nextEvent is the index of the oldest one once full
+    QVector<TimeoutEvent> m_timeoutEvents;
+    int m_nextEvent;
+
+    // log-linear histogram of the execution times of all events, grown on demand
+    QVector<quint32> m_executionTimes;
+    quint32 m_executionTimesCount;
+    qint64 m_maxExecutionTime;
 
     // Only for free timers, QObject that received the timeout event
     QPointer<QObject> m_lastReceiver;
-
-    void removeOldEvents();
 };
 
 typedef QSharedPointer<TimerInfo> TimerInfoPtr;
@@ -27,17 +27,19 @@
 */
 #include "timermodel.h"
 
+#include <core/probe.h>
+#include <core/util.h>
+
 #include <common/objectmodel.h>
 #include <common/objectid.h>
 
 #include <QMetaMethod>
+#include <QMutexLocker>
 #include <QTimerEvent>
 #include <QThread>
 
 #include <iostream>
 
-static const char timerInfoPropertyName[] = "GammaRay TimerInfo";
-
 using namespace GammaRay;
 using namespace std;
 
@@ -76,14 +78,14 @@ TimerModel *TimerModel::instance()
 TimerInfoPtr TimerModel::findOrCreateFreeTimerInfo(int timerId)
 {
     // First, return the timer info if it already exists
-    foreach (const TimerInfoPtr &freeTimer, m_freeTimers) {
-        if (freeTimer->timerId() == timerId)
-            return freeTimer;
-    }
+    const auto it = m_freeTimerRows.constFind(timerId);
+    if (it != m_freeTimerRows.constEnd())
+        return m_freeTimers.at(it.value());
 
     // Create a new free timer, and emit the correct update signals
     TimerInfoPtr timerInfo(new TimerInfo(timerId));
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
+    m_freeTimerRows.insert(timerId, m_freeTimers.size());
     m_freeTimers.append(timerInfo);
     endInsertRows();
     return timerInfo;
@@ -94,34 +96,18 @@ TimerInfoPtr TimerModel::findOrCreateQTimerTimerInfo(QObject *timer)
     if (!timer)
         return TimerInfoPtr();
 
-    QVariant timerInfoVariant = timer->property(timerInfoPropertyName);
-    if (!timerInfoVariant.isValid()) {
-        const TimerInfoPtr info = TimerInfoPtr(new TimerInfo(timer));
-        if (m_qmlTimerTriggeredIndex < 0 && info->type() == TimerInfo::QQmlTimerType)
-            m_qmlTimerTriggeredIndex = timer->metaObject()->indexOfMethod("triggered()");
-        timerInfoVariant.setValue(info);
-        if (timer->thread() == QThread::currentThread()) // ### FIXME: we shouldn't use setProperty() in the first place...
-            timer->setProperty(timerInfoPropertyName, timerInfoVariant);
-    }
+    // the address might have been reused by a new timer, the QPointer in TimerInfo tells
+    const auto it = m_timerInfos.constFind(timer);
+    if (it != m_timerInfos.constEnd() && it.value()->timerObject() == timer)
+        return it.value();
 
-    const TimerInfoPtr timerInfo = timerInfoVariant.value<TimerInfoPtr>();
-    Q_ASSERT(timerInfo->timerObject() == timer);
+    const TimerInfoPtr timerInfo(new TimerInfo(timer));
+    if (m_qmlTimerTriggeredIndex < 0 && timerInfo->type() == TimerInfo::QQmlTimerType)
+        m_qmlTimerTriggeredIndex = timer->metaObject()->indexOfMethod("triggered()");
+    m_timerInfos.insert(timer, timerInfo);
     return timerInfo;
 }
 
-TimerInfoPtr TimerModel::findOrCreateQTimerTimerInfo(int timerId)
-{
-    for (int row = 0; row < m_sourceModel->rowCount(); row++) {
-        const QModelIndex sourceIndex = m_sourceModel->index(row, 0);
-        QObject * const timerObject = sourceIndex.data(ObjectModel::ObjectRole).value<QObject *>();
-        QTimer * const timer = qobject_cast<QTimer *>(timerObject);
-        if (timer && timer->timerId() == timerId)
-            return findOrCreateQTimerTimerInfo(timer);
-    }
-
-    return TimerInfoPtr();
-}
-
 TimerInfoPtr TimerModel::findOrCreateTimerInfo(const QModelIndex &index)
 {
     if (index.row() < m_sourceModel->rowCount()) {
@@ -137,20 +123,27 @@ TimerInfoPtr TimerModel::findOrCreateTimerInfo(const QModelIndex &index)
     return TimerInfoPtr();
 }
 
-int TimerModel::rowFor(QObject *timer)
+void TimerModel::processSignalEvents(const QVector<SignalEvent> &events)
 {
-    for (int i = 0; i < rowCount(); i++) {
-        const TimerInfoPtr timerInfo = findOrCreateTimerInfo(index(i, 0));
-        if (timerInfo && timerInfo->timerObject() == timer)
-            return i;
+    // we need to dereference the senders, which might have been deleted meanwhile
+    QMutexLocker lock(Probe::objectLock());
+    // events from all threads are delivered here, in the thread of this model
+    foreach (const auto &event, events) {
+        if (event.type == SignalEvent::Begin)
+            preSignalActivate(event);
+        else
+            postSignalActivate(event);
     }
-    return -1;
 }
 
-void TimerModel::preSignalActivate(QObject *caller, int methodIndex)
+void TimerModel::preSignalActivate(const SignalEvent &event)
 {
-    if (!(methodIndex == m_timeoutIndex && qobject_cast<QTimer *>(caller))
-        && !(methodIndex == m_qmlTimerTriggeredIndex && caller->inherits("QQmlTimer")))
+    QObject *caller = event.sender;
+    if (!Probe::instance()->isValidObject(caller))
+        return;
+
+    if (!(event.methodIndex == m_timeoutIndex && qobject_cast<QTimer *>(caller))
+        && !(event.methodIndex == m_qmlTimerTriggeredIndex && caller->inherits("QQmlTimer")))
         return;
 
     const TimerInfoPtr timerInfo = findOrCreateQTimerTimerInfo(caller);
@@ -162,18 +155,21 @@ void TimerModel::preSignalActivate(QObject *caller, int methodIndex)
         return;
     }
 
-    if (!timerInfo->functionCallTimer()->start()) {
+    if (m_currentSignals.contains(caller)) {
         cout << "TimerModel::preSignalActivate(): Recursive timeout for timer "
              << (void *)caller << " (" << caller->objectName().toStdString() << ")!" << endl;
         return;
     }
 
-    m_currentSignals[caller] = timerInfo;
+    Activation activation;
+    activation.timerInfo = timerInfo;
+    activation.startTime = event.timestamp;
+    m_currentSignals.insert(caller, activation);
 }
 
-void TimerModel::postSignalActivate(QObject *caller, int methodIndex)
+void TimerModel::postSignalActivate(const SignalEvent &event)
 {
-    QHash<QObject *, TimerInfoPtr>::iterator it = m_currentSignals.find(caller);
+    QHash<QObject *, Activation>::iterator it = m_currentSignals.find(event.sender);
     if (it == m_currentSignals.end()) {
         // Ok, likely a GammaRay timer
         // cout << "TimerModel::postSignalActivate(): Unable to find timer "
@@ -181,12 +177,13 @@ void TimerModel::postSignalActivate(QObject *caller, int methodIndex)
         return;
     }
 
-    const TimerInfoPtr timerInfo = *it;
+    const Activation activation = *it;
+    const TimerInfoPtr timerInfo = activation.timerInfo;
     Q_ASSERT(timerInfo);
 
-    if (!(timerInfo->type() == TimerInfo::QTimerType && methodIndex == m_timeoutIndex)
+    if (!(timerInfo->type() == TimerInfo::QTimerType && event.methodIndex == m_timeoutIndex)
         && !(timerInfo->type() == TimerInfo::QQmlTimerType
-             && methodIndex == m_qmlTimerTriggeredIndex))
+             && event.methodIndex == m_qmlTimerTriggeredIndex))
         return;
 
     m_currentSignals.erase(it);
@@ -196,20 +193,13 @@ void TimerModel::postSignalActivate(QObject *caller, int methodIndex)
         return;
     }
 
-    Q_ASSERT(caller == timerInfo->timerObject());
+    Q_ASSERT(event.sender == timerInfo->timerObject());
 
-    if (!timerInfo->functionCallTimer()->active()) {
-        cout << "TimerModel::postSignalActivate(): Timer not active: "
-             << (void *)caller << " (" << caller->objectName().toStdString() << ")!" << endl;
-        return;
-    }
-
-    TimerInfo::TimeoutEvent event;
-    event.timeStamp = QTime::currentTime();
-    event.executionTime = timerInfo->functionCallTimer()->stop();
-    timerInfo->addEvent(event);
-    const int row = rowFor(timerInfo->timerObject());
-    emitTimerObjectChanged(row);
+    TimerInfo::TimeoutEvent timeoutEvent;
+    timeoutEvent.timeStamp = activation.startTime;
+    timeoutEvent.executionTime = event.timestamp - activation.startTime;
+    timerInfo->addEvent(timeoutEvent);
+    emitTimerObjectChanged(timerInfo->timerObject());
 }
 
 void TimerModel::setSourceModel(QAbstractItemModel *sourceModel)
@@ -272,8 +262,19 @@ QVariant TimerModel::data(const QModelIndex &index, int role) const
             return timerInfo->timePerWakeup();
         case MaxTimePerWakeupColumn:
             return timerInfo->maxWakeupTime();
+        case MedianTimePerWakeupColumn:
+            return timerInfo->wakeupTimePercentile(50);
+        case P99TimePerWakeupColumn:
+            return timerInfo->wakeupTimePercentile(99);
+        case JitterColumn:
+            return timerInfo->jitter();
         case TimerIdColumn:
             return timerInfo->timerId();
+        case ThreadColumn:
+        {
+            QThread *thread = timerInfo->thread();
+            return thread ? Util::displayString(thread) : tr("Unknown");
+        }
         case ColumnCount:
             break;
         }
@@ -303,8 +304,16 @@ QVariant TimerModel::headerData(int section, Qt::Orientation orientation, int ro
             return tr("Time/Wakeup [uSecs]");
         case MaxTimePerWakeupColumn:
             return tr("Max Wakeup Time [uSecs]");
+        case MedianTimePerWakeupColumn:
+            return tr("Median Wakeup Time [uSecs]");
+        case P99TimePerWakeupColumn:
+            return tr("99th Percentile Wakeup Time [uSecs]");
+        case JitterColumn:
+            return tr("Jitter [uSecs]");
         case TimerIdColumn:
             return tr("Timer ID");
+        case ThreadColumn:
+            return tr("Thread");
         case ColumnCount:
             break;
         }
@@ -323,21 +332,27 @@ QMap<int, QVariant> TimerModel::itemData(const QModelIndex &index) const
 bool TimerModel::eventFilter(QObject *watched, QEvent *event)
 {
     if (event->type() == QEvent::Timer) {
+        // application event filters only see events of the main thread anyway, so free
+        // timers of secondary threads are not tracked, unlike QTimers via the signal hooks
+        if (watched->thread() != thread())
+            return false;
+
         QTimerEvent * const timerEvent = static_cast<QTimerEvent *>(event);
 
-        // If there is a QTimer associated with this timer ID, don't handle it here, it will be handled
-        // by the signal hooks for QTimer::timeout()
-        if (findOrCreateQTimerTimerInfo(timerEvent->timerId()))
+        // QTimers receive their own timer event, those are handled by the signal hooks
+        // for QTimer::timeout()
+        const QTimer *timer = qobject_cast<QTimer *>(watched);
+        if (timer && timer->timerId() == timerEvent->timerId())
             return false;
 
         const TimerInfoPtr timerInfo = findOrCreateFreeTimerInfo(timerEvent->timerId());
         TimerInfo::TimeoutEvent timeoutEvent;
-        timeoutEvent.timeStamp = QTime::currentTime();
+        timeoutEvent.timeStamp = SignalEvent::currentTimestamp();
         timeoutEvent.executionTime = -1;
         timerInfo->addEvent(timeoutEvent);
 
         timerInfo->setLastReceiver(watched);
-        emitFreeTimerChanged(m_freeTimers.indexOf(timerInfo));
+        emitFreeTimerChanged(m_freeTimerRows.value(timerEvent->timerId(), -1));
     }
     return false;
 }
@@ -346,6 +361,10 @@ void TimerModel::slotBeginRemoveRows(const QModelIndex &parent, int start, int e
 {
     Q_UNUSED(parent);
     flushEmitPendingChangedRows();
+    for (int row = start; row <= end; ++row) {
+        QObject * const timer = m_sourceModel->index(row, 0).data(ObjectModel::ObjectRole).value<QObject *>();
+        m_timerInfos.remove(timer);
+    }
     beginRemoveRows(QModelIndex(), start, end);
 }
 
@@ -370,6 +389,13 @@ void TimerModel::slotBeginReset()
 {
     m_pendingChangedTimerObjects.clear();
     m_pendingChangedFreeTimers.clear();
+    // we don't learn about removed rows in this case
+    for (auto it = m_timerInfos.begin(); it != m_timerInfos.end();) {
+        if (!it.value()->timerObject())
+            it = m_timerInfos.erase(it);
+        else
+            ++it;
+    }
     beginResetModel();
 }
 
@@ -378,12 +404,9 @@ void TimerModel::slotEndReset()
     endResetModel();
 }
 
-void TimerModel::emitTimerObjectChanged(int row)
+void TimerModel::emitTimerObjectChanged(QObject *timer)
 {
-    if (row < 0 || row >= rowCount())
-        return;
-
-    m_pendingChangedTimerObjects.insert(row);
+    m_pendingChangedTimerObjects.insert(timer);
     if (!m_pendingChanedRowsTimer->isActive())
         m_pendingChanedRowsTimer->start();
 }
@@ -400,8 +423,12 @@ void TimerModel::emitFreeTimerChanged(int row)
 
 void TimerModel::flushEmitPendingChangedRows()
 {
-    foreach (int row, m_pendingChangedTimerObjects)
-        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    // one pass over all timers rather than a lookup for every single changed one
+    for (int row = 0; row < m_sourceModel->rowCount() && !m_pendingChangedTimerObjects.isEmpty(); ++row) {
+        QObject * const timer = m_sourceModel->index(row, 0).data(ObjectModel::ObjectRole).value<QObject *>();
+        if (m_pendingChangedTimerObjects.remove(timer))
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
     m_pendingChangedTimerObjects.clear();
 
     foreach (int row, m_pendingChangedFreeTimers)
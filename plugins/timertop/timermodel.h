@@ -31,6 +31,7 @@
 #include "timerinfo.h"
 
 #include <common/modelroles.h>
+#include <core/signalspycallbackset.h>
 
 #include <QAbstractTableModel>
 #include <QSet>
@@ -53,8 +54,7 @@ public:
     static TimerModel *instance();
 
     // For the spy callbacks
-    void preSignalActivate(QObject *caller, int methodIndex);
-    void postSignalActivate(QObject *caller, int methodIndex);
+    void processSignalEvents(const QVector<SignalEvent> &events);
 
     enum Columns {
         ObjectNameColumn,
@@ -63,7 +63,11 @@ public:
         WakeupsPerSecColumn,
         TimePerWakeupColumn,
         MaxTimePerWakeupColumn,
+        MedianTimePerWakeupColumn,
+        P99TimePerWakeupColumn,
+        JitterColumn,
         TimerIdColumn,
+        ThreadColumn,
         ColumnCount
     };
 
@@ -98,9 +102,6 @@ private slots:
 private:
     explicit TimerModel(QObject *parent = nullptr);
 
-    // Finds only QTimers based on the timer ID, not free timers.
-    TimerInfoPtr findOrCreateQTimerTimerInfo(int timerId);
-
     // Finds both QTimer and free timers
     TimerInfoPtr findOrCreateTimerInfo(const QModelIndex &index);
 
@@ -110,16 +111,27 @@ private:
     // Finds QObject timers
     TimerInfoPtr findOrCreateFreeTimerInfo(int timerId);
 
-    int rowFor(QObject *timer);
-    void emitTimerObjectChanged(int row);
+    void preSignalActivate(const SignalEvent &event);
+    void postSignalActivate(const SignalEvent &event);
+
+    void emitTimerObjectChanged(QObject *timer);
     void emitFreeTimerChanged(int row);
 
     QAbstractItemModel *m_sourceModel;
+    // QTimer/QQmlTimer statistics, entries are dropped when the timer object goes away
+    QHash<QObject *, TimerInfoPtr> m_timerInfos;
     QList<TimerInfoPtr> m_freeTimers;
+    // timer id -> index in m_freeTimers
+    QHash<int, int> m_freeTimerRows;
+    struct Activation
+    {
+        TimerInfoPtr timerInfo;
+        qint64 startTime;
+    };
     // current timer signals that are being processed
-    QHash<QObject *, TimerInfoPtr> m_currentSignals;
-    // pending dataChanged() signals
-    QSet<int> m_pendingChangedTimerObjects;
+    QHash<QObject *, Activation> m_currentSignals;
+    // pending dataChanged() signals, rows of timer objects are only determined when emitting
+    QSet<QObject *> m_pendingChangedTimerObjects;
     QSet<int> m_pendingChangedFreeTimers;
     QTimer *m_pendingChanedRowsTimer;
     // the method index of the timeout() signal of a QTimer
@@ -0,0 +1,139 @@
+/*
+  timerthreadmodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "timerthreadmodel.h"
+#include "timermodel.h"
+
+#include <QMap>
+#include <QTimer>
+
+using namespace GammaRay;
+
+TimerThreadModel::TimerThreadModel(QAbstractItemModel *timerModel, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_timerModel(timerModel)
+    , m_updateTimer(new QTimer(this))
+{
+    // TimerModel changes very frequently, but only reports data changes every couple of seconds
+    m_updateTimer->setInterval(1000);
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(update()));
+
+    connect(m_timerModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(scheduleUpdate()));
+    connect(m_timerModel, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(scheduleUpdate()));
+    connect(m_timerModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(scheduleUpdate()));
+    connect(m_timerModel, SIGNAL(modelReset()), this, SLOT(scheduleUpdate()));
+    connect(m_timerModel, SIGNAL(layoutChanged()), this, SLOT(scheduleUpdate()));
+}
+
+TimerThreadModel::~TimerThreadModel()
+{
+}
+
+int TimerThreadModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+int TimerThreadModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_threads.size();
+}
+
+QVariant TimerThreadModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_threads.size() || role != Qt::DisplayRole)
+        return QVariant();
+
+    const ThreadStatistics &stats = m_threads.at(index.row());
+    switch (index.column()) {
+    case ThreadColumn:
+        return stats.name;
+    case TimerCountColumn:
+        return stats.timerCount;
+    case TotalWakeupsColumn:
+        return stats.totalWakeups;
+    case WakeupsPerSecColumn:
+        return QString::number(stats.wakeupsPerSec, 'f', 1);
+    case ColumnCount:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant TimerThreadModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case ThreadColumn:
+            return tr("Thread");
+        case TimerCountColumn:
+            return tr("Timers");
+        case TotalWakeupsColumn:
+            return tr("Total Wakeups");
+        case WakeupsPerSecColumn:
+            return tr("Wakeups/Sec");
+        case ColumnCount:
+            break;
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void TimerThreadModel::scheduleUpdate()
+{
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void TimerThreadModel::update()
+{
+    QMap<QString, ThreadStatistics> threads;
+    for (int row = 0; row < m_timerModel->rowCount(); ++row) {
+        const QString thread = m_timerModel->index(row, TimerModel::ThreadColumn).data().toString();
+        ThreadStatistics &stats = threads[thread];
+        stats.name = thread;
+        ++stats.timerCount;
+        stats.totalWakeups
+            += m_timerModel->index(row, TimerModel::TotalWakeupsColumn).data().toInt();
+        stats.wakeupsPerSec
+            += m_timerModel->index(row, TimerModel::WakeupsPerSecColumn).data().toDouble();
+    }
+
+    const QVector<ThreadStatistics> newThreads = threads.values().toVector();
+    if (newThreads.size() != m_threads.size()) {
+        beginResetModel();
+        m_threads = newThreads;
+        endResetModel();
+    } else if (!newThreads.isEmpty()) {
+        m_threads = newThreads;
+        emit dataChanged(index(0, 0), index(m_threads.size() - 1, ColumnCount - 1));
+    }
+}
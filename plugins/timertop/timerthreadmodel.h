@@ -0,0 +1,85 @@
+/*
+  timerthreadmodel.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_TIMERTOP_TIMERTHREADMODEL_H
+#define GAMMARAY_TIMERTOP_TIMERTHREADMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+
+/** Timer statistics of TimerModel, aggregated per thread. */
+class TimerThreadModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit TimerThreadModel(QAbstractItemModel *timerModel, QObject *parent = nullptr);
+    ~TimerThreadModel();
+
+    enum Columns {
+        ThreadColumn,
+        TimerCountColumn,
+        TotalWakeupsColumn,
+        WakeupsPerSecColumn,
+        ColumnCount
+    };
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+private slots:
+    void scheduleUpdate();
+    void update();
+
+private:
+    struct ThreadStatistics
+    {
+        ThreadStatistics()
+            : timerCount(0)
+            , totalWakeups(0)
+            , wakeupsPerSec(0.0) {}
+        QString name;
+        int timerCount;
+        int totalWakeups;
+        double wakeupsPerSec;
+    };
+
+    QAbstractItemModel *m_timerModel;
+    QVector<ThreadStatistics> m_threads;
+    QTimer *m_updateTimer;
+};
+}
+
+#endif // GAMMARAY_TIMERTOP_TIMERTHREADMODEL_H
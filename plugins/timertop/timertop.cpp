@@ -28,6 +28,7 @@
 
 #include "timertop.h"
 #include "timermodel.h"
+#include "timerthreadmodel.h"
 
 #include <core/probeinterface.h>
 #include <core/objecttypefilterproxymodel.h>
@@ -36,10 +37,8 @@
 #include <common/objectbroker.h>
 #include <common/objectid.h>
 
-#include <QCoreApplication>
 #include <QItemSelectionModel>
 #include <QtPlugin>
-#include <QThread>
 
 using namespace GammaRay;
 
@@ -84,34 +83,12 @@ public:
     }
 };
 
-static bool processCallback()
+static void signal_event_callback(const QVector<SignalEvent> &events)
 {
-    ///TODO: multi-threading support
-    if (!TimerModel::isInitialized() || QThread::currentThread() != QCoreApplication::instance()->thread())
-        return false;
-    return true;
-}
-
-static void signal_begin_callback(QObject *caller, int method_index, void **argv)
-{
-    Q_UNUSED(argv);
-    if (!processCallback())
-        return;
-
-    ///TODO: support threads living in other threads
-    if (caller->thread() != qApp->thread())
-        return;
-
-    TimerModel::instance()->preSignalActivate(caller, method_index);
-}
-
-static void signal_end_callback(QObject *caller, int method_index)
-{
-    // NOTE: here and below the caller may be invalid, e.g. if it was deleted from a slot
-    if (!processCallback())
+    if (!TimerModel::isInitialized())
         return;
 
-    TimerModel::instance()->postSignalActivate(caller, method_index);
+    TimerModel::instance()->processSignalEvents(events);
 }
 
 TimerTop::TimerTop(ProbeInterface *probe, QObject *parent)
@@ -126,13 +103,14 @@ TimerTop::TimerTop(ProbeInterface *probe, QObject *parent)
     TimerModel::instance()->setSourceModel(filterModel);
 
     SignalSpyCallbackSet callbacks;
-    callbacks.signalBeginCallback = signal_begin_callback;
-    callbacks.signalEndCallback = signal_end_callback;
+    callbacks.signalEventCallback = signal_event_callback;
     probe->registerSignalSpyCallbackSet(callbacks);
 
     probe->installGlobalEventFilter(TimerModel::instance());
 
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.TimerModel"), TimerModel::instance());
+    probe->registerModel(QStringLiteral("com.kdab.GammaRay.TimerThreadModel"),
+                         new TimerThreadModel(TimerModel::instance(), this));
     m_selectionModel = ObjectBroker::selectionModel(TimerModel::instance());
 
     connect(probe->probe(), SIGNAL(objectSelected(QObject*,QPoint)), this, SLOT(objectSelected(QObject*)));
@@ -29,6 +29,7 @@
 #include "timertopwidget.h"
 #include "ui_timertopwidget.h"
 #include "timermodel.h"
+#include "timerthreadmodel.h"
 
 #include <ui/contextmenuextension.h>
 
@@ -50,11 +51,8 @@ TimerTopWidget::TimerTopWidget(QWidget *parent)
 
     ui->timerView->header()->setObjectName("timerViewHeader");
     ui->timerView->setDeferredResizeMode(0, QHeaderView::Stretch);
-    ui->timerView->setDeferredResizeMode(1, QHeaderView::ResizeToContents);
-    ui->timerView->setDeferredResizeMode(2, QHeaderView::ResizeToContents);
-    ui->timerView->setDeferredResizeMode(3, QHeaderView::ResizeToContents);
-    ui->timerView->setDeferredResizeMode(4, QHeaderView::ResizeToContents);
-    ui->timerView->setDeferredResizeMode(5, QHeaderView::ResizeToContents);
+    for (int i = 1; i < TimerModel::ColumnCount; ++i)
+        ui->timerView->setDeferredResizeMode(i, QHeaderView::ResizeToContents);
     connect(ui->timerView, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(contextMenu(QPoint)));
 
     QSortFilterProxyModel * const sortModel = new QSortFilterProxyModel(this);
@@ -64,6 +62,16 @@ TimerTopWidget::TimerTopWidget(QWidget *parent)
     ui->timerView->setSelectionModel(ObjectBroker::selectionModel(sortModel));
 
     ui->timerView->sortByColumn(TimerModel::WakeupsPerSecColumn, Qt::DescendingOrder);
+
+    ui->threadView->header()->setObjectName("threadViewHeader");
+    ui->threadView->setDeferredResizeMode(0, QHeaderView::Stretch);
+    for (int i = 1; i < TimerThreadModel::ColumnCount; ++i)
+        ui->threadView->setDeferredResizeMode(i, QHeaderView::ResizeToContents);
+    QSortFilterProxyModel * const threadSortModel = new QSortFilterProxyModel(this);
+    threadSortModel->setSourceModel(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.TimerThreadModel")));
+    threadSortModel->setDynamicSortFilter(true);
+    ui->threadView->setModel(threadSortModel);
+    ui->threadView->sortByColumn(TimerThreadModel::WakeupsPerSecColumn, Qt::DescendingOrder);
 }
 
 TimerTopWidget::~TimerTopWidget()
@@ -43,6 +43,7 @@
 #include "core/varianthandler.h"
 #include "core/probesettings.h"
 #include "core/objecttypefilterproxymodel.h"
+#include "core/objectsearchproxymodel.h"
 #include "core/probeinterface.h"
 #include "core/probeguard.h"
 #include <core/paintanalyzer.h>
@@ -58,8 +59,6 @@
 #include <common/probecontrollerinterface.h>
 #include <common/remoteviewframe.h>
 
-#include <3rdparty/kde/krecursivefilterproxymodel.h>
-
 #include <QAction>
 #include <QAbstractItemView>
 #include <QApplication>
@@ -128,7 +127,7 @@ WidgetInspectorServer::WidgetInspectorServer(ProbeInterface *probe, QObject *par
     WidgetTreeModel *widgetFilterProxy = new WidgetTreeModel(this);
     widgetFilterProxy->setSourceModel(probe->objectTreeModel());
 
-    auto widgetSearchProxy = new ServerProxyModel<KRecursiveFilterProxyModel>(this);
+    auto widgetSearchProxy = new ServerProxyModel<ObjectSearchProxyModel>(this);
     widgetSearchProxy->setSourceModel(widgetFilterProxy);
     widgetSearchProxy->addRole(ObjectModel::ObjectIdRole);
 
@@ -222,8 +221,15 @@ void WidgetInspectorServer::widgetSelected(const QItemSelection &selection)
 
 bool WidgetInspectorServer::eventFilter(QObject *object, QEvent *event)
 {
-    if (object == m_selectedWidget && event->type() == QEvent::Paint)
-        m_remoteView->sourceChanged();
+    if (event->type() == QEvent::Paint && m_selectedWidget && object->isWidgetType()) {
+        // the preview shows the entire window, so changes anywhere in there matter
+        QWidget *widget = static_cast<QWidget *>(object);
+        QWidget *window = m_selectedWidget->window();
+        if (widget->window() == window) {
+            const QRegion region = static_cast<QPaintEvent *>(event)->region();
+            m_remoteView->addDirtyRegion(region.translated(widget->mapTo(window, QPoint())));
+        }
+    }
 
     // make modal dialogs non-modal so that the gammaray window is still reachable
     // TODO: should only be done in in-process mode
@@ -263,8 +269,50 @@ void WidgetInspectorServer::updateWidgetPreview()
     if (!m_remoteView->isActive() || !m_selectedWidget)
         return;
 
+    QWidget *window = m_selectedWidget->window();
     RemoteViewFrame frame;
-    frame.setImage(imageForWidget(m_selectedWidget->window()));
+    frame.setViewRect(window->rect());
+
+    // only render what the client shows, at the resolution it is shown at
+    QRect rect = window->rect();
+    qreal scale = 1.0;
+    const QRectF viewportRect = m_remoteView->clientViewportRect();
+    const QSize viewportSize = m_remoteView->clientViewportSize();
+    const QRect visibleRect = viewportRect.toAlignedRect() & window->rect();
+    if (viewportRect.isValid() && !viewportSize.isEmpty() && !visibleRect.isEmpty()) {
+        rect = visibleRect;
+        scale = qMin<qreal>(1.0, viewportSize.width() / viewportRect.width());
+    }
+
+    if (scale < 1.0) {
+        // scaled partial updates would leave seams, and painting is cheap at that size anyway
+        m_previewWindow = nullptr;
+        m_previewImage = QImage();
+        m_backPreviewImage = QImage();
+        frame.setImage(imageForWidget(window, rect, scale));
+    } else if (m_previewWindow != window || m_previewRect != rect) {
+        m_previewWindow = window;
+        m_previewRect = rect;
+        m_previewImage = imageForWidget(window, rect);
+        m_backPreviewImage = QImage();
+        frame.setImage(m_previewImage);
+    } else {
+        // only re-render what changed since the last frame, into the buffer not shared with the
+        // receiver of that frame, painting into a shared image would deep copy all of it
+        const QRegion dirtyRegion = m_remoteView->dirtyRegion() & rect;
+        if (!dirtyRegion.isEmpty()) {
+            QRegion region = dirtyRegion | m_backPreviewDirtyRegion;
+            if (m_backPreviewImage.isNull()) {
+                m_backPreviewImage = QImage(m_previewImage.size(), m_previewImage.format());
+                region = rect;
+            }
+            renderWidgetRegion(window, rect, region, &m_backPreviewImage);
+            qSwap(m_previewImage, m_backPreviewImage);
+            m_backPreviewDirtyRegion = dirtyRegion;
+        }
+        frame.setImage(m_previewImage);
+    }
+    frame.setImageRect(rect);
     m_remoteView->sendFrame(frame);
 }
 
@@ -289,22 +337,42 @@ void WidgetInspectorServer::pickElementId(const GammaRay::ObjectId &id)
         widgetSelected(widget);
 }
 
-QImage WidgetInspectorServer::imageForWidget(QWidget *widget)
+QImage WidgetInspectorServer::imageForWidget(QWidget *widget, const QRect &rect, qreal scale)
 {
     // prevent "recursion", i.e. infinite update loop, in our eventFilter
     Util::SetTempValue<QPointer<QWidget> > guard(m_selectedWidget, nullptr);
     // We should use hidpi rendering but it's buggy so let stay with
     // low dpi rendering. See QTBUG-53801
     const qreal ratio = 1; // widget->window()->devicePixelRatio();
-    QImage img(widget->size() * ratio, QImage::Format_ARGB32);
+    const QRect sourceRect = rect.isValid() ? rect : widget->rect();
+    QImage img(sourceRect.size() * scale * ratio, QImage::Format_ARGB32);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     img.setDevicePixelRatio(ratio);
 #endif
     img.fill(Qt::transparent);
-    widget->render(&img);
+    if (scale < 1.0) {
+        QPainter painter(&img);
+        painter.scale(scale, scale);
+        widget->render(&painter, QPoint(), QRegion(sourceRect));
+    } else {
+        widget->render(&img, QPoint(), QRegion(sourceRect));
+    }
     return img;
 }
 
+void WidgetInspectorServer::renderWidgetRegion(QWidget *widget, const QRect &rect,
+                                               const QRegion &region, QImage *image)
+{
+    Util::SetTempValue<QPointer<QWidget> > guard(m_selectedWidget, nullptr);
+    QPainter painter(image);
+    painter.translate(-rect.topLeft());
+    painter.setClipRegion(region);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(region.boundingRect(), Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    widget->render(&painter, region.boundingRect().topLeft(), region);
+}
+
 void WidgetInspectorServer::recreateOverlayWidget()
 {
     ProbeGuard guard;
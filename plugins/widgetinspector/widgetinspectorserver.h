@@ -33,7 +33,9 @@
 #include <widgetinspectorinterface.h>
 #include <common/remoteviewinterface.h>
 
+#include <QImage>
 #include <QPointer>
+#include <QRegion>
 
 QT_BEGIN_NAMESPACE
 class QModelIndex;
@@ -70,7 +72,10 @@ private:
     GammaRay::ObjectIds recursiveWidgetsAt(QWidget *parent, const QPoint &pos,
                                            GammaRay::RemoteViewInterface::RequestMode mode, int& bestCandidate) const;
     void callExternalExportAction(const char *name, QWidget *widget, const QString &fileName);
-    QImage imageForWidget(QWidget *widget);
+    /// renders @p rect of @p widget (all of it if invalid), scaled by @p scale
+    QImage imageForWidget(QWidget *widget, const QRect &rect = QRect(), qreal scale = 1.0);
+    /// re-renders @p region of @p widget into @p image, which shows @p rect of it
+    void renderWidgetRegion(QWidget *widget, const QRect &rect, const QRegion &region, QImage *image);
     void registerWidgetMetaTypes();
     void registerVariantHandlers();
     void discoverObjects();
@@ -104,6 +109,14 @@ private:
     QPointer<QWidget> m_selectedWidget;
     PaintAnalyzer *m_paintAnalyzer;
     RemoteViewServer *m_remoteView;
+    // last full scale preview, for re-rendering only the parts that changed
+    QPointer<QWidget> m_previewWindow;
+    QRect m_previewRect;
+    QImage m_previewImage;
+    // second buffer we paint into while the receiver of the last frame still holds m_previewImage,
+    // it lacks the changes in m_backPreviewDirtyRegion
+    QImage m_backPreviewImage;
+    QRegion m_backPreviewDirtyRegion;
     ProbeInterface *m_probe;
 };
 }
@@ -0,0 +1,146 @@
+/*
+  backtracetest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/tools/messagehandler/backtrace.h>
+
+#include <QtTest/qtest.h>
+#include <QDataStream>
+#include <QObject>
+
+// replaces the platform specific symbolization, records what got symbolized
+static QVector<quintptr> s_symbolized;
+static int s_symbolizeCalls = 0;
+
+QStringList symbolizeBacktrace(const QVector<quintptr> &addresses)
+{
+    ++s_symbolizeCalls;
+    s_symbolized += addresses;
+    QStringList symbols;
+    foreach (quintptr address, addresses)
+        symbols.push_back(QStringLiteral("sym_%1").arg(address, 0, 16));
+    return symbols;
+}
+
+Backtrace getBacktrace(int levels, int skip)
+{
+    Q_UNUSED(levels);
+    Q_UNUSED(skip);
+    return Backtrace();
+}
+
+class BacktraceTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QString symbol(quintptr address)
+    {
+        return QStringLiteral("sym_%1").arg(address, 0, 16);
+    }
+
+private slots:
+    void init()
+    {
+        s_symbolized.clear();
+        s_symbolizeCalls = 0;
+    }
+
+    void testLazySymbolization()
+    {
+        const QVector<quintptr> addresses = QVector<quintptr>() << 0x1000 << 0x1010 << 0x1020;
+        const Backtrace backtrace(addresses);
+        QCOMPARE(backtrace.size(), 3);
+        QCOMPARE(s_symbolizeCalls, 0);
+
+        const QStringList frames = backtrace.frames();
+        QCOMPARE(s_symbolizeCalls, 1);
+        QCOMPARE(s_symbolized, addresses);
+        QCOMPARE(frames, QStringList() << symbol(0x1000) << symbol(0x1010) << symbol(0x1020));
+
+        // cached symbols are not resolved again
+        QCOMPARE(backtrace.frames(), frames);
+        QCOMPARE(s_symbolizeCalls, 1);
+    }
+
+    void testAddressDedup()
+    {
+        // recursion, the same return address appears multiple times
+        const Backtrace backtrace(QVector<quintptr>() << 0x2000 << 0x2010 << 0x2010 << 0x2010 << 0x2020);
+        const QStringList frames = backtrace.frames();
+        QCOMPARE(frames.size(), 5);
+        QCOMPARE(frames.at(1), symbol(0x2010));
+        QCOMPARE(frames.at(3), symbol(0x2010));
+        QCOMPARE(s_symbolized, QVector<quintptr>() << 0x2000 << 0x2010 << 0x2020);
+
+        // a different call stack only resolves the addresses not seen before
+        s_symbolized.clear();
+        const Backtrace other(QVector<quintptr>() << 0x2000 << 0x2030 << 0x2020);
+        QCOMPARE(other.frames(), QStringList() << symbol(0x2000) << symbol(0x2030) << symbol(0x2020));
+        QCOMPARE(s_symbolized, QVector<quintptr>() << 0x2030);
+    }
+
+    void testSymbolCacheLimit()
+    {
+        // more distinct addresses than the symbol cache keeps
+        for (quintptr block = 0; block < 20; ++block) {
+            QVector<quintptr> addresses;
+            for (quintptr i = 0; i < 1024; ++i)
+                addresses.push_back(0x100000 + block * 0x10000 + i);
+            const QStringList frames = Backtrace(addresses).frames();
+            QCOMPARE(frames.size(), addresses.size());
+            QCOMPARE(frames.last(), symbol(addresses.last()));
+        }
+        QCOMPARE(s_symbolizeCalls, 20);
+
+        // the oldest symbols got dropped, and are resolved again on demand
+        s_symbolized.clear();
+        const Backtrace first(QVector<quintptr>() << 0x100000);
+        QCOMPARE(first.frames(), QStringList() << symbol(0x100000));
+        QCOMPARE(s_symbolized, QVector<quintptr>() << 0x100000);
+    }
+
+    void testSerialization()
+    {
+        const Backtrace backtrace(QVector<quintptr>() << 0x3000 << 0x3010);
+        QByteArray data;
+        {
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream << backtrace;
+        }
+        QCOMPARE(s_symbolizeCalls, 0);
+
+        Backtrace copy;
+        QDataStream stream(data);
+        stream >> copy;
+        QCOMPARE(copy.size(), 2);
+        QCOMPARE(copy.frames(), QStringList() << symbol(0x3000) << symbol(0x3010));
+        QCOMPARE(s_symbolizeCalls, 1);
+    }
+};
+
+QTEST_MAIN(BacktraceTest)
+
+#include "backtracetest.moc"
@@ -33,6 +33,7 @@
 #include <QtTestGui>
 
 #include <QLabel>
+#include <QSignalMapper>
 #include <QTreeView>
 
 QTEST_MAIN(GammaRay::BenchSuite)
@@ -77,3 +78,68 @@ void BenchSuite::probe_objectAdded()
     qDeleteAll(objects);
     delete Probe::instance();
 }
+
+void BenchSuite::probe_objectCreationBurst()
+{
+    Probe::createProbe(false);
+
+    // simulates e.g. a model reset or a large QML load within a single event loop iteration
+    static const int NUM_OBJECTS = 100000;
+    QObject root;
+    QVector<QObject *> objects;
+    objects.reserve(NUM_OBJECTS);
+    for (int i = 0; i < NUM_OBJECTS; ++i)
+        objects << new QObject(&root);
+
+    QBENCHMARK_ONCE {
+        Probe::objectAdded(&root, true);
+        // each of those checks whether the parent creation is still queued
+        foreach (QObject *obj, objects)
+            Probe::objectAdded(obj);
+        // short-lived objects purge their pending creation again
+        for (int i = 0; i < NUM_OBJECTS; i += 2)
+            Probe::objectRemoved(objects.at(i));
+        Probe::instance()->processQueuedObjectChanges();
+    }
+
+    delete Probe::instance();
+}
+
+static void signalBeginCallback(QObject *, int, void **)
+{
+}
+
+void BenchSuite::probe_signalEmission_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::newRow("depth 5") << 5;
+    QTest::newRow("depth 50") << 50;
+    QTest::newRow("depth 500") << 500;
+}
+
+void BenchSuite::probe_signalEmission()
+{
+    QFETCH(int, depth);
+
+    Probe::createProbe(false);
+    QTest::qWait(1); // delayed init
+
+    SignalSpyCallbackSet callbacks;
+    callbacks.signalBeginCallback = signalBeginCallback;
+    Probe::instance()->registerSignalSpyCallbackSet(callbacks);
+
+    // every emission checks whether the sender belongs to GammaRay
+    QObject root;
+    QObject *parent = &root;
+    for (int i = 2; i < depth; ++i)
+        parent = new QObject(parent);
+    QSignalMapper *sender = new QSignalMapper(parent);
+    sender->setMapping(&root, 42);
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            sender->map(&root);
+    }
+
+    delete Probe::instance();
+}
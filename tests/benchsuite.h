@@ -39,6 +39,9 @@ class BenchSuite : public QObject
 private slots:
     void iconForObject();
     void probe_objectAdded();
+    void probe_objectCreationBurst();
+    void probe_signalEmission_data();
+    void probe_signalEmission();
 };
 }
 
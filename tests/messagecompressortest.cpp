@@ -0,0 +1,123 @@
+/*
+  messagecompressortest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common/messagecompressor.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+
+using namespace GammaRay;
+
+class MessageCompressorTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QByteArray randomData(int size, uint seed)
+    {
+        qsrand(seed);
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i)
+            data[i] = static_cast<char>(qrand() & 0xff);
+        return data;
+    }
+
+    /// compresses @p data and verifies it roundtrips, returns the compressed size
+    static int roundtrip(MessageCompressor *compressor, MessageDecompressor *decompressor,
+                         const QByteArray &data)
+    {
+        QByteArray compressed;
+        const int size = compressor->compress(data, &compressed);
+        if (size != compressed.size())
+            return -1;
+        QByteArray decompressed;
+        if (!decompressor->decompress(compressed.constData(), compressed.size(), &decompressed))
+            return -1;
+        if (decompressed != data)
+            return -1;
+        return size;
+    }
+
+private slots:
+    void testHistory()
+    {
+        MessageCompressor compressor;
+        compressor.setLevel(MessageCompressor::Strong);
+        MessageDecompressor decompressor;
+
+        // incompressible on their own
+        const QByteArray a = randomData(16 * 1024, 1);
+        const QByteArray b = randomData(16 * 1024, 2);
+        const QByteArray c = randomData(16 * 1024, 3);
+        QVERIFY(roundtrip(&compressor, &decompressor, a) > a.size());
+        QVERIFY(roundtrip(&compressor, &decompressor, b) > b.size());
+        QVERIFY(roundtrip(&compressor, &decompressor, c) > c.size());
+
+        // only compressible against data three messages back
+        const int size = roundtrip(&compressor, &decompressor, a);
+        QVERIFY(size > 0);
+        QVERIFY(size < a.size() / 50);
+    }
+
+    void testLargeMessages()
+    {
+        MessageCompressor compressor;
+        compressor.setLevel(MessageCompressor::Fast);
+        MessageDecompressor decompressor;
+
+        // larger than the history, and wrapping around the ring buffer several times
+        for (int i = 0; i < 20; ++i) {
+            QByteArray data = randomData(1000 + i * 37 * 1024, i);
+            data += data.left(5000);
+            QVERIFY(roundtrip(&compressor, &decompressor, data) > 0);
+        }
+
+        // history is still in sync afterwards
+        const QByteArray small = randomData(8 * 1024, 42);
+        QVERIFY(roundtrip(&compressor, &decompressor, small) > 0);
+        const int size = roundtrip(&compressor, &decompressor, small);
+        QVERIFY(size > 0);
+        QVERIFY(size < small.size() / 50);
+    }
+
+    void testMalformedInput()
+    {
+        MessageCompressor compressor;
+        compressor.setLevel(MessageCompressor::Strong);
+        QByteArray compressed;
+        QVERIFY(compressor.compress(randomData(1024, 7), &compressed) > 0);
+
+        QByteArray decompressed;
+        MessageDecompressor truncated;
+        QVERIFY(!truncated.decompress(compressed.constData(), compressed.size() - 8, &decompressed));
+        MessageDecompressor empty;
+        QVERIFY(!empty.decompress(compressed.constData(), 2, &decompressed));
+    }
+};
+
+QTEST_MAIN(MessageCompressorTest)
+
+#include "messagecompressortest.moc"
@@ -0,0 +1,95 @@
+/*
+  messagemodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/tools/messagehandler/messagemodel.h>
+
+#include <QtTest/qtest.h>
+#include <QtTest/qsignalspy.h>
+#include <QObject>
+
+using namespace GammaRay;
+
+class MessageModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static DebugMessage createMessage(int i)
+    {
+        DebugMessage msg;
+        msg.type = QtDebugMsg;
+        msg.message = QStringLiteral("message %1").arg(i);
+        msg.time = QTime::currentTime();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        msg.category = QStringLiteral("gammaray.test");
+        msg.file = QStringLiteral("messagemodeltest.cpp");
+        msg.function = QStringLiteral("createMessage");
+        msg.line = i;
+#endif
+        return msg;
+    }
+
+    static void verifyRow(MessageModel *model, int row)
+    {
+        QCOMPARE(model->index(row, MessageModelColumn::Message).data().toString(),
+                 QStringLiteral("message %1").arg(row));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        QCOMPARE(model->index(row, MessageModelColumn::File).data(MessageModelRole::Line).toInt(), row);
+        QCOMPARE(model->index(row, MessageModelColumn::Category).data().toString(),
+                 QStringLiteral("gammaray.test"));
+#endif
+    }
+
+private slots:
+    void testMemoryBudget()
+    {
+        MessageModel model;
+        model.setMemoryBudget(16 * 1024);
+        QSignalSpy removeSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+        for (int i = 0; i < 2000; ++i)
+            model.addMessage(createMessage(i));
+        QCOMPARE(model.rowCount(), 2000);
+        QCOMPARE(removeSpy.count(), 0);
+
+        // random access to both recent and spilled messages
+        foreach (int row, QList<int>() << 1999 << 0 << 1000 << 63 << 64 << 1 << 1998 << 1000)
+            verifyRow(&model, row);
+
+        // spilling messages we have already paged back in
+        model.setMemoryBudget(1024);
+        QCOMPARE(model.rowCount(), 2000);
+        for (int row = 1900; row < 2000; ++row)
+            verifyRow(&model, row);
+        model.addMessage(createMessage(2000));
+        verifyRow(&model, 1950);
+        verifyRow(&model, 2000);
+    }
+};
+
+QTEST_MAIN(MessageModelTest)
+
+#include "messagemodeltest.moc"
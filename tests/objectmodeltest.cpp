@@ -0,0 +1,181 @@
+/*
+  objectmodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <probe/hooks.h>
+#include <probe/probecreator.h>
+#include <core/probe.h>
+#include <common/objectmodel.h>
+
+#include <3rdparty/qt/modeltest.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+#include <QSignalSpy>
+#include <QThread>
+#include <QVector>
+
+using namespace GammaRay;
+
+// deletes an object from a secondary thread, so the probe has to queue its destruction
+class DeleterThread : public QThread
+{
+public:
+    explicit DeleterThread(QObject *obj)
+        : m_obj(obj)
+    {
+    }
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        delete m_obj;
+    }
+
+private:
+    QObject *m_obj;
+};
+
+class ObjectModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    void createProbe()
+    {
+        Hooks::installHooks();
+        Probe::startupHookReceived();
+        new ProbeCreator(ProbeCreator::Create);
+        QTest::qWait(1); // event loop re-entry
+    }
+
+    static QModelIndex indexForObject(QAbstractItemModel *model, QObject *obj)
+    {
+        const auto l = model->match(model->index(0, 0), ObjectModel::ObjectRole,
+                                    QVariant::fromValue(obj), 1,
+                                    Qt::MatchRecursive | Qt::MatchExactly);
+        return l.size() == 1 ? l.at(0) : QModelIndex();
+    }
+
+    /// verifies @p objs are all listed once, and placed below their parent in the tree
+    static bool verifyObjects(const QVector<QObject *> &objs)
+    {
+        QAbstractItemModel *listModel = Probe::instance()->objectListModel();
+        QAbstractItemModel *treeModel = Probe::instance()->objectTreeModel();
+        foreach (QObject *obj, objs) {
+            if (!indexForObject(listModel, obj).isValid())
+                return false;
+            const QModelIndex idx = indexForObject(treeModel, obj);
+            if (!idx.isValid())
+                return false;
+            if (idx.parent().data(ObjectModel::ObjectRole).value<QObject *>() != obj->parent())
+                return false;
+        }
+        return true;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        createProbe();
+    }
+
+    void testBatchedCreation()
+    {
+        ModelTest listModelTest(Probe::instance()->objectListModel());
+        ModelTest treeModelTest(Probe::instance()->objectTreeModel());
+        QSignalSpy listSpy(Probe::instance()->objectListModel(), SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QSignalSpy treeSpy(Probe::instance()->objectTreeModel(), SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+        QObject root;
+        root.setObjectName(QStringLiteral("batchRoot"));
+        auto known = new QObject(&root);
+        QTest::qWait(1); // queued object creation
+        QVERIFY(verifyObjects(QVector<QObject *>() << &root << known));
+        listSpy.clear();
+        treeSpy.clear();
+
+        // all of these end up in one batch, with children preceding their parents
+        QVector<QObject *> objs;
+        auto orphan = new QObject;
+        objs.push_back(orphan);
+        auto parent = new QObject(&root);
+        objs.push_back(parent);
+        orphan->setParent(parent);
+        for (int i = 0; i < 20; ++i) {
+            objs.push_back(new QObject(&root));
+            objs.push_back(new QObject(i % 2 ? parent : known));
+            objs.push_back(new QObject(objs.last()));
+        }
+        auto lateParent = new QObject;
+        auto lateChild = new QObject(lateParent);
+        objs.push_back(lateChild);
+        objs.push_back(lateParent);
+        lateParent->setParent(known);
+        QTest::qWait(1);
+
+        QVERIFY(verifyObjects(objs));
+        QVERIFY(listSpy.size() > 0);
+        // batched, rather than one insertion per object
+        QVERIFY(treeSpy.size() > 0);
+        QVERIFY(treeSpy.size() < objs.size());
+    }
+
+    void testDestructionWithinBatch()
+    {
+        ModelTest listModelTest(Probe::instance()->objectListModel());
+        ModelTest treeModelTest(Probe::instance()->objectTreeModel());
+
+        QObject root;
+        auto doomed = new QObject;
+        QTest::qWait(1);
+        QVERIFY(indexForObject(Probe::instance()->objectListModel(), doomed).isValid());
+
+        // the queued destruction flushes the objects created before it
+        QVector<QObject *> objs;
+        auto parent = new QObject(&root);
+        objs.push_back(parent);
+        for (int i = 0; i < 10; ++i)
+            objs.push_back(new QObject(parent));
+        DeleterThread deleter(doomed);
+        deleter.start();
+        QVERIFY(deleter.wait());
+        for (int i = 0; i < 10; ++i)
+            objs.push_back(new QObject(parent));
+        // a short-lived object within the batch
+        delete new QObject(parent);
+        QTest::qWait(1);
+
+        QVERIFY(verifyObjects(objs));
+        if (!objs.contains(doomed)) // the address might have been reused
+            QVERIFY(!indexForObject(Probe::instance()->objectListModel(), doomed).isValid());
+        QAbstractItemModel *treeModel = Probe::instance()->objectTreeModel();
+        QCOMPARE(treeModel->rowCount(indexForObject(treeModel, parent)), 20);
+    }
+};
+
+QTEST_MAIN(ObjectModelTest)
+
+#include "objectmodeltest.moc"
@@ -0,0 +1,137 @@
+/*
+  objectsearchproxymodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/objectsearchproxymodel.h>
+#include <core/probe.h>
+#include <core/util.h>
+#include <common/objectmodel.h>
+
+#include <probe/hooks.h>
+#include <probe/probecreator.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+#include <QRegExp>
+#include <QTimer>
+
+using namespace GammaRay;
+
+class ObjectSearchProxyModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    void createProbe()
+    {
+        Hooks::installHooks();
+        Probe::startupHookReceived();
+        new ProbeCreator(ProbeCreator::Create);
+        QTest::qWait(1); // event loop re-entry
+    }
+
+    static bool contains(QAbstractItemModel *model, QObject *obj)
+    {
+        const auto l = model->match(model->index(0, 0), ObjectModel::ObjectRole,
+                                    QVariant::fromValue(obj), 1,
+                                    Qt::MatchRecursive | Qt::MatchExactly);
+        return l.size() == 1;
+    }
+
+    static void setFilter(ObjectSearchProxyModel *model, const QString &text)
+    {
+        model->setFilterRegExp(QRegExp(text, Qt::CaseInsensitive, QRegExp::FixedString));
+    }
+
+private slots:
+    void initTestCase()
+    {
+        createProbe();
+    }
+
+    void testSearch()
+    {
+        QObject parent;
+        parent.setObjectName(QStringLiteral("searchParent"));
+        auto named = new QObject(&parent);
+        named->setObjectName(QStringLiteral("searchTargetObject"));
+        auto other = new QObject(&parent);
+        other->setObjectName(QStringLiteral("searchOther"));
+        auto timer = new QTimer(&parent);
+        QTest::qWait(1); // queued object creation
+
+        ObjectSearchProxyModel model;
+        model.setSourceModel(Probe::instance()->objectTreeModel());
+        model.setFilterKeyColumn(-1);
+
+        setFilter(&model, QStringLiteral("SEARCHT"));
+        QVERIFY(contains(&model, named));
+        QVERIFY(contains(&model, &parent)); // ancestor of a match
+        QVERIFY(!contains(&model, other));
+        QVERIFY(!contains(&model, timer));
+
+        // refinement
+        setFilter(&model, QStringLiteral("searchtargetobj"));
+        QVERIFY(contains(&model, named));
+        QVERIFY(!contains(&model, other));
+
+        // unrelated query, matching the type name
+        setFilter(&model, QStringLiteral("qtimer"));
+        QVERIFY(contains(&model, timer));
+        QVERIFY(!contains(&model, named));
+
+        // the type name is not considered when only searching the first column
+        model.setFilterKeyColumn(0);
+        QVERIFY(!contains(&model, timer));
+
+        setFilter(&model, Util::addressToString(timer));
+        QVERIFY(contains(&model, timer));
+        QVERIFY(!contains(&model, named));
+        model.setFilterKeyColumn(-1);
+
+        // named objects don't show their address, so they don't match it either
+        setFilter(&model, Util::addressToString(named));
+        QVERIFY(!contains(&model, named));
+        setFilter(&model, Util::addressToString(named).mid(2));
+        QVERIFY(!contains(&model, named));
+        setFilter(&model, Util::addressToString(timer).mid(2));
+        QVERIFY(contains(&model, timer));
+
+        // objects added while the filter is active
+        setFilter(&model, QStringLiteral("searchlate"));
+        auto late = new QObject(&parent);
+        late->setObjectName(QStringLiteral("searchLateObject"));
+        QTest::qWait(1);
+        QVERIFY(contains(&model, late));
+
+        delete late;
+        QTest::qWait(1);
+        QVERIFY(!contains(&model, late));
+    }
+};
+
+QTEST_MAIN(ObjectSearchProxyModelTest)
+
+#include "objectsearchproxymodeltest.moc"
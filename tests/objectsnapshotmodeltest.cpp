@@ -0,0 +1,204 @@
+/*
+  objectsnapshotmodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/tools/objectsnapshot/objectsnapshotdata.h>
+#include <core/tools/objectsnapshot/objectsnapshotmodel.h>
+#include <common/tools/objectsnapshot/objectsnapshotroles.h>
+
+#include <3rdparty/qt/modeltest.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+#include <QRect>
+
+using namespace GammaRay;
+
+class ObjectSnapshotModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void addObject(ObjectSnapshotData &snapshot, quint64 address, qint32 parent,
+                          quint16 classId, const QString &name,
+                          const QVariant &enabled = QVariant())
+    {
+        ObjectSnapshotData::Object obj;
+        obj.address = address;
+        obj.parent = parent;
+        obj.classId = classId;
+        obj.objectName = name;
+        if (enabled.isValid()) {
+            ObjectSnapshotData::PropertyValue prop;
+            prop.propertyId = 0;
+            prop.value = enabled;
+            obj.properties.push_back(prop);
+        }
+        snapshot.objects.push_back(obj);
+    }
+
+    static ObjectSnapshotData createSnapshot()
+    {
+        ObjectSnapshotData snapshot;
+        snapshot.classNames << "QObject" << "QTimer";
+        snapshot.propertyNames << "enabled";
+        return snapshot;
+    }
+
+    static QModelIndex indexForName(const QAbstractItemModel *model, const QString &name,
+                                    const QModelIndex &parent = QModelIndex())
+    {
+        for (int i = 0; i < model->rowCount(parent); ++i) {
+            const QModelIndex index = model->index(i, 0, parent);
+            if (index.data().toString() == name)
+                return index;
+        }
+        return QModelIndex();
+    }
+
+    static int diffState(const QModelIndex &index)
+    {
+        return index.data(ObjectSnapshotRoles::DiffStateRole).toInt();
+    }
+
+private slots:
+    void testEncodeDecode()
+    {
+        ObjectSnapshotData snapshot = createSnapshot();
+        addObject(snapshot, 0x1000, -1, 0, QStringLiteral("root"), true);
+        addObject(snapshot, 0x2000, 0, 1, QStringLiteral("timer"));
+        addObject(snapshot, 0x3000, 1, 0, QString(), QRect(1, 2, 3, 4));
+
+        const QByteArray data = snapshot.encode();
+        QVERIFY(!data.isEmpty());
+        const ObjectSnapshotData decoded = ObjectSnapshotData::decode(data);
+        QCOMPARE(decoded.classNames, snapshot.classNames);
+        QCOMPARE(decoded.propertyNames, snapshot.propertyNames);
+        QCOMPARE(decoded.objects.size(), 3);
+        for (int i = 0; i < decoded.objects.size(); ++i) {
+            QCOMPARE(decoded.objects.at(i).address, snapshot.objects.at(i).address);
+            QCOMPARE(decoded.objects.at(i).parent, snapshot.objects.at(i).parent);
+            QCOMPARE(decoded.objects.at(i).classId, snapshot.objects.at(i).classId);
+            QCOMPARE(decoded.objects.at(i).objectName, snapshot.objects.at(i).objectName);
+            QCOMPARE(decoded.objects.at(i).properties.size(), snapshot.objects.at(i).properties.size());
+        }
+        QCOMPARE(decoded.objects.at(2).properties.at(0).value, QVariant(QRect(1, 2, 3, 4)));
+
+        QVERIFY(ObjectSnapshotData::decode(QByteArray("garbage")).objects.isEmpty());
+    }
+
+    void testCapturedValue()
+    {
+        QCOMPARE(ObjectSnapshotData::capturedValue(QVariant(true)), QVariant(true));
+        QCOMPARE(ObjectSnapshotData::capturedValue(QRect(1, 2, 3, 4)), QVariant(QRect(1, 2, 3, 4)));
+        QVERIFY(!ObjectSnapshotData::capturedValue(QVariant()).isValid());
+
+        const QVariant pointer = ObjectSnapshotData::capturedValue(QVariant::fromValue<QObject *>(this));
+        QCOMPARE(pointer.type(), QVariant::String);
+    }
+
+    void testSnapshot()
+    {
+        ObjectSnapshotModel model;
+        ModelTest modelTest(&model);
+        QCOMPARE(model.rowCount(), 0);
+
+        ObjectSnapshotData snapshot = createSnapshot();
+        addObject(snapshot, 0x1000, -1, 0, QStringLiteral("root"), true);
+        addObject(snapshot, 0x2000, 0, 1, QStringLiteral("timer"));
+        addObject(snapshot, 0x3000, -1, 0, QStringLiteral("other"));
+        model.setSnapshot(snapshot);
+
+        QCOMPARE(model.rowCount(), 2);
+        const QModelIndex root = indexForName(&model, QStringLiteral("root"));
+        QVERIFY(root.isValid());
+        QCOMPARE(model.rowCount(root), 1);
+        const QModelIndex timer = indexForName(&model, QStringLiteral("timer"), root);
+        QVERIFY(timer.isValid());
+        QCOMPARE(timer.sibling(timer.row(), 1).data().toString(), QStringLiteral("QTimer"));
+        QCOMPARE(diffState(timer), static_cast<int>(ObjectSnapshotRoles::Unchanged));
+
+        model.setSnapshot(ObjectSnapshotData());
+        QCOMPARE(model.rowCount(), 0);
+    }
+
+    void testDiff()
+    {
+        ObjectSnapshotData base = createSnapshot();
+        addObject(base, 0x1000, -1, 0, QStringLiteral("root"), true);
+        addObject(base, 0x2000, 0, 1, QStringLiteral("timer"), true);
+        addObject(base, 0x3000, 0, 0, QStringLiteral("removed"));
+        addObject(base, 0x4000, 2, 0, QStringLiteral("removedChild"));
+        addObject(base, 0x5000, 0, 0, QStringLiteral("unchanged"));
+        addObject(base, 0x6000, 0, 0, QStringLiteral("replaced"));
+
+        ObjectSnapshotData snapshot = createSnapshot();
+        addObject(snapshot, 0x1000, -1, 0, QStringLiteral("renamed"), true);
+        addObject(snapshot, 0x2000, 0, 1, QStringLiteral("timer"), false);
+        addObject(snapshot, 0x5000, 0, 0, QStringLiteral("unchanged"));
+        addObject(snapshot, 0x6000, 0, 1, QStringLiteral("replaced"));
+        addObject(snapshot, 0x7000, 0, 0, QStringLiteral("added"));
+
+        ObjectSnapshotModel model;
+        ModelTest modelTest(&model);
+        model.setSnapshot(snapshot, &base);
+
+        QCOMPARE(model.rowCount(), 1);
+        const QModelIndex root = indexForName(&model, QStringLiteral("renamed"));
+        QVERIFY(root.isValid());
+        QCOMPARE(diffState(root), static_cast<int>(ObjectSnapshotRoles::Changed));
+        QVERIFY(root.data(Qt::ToolTipRole).toString().contains(QStringLiteral("objectName")));
+
+        // the remaining children plus the removed ones, below their former parent
+        QCOMPARE(model.rowCount(root), 6);
+        QCOMPARE(diffState(indexForName(&model, QStringLiteral("timer"), root)),
+                 static_cast<int>(ObjectSnapshotRoles::Changed));
+        QCOMPARE(diffState(indexForName(&model, QStringLiteral("unchanged"), root)),
+                 static_cast<int>(ObjectSnapshotRoles::Unchanged));
+        QCOMPARE(diffState(indexForName(&model, QStringLiteral("added"), root)),
+                 static_cast<int>(ObjectSnapshotRoles::Added));
+
+        const QModelIndex removed = indexForName(&model, QStringLiteral("removed"), root);
+        QCOMPARE(diffState(removed), static_cast<int>(ObjectSnapshotRoles::Removed));
+        QCOMPARE(model.rowCount(removed), 1);
+        QCOMPARE(diffState(model.index(0, 0, removed)), static_cast<int>(ObjectSnapshotRoles::Removed));
+
+        // same address but a different type is a new object
+        int replacedCount = 0;
+        for (int i = 0; i < model.rowCount(root); ++i) {
+            const QModelIndex index = model.index(i, 0, root);
+            if (index.data().toString() != QLatin1String("replaced"))
+                continue;
+            ++replacedCount;
+            QVERIFY(diffState(index) == ObjectSnapshotRoles::Added
+                    || diffState(index) == ObjectSnapshotRoles::Removed);
+        }
+        QCOMPARE(replacedCount, 2);
+    }
+};
+
+QTEST_MAIN(ObjectSnapshotModelTest)
+
+#include "objectsnapshotmodeltest.moc"
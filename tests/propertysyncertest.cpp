@@ -38,6 +38,7 @@ using namespace GammaRay;
 class MyObject : public QObject
 {
     Q_PROPERTY(int intProp READ intProp WRITE setIntProp NOTIFY intPropChanged)
+    Q_PROPERTY(QString stringProp READ stringProp WRITE setStringProp NOTIFY stringPropChanged)
     Q_OBJECT
 public:
     explicit MyObject(QObject *parent = nullptr)
@@ -52,11 +53,22 @@ public:
         emit intPropChanged();
     }
 
+    QString stringProp() { return p2; }
+    void setStringProp(const QString &s)
+    {
+        if (p2 == s)
+            return;
+        p2 = s;
+        emit stringPropChanged();
+    }
+
 signals:
     void intPropChanged();
+    void stringPropChanged();
 
 private:
     int p1;
+    QString p2;
 };
 
 class PropertySyncerTest : public QObject
@@ -100,7 +112,36 @@ public slots:
         m_server->handleMessage(Message::readMessage(&buffer));
     }
 
+private:
+    void createSyncers(MyObject *serverObj, MyObject *clientObj)
+    {
+        m_server = new PropertySyncer(this);
+        connect(m_server, SIGNAL(message(GammaRay::Message)), this,
+                SLOT(server2client(GammaRay::Message)));
+        m_server->setAddress(1);
+        m_server->addObject(42, serverObj);
+        m_server->setObjectEnabled(42, true);
+
+        m_client = new PropertySyncer(this);
+        m_client->setRequestInitialSync(true);
+        connect(m_client, SIGNAL(message(GammaRay::Message)), this,
+                SLOT(client2server(GammaRay::Message)));
+        m_client->setAddress(1);
+        m_client->addObject(42, clientObj);
+        m_client->setObjectEnabled(42, true);
+    }
+
 private slots:
+    void init()
+    {
+        delete m_client;
+        m_client = nullptr;
+        delete m_server;
+        m_server = nullptr;
+        m_server2ClientCount = 0;
+        m_client2ServerCount = 0;
+    }
+
     void testSync()
     {
         // server setup
@@ -131,22 +172,110 @@ private slots:
         QCOMPARE(m_server2ClientCount, 1);
         QCOMPARE(clientObj->intProp(), 14);
 
-        // regular sync on changes on one side
+        // regular sync on changes on one side, sent with the next event loop iteration
         serverObj.setIntProp(42);
+        QCOMPARE(m_server2ClientCount, 1);
+        QTest::qWait(1);
         QCOMPARE(m_server2ClientCount, 2);
         QCOMPARE(clientObj->intProp(), 42);
 
         QCOMPARE(m_client2ServerCount, 1);
         clientObj->setIntProp(23);
+        QTest::qWait(1);
         QCOMPARE(serverObj.intProp(), 23);
         QCOMPARE(m_client2ServerCount, 2);
         QCOMPARE(m_server2ClientCount, 2);
 
+        // multiple changes are merged into one message
+        serverObj.setIntProp(1);
+        serverObj.setIntProp(2);
+        serverObj.setStringProp(QLatin1String("foo"));
+        QTest::qWait(1);
+        QCOMPARE(m_server2ClientCount, 3);
+        QCOMPARE(clientObj->intProp(), 2);
+        QCOMPARE(clientObj->stringProp(), QString::fromLatin1("foo"));
+
         // client destroyed
         m_server->setObjectEnabled(42, false);
         delete clientObj;
         serverObj.setIntProp(26);
-        QCOMPARE(m_server2ClientCount, 2);
+        QTest::qWait(1);
+        QCOMPARE(m_server2ClientCount, 3);
+    }
+
+    void testReconnect()
+    {
+        MyObject serverObj;
+        serverObj.setIntProp(14);
+        MyObject clientObj;
+        createSyncers(&serverObj, &clientObj);
+        QCOMPARE(clientObj.intProp(), 14);
+
+        // a new client doesn't know the property ids announced to the previous one
+        MyObject newClientObj;
+        delete m_client;
+        m_client = new PropertySyncer(this);
+        m_client->setRequestInitialSync(true);
+        connect(m_client, SIGNAL(message(GammaRay::Message)), this,
+                SLOT(client2server(GammaRay::Message)));
+        m_client->setAddress(1);
+        m_client->addObject(42, &newClientObj);
+        m_server->resetPeerState();
+        m_client->setObjectEnabled(42, true);
+        QCOMPARE(newClientObj.intProp(), 14);
+
+        serverObj.setIntProp(15);
+        serverObj.setStringProp(QStringLiteral("foo"));
+        QTest::qWait(1);
+        QCOMPARE(newClientObj.intProp(), 15);
+        QCOMPARE(newClientObj.stringProp(), QStringLiteral("foo"));
+    }
+
+    void testConcurrentChanges()
+    {
+        MyObject serverObj;
+        MyObject clientObj;
+        createSyncers(&serverObj, &clientObj);
+        const int client2ServerCount = m_client2ServerCount;
+
+        // both sides change the same property before either change is sent, the first one
+        // to arrive wins and the pending change on the receiving side is dropped
+        clientObj.setIntProp(5);
+        serverObj.setIntProp(7);
+        m_server->flushPendingChanges(42);
+        QCOMPARE(clientObj.intProp(), 7);
+        QTest::qWait(1);
+        QCOMPARE(m_client2ServerCount, client2ServerCount);
+        QCOMPARE(serverObj.intProp(), 7);
+
+        // other pending properties are still sent
+        clientObj.setStringProp(QStringLiteral("foo"));
+        clientObj.setIntProp(8);
+        serverObj.setIntProp(9);
+        m_server->flushPendingChanges(42);
+        QTest::qWait(1);
+        QCOMPARE(m_client2ServerCount, client2ServerCount + 1);
+        QCOMPARE(serverObj.stringProp(), QStringLiteral("foo"));
+        QCOMPARE(serverObj.intProp(), 9);
+        QCOMPARE(clientObj.intProp(), 9);
+    }
+
+    void testFlush()
+    {
+        MyObject serverObj;
+        MyObject clientObj;
+        createSyncers(&serverObj, &clientObj);
+        const int server2ClientCount = m_server2ClientCount;
+
+        m_server->flushPendingChanges(42);
+        QCOMPARE(m_server2ClientCount, server2ClientCount);
+
+        serverObj.setIntProp(3);
+        m_server->flushPendingChanges(42);
+        QCOMPARE(m_server2ClientCount, server2ClientCount + 1);
+        QCOMPARE(clientObj.intProp(), 3);
+        QTest::qWait(1);
+        QCOMPARE(m_server2ClientCount, server2ClientCount + 1);
     }
 
 private:
@@ -28,6 +28,7 @@
 
 #include <core/remote/remotemodelserver.h>
 #include <client/remotemodel.h>
+#include <common/compactpayload.h>
 #include <common/message.h>
 
 #include <QBuffer>
@@ -40,6 +41,7 @@
 using namespace GammaRay;
 
 static void fakeRegisterServer() {}
+static Protocol::PayloadEncoding s_payloadEncoding = Protocol::DataStreamEncoding;
 
 namespace GammaRay {
 class FakeRemoteModelServer : public RemoteModelServer
@@ -48,6 +50,9 @@ class FakeRemoteModelServer : public RemoteModelServer
 public:
     explicit FakeRemoteModelServer(const QString &objectName, QObject *parent = nullptr)
         : RemoteModelServer(objectName, parent)
+        , contentChangedCount(0)
+        , contentReplyCount(0)
+        , appendedContentReplyCount(0)
     {
         m_myAddress = 42;
     }
@@ -57,6 +62,22 @@ public:
         FakeRemoteModelServer::s_registerServerCallback = &fakeRegisterServer;
     }
 
+    mutable int contentChangedCount;
+    mutable int contentReplyCount;
+    mutable int appendedContentReplyCount;
+
+    void fetch(int first, int last)
+    {
+        for (int row = first; row <= last; ++row)
+            markFetched(m_model->index(row, 0));
+    }
+
+    /// fetched root rows as (first, last), (1, 0) if there are none
+    QPair<int, int> fetchedRootRows() const
+    {
+        return qMakePair(m_fetchedRootRows.first, m_fetchedRootRows.last);
+    }
+
 signals:
     void message(const GammaRay::Message &msg);
 
@@ -64,6 +85,12 @@ private:
     bool isConnected() const Q_DECL_OVERRIDE { return true; }
     void sendMessage(const Message &msg) const Q_DECL_OVERRIDE
     {
+        if (msg.type() == Protocol::ModelContentChanged)
+            ++contentChangedCount;
+        else if (msg.type() == Protocol::ModelContentReply)
+            ++contentReplyCount;
+        else if (msg.type() == Protocol::ModelAppendedContentReply)
+            ++appendedContentReplyCount;
         QByteArray ba;
         QBuffer buffer(&ba);
         buffer.open(QIODevice::ReadWrite);
@@ -71,6 +98,7 @@ private:
         buffer.seek(0);
         emit const_cast<FakeRemoteModelServer *>(this)->message(Message::readMessage(&buffer));
     }
+    Protocol::PayloadEncoding payloadEncoding() const Q_DECL_OVERRIDE { return s_payloadEncoding; }
 };
 
 class FakeRemoteModel : public RemoteModel
@@ -79,6 +107,7 @@ class FakeRemoteModel : public RemoteModel
 public:
     explicit FakeRemoteModel(const QString &serverObject, QObject *parent = nullptr)
         : RemoteModel(serverObject, parent)
+        , holdMessages(false)
     {
         m_myAddress = 42;
     }
@@ -88,6 +117,21 @@ public:
         FakeRemoteModel::s_registerClientCallback = &fakeRegisterServer;
     }
 
+    /// delays outgoing messages until releaseMessages(), to simulate transfer latency
+    bool holdMessages;
+
+    void releaseMessages()
+    {
+        holdMessages = false;
+        const QVector<QByteArray> messages = m_heldMessages;
+        m_heldMessages.clear();
+        foreach (QByteArray ba, messages) {
+            QBuffer buffer(&ba);
+            buffer.open(QIODevice::ReadOnly);
+            emit message(Message::readMessage(&buffer));
+        }
+    }
+
 signals:
     void message(const GammaRay::Message &msg);
 
@@ -98,9 +142,16 @@ private:
         QBuffer buffer(&ba);
         buffer.open(QIODevice::ReadWrite);
         msg.write(&buffer);
+        if (holdMessages) {
+            m_heldMessages.push_back(ba);
+            return;
+        }
         buffer.seek(0);
         emit const_cast<FakeRemoteModel *>(this)->message(Message::readMessage(&buffer));
     }
+
+    mutable QVector<QByteArray> m_heldMessages;
+    Protocol::PayloadEncoding payloadEncoding() const Q_DECL_OVERRIDE { return s_payloadEncoding; }
 };
 }
 
@@ -292,6 +343,391 @@ private slots:
 
         delete treeModel;
     }
+
+    void testDataChangedCoalescing()
+    {
+        auto listModel = new QStandardItemModel(this);
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QString::number(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.DataChanged"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.DataChanged"), this);
+        connect(&server, SIGNAL(message(GammaRay::Message)), &client,
+                SLOT(newMessage(GammaRay::Message)));
+        connect(&client, SIGNAL(message(GammaRay::Message)), &server,
+                SLOT(newRequest(GammaRay::Message)));
+
+        client.rowCount();
+        QTest::qWait(10);
+        QCOMPARE(client.rowCount(), 100);
+        auto index = client.index(1, 0);
+        index.data(); // need an event loop entry for the data retrieval
+        QTest::qWait(1);
+        QCOMPARE(index.data().toString(), QStringLiteral("1"));
+
+        // 100 single-cell changes, of which only the fetched row reaches the client
+        for (int i = 0; i < 100; ++i)
+            listModel->item(i)->setText(QStringLiteral("changed %1").arg(i));
+        QCOMPARE(server.contentChangedCount, 0);
+        QTest::qWait(50);
+        QCOMPARE(server.contentChangedCount, 1);
+
+        index.data();
+        QTest::qWait(1);
+        QCOMPARE(index.data().toString(), QStringLiteral("changed 1"));
+
+        // pending changes go out before structural changes invalidate their rows
+        listModel->item(1)->setText(QStringLiteral("changed again"));
+        listModel->insertRow(0, new QStandardItem(QStringLiteral("new")));
+        QCOMPARE(server.contentChangedCount, 2);
+        QCOMPARE(client.rowCount(), 101);
+
+        delete listModel;
+    }
+
+    void testFetchedRowsRemoval_data()
+    {
+        QTest::addColumn<int>("start");
+        QTest::addColumn<int>("end");
+        QTest::addColumn<int>("first");
+        QTest::addColumn<int>("last");
+
+        // fetched rows are [10, 20]
+        QTest::newRow("before") << 0 << 4 << 5 << 15;
+        QTest::newRow("after") << 30 << 40 << 10 << 20;
+        QTest::newRow("head") << 5 << 12 << 5 << 12;
+        QTest::newRow("tail") << 15 << 25 << 10 << 14;
+        QTest::newRow("middle") << 12 << 14 << 10 << 17;
+        QTest::newRow("exact") << 10 << 20 << 1 << 0;
+        QTest::newRow("all") << 5 << 25 << 1 << 0;
+    }
+
+    void testFetchedRowsRemoval()
+    {
+        QFETCH(int, start);
+        QFETCH(int, end);
+        QFETCH(int, first);
+        QFETCH(int, last);
+
+        auto listModel = new QStandardItemModel(this);
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QString::number(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.FetchedRows"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+        server.fetch(10, 20);
+        QCOMPARE(server.fetchedRootRows(), qMakePair(10, 20));
+
+        listModel->removeRows(start, end - start + 1);
+        QCOMPARE(server.fetchedRootRows(), qMakePair(first, last));
+
+        // changes to the remaining fetched rows still reach the client
+        if (first <= last) {
+            listModel->item(last)->setText(QStringLiteral("changed"));
+            QTest::qWait(50);
+            QCOMPARE(server.contentChangedCount, 1);
+        }
+
+        delete listModel;
+    }
+
+    void testCacheEviction()
+    {
+        auto listModel = new QStandardItemModel(this);
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QString::number(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.Eviction"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.Eviction"), this);
+        connect(&server, SIGNAL(message(GammaRay::Message)), &client,
+                SLOT(newMessage(GammaRay::Message)));
+        connect(&client, SIGNAL(message(GammaRay::Message)), &server,
+                SLOT(newRequest(GammaRay::Message)));
+        client.setMaxCachedRows(20);
+
+        client.rowCount();
+        QTest::qWait(10);
+        QCOMPARE(client.rowCount(), 100);
+        for (int i = 0; i < 100; ++i) {
+            client.index(i, 0).data(); // need an event loop entry for the data retrieval
+            QTest::qWait(1);
+        }
+
+        // the most recently used rows are still there, the oldest ones are gone
+        auto state = client.index(99, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+        state = client.index(0, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QVERIFY(state & RemoteModelNodeState::Empty);
+
+        // evicted content is refetched transparently
+        auto index = client.index(0, 0);
+        index.data();
+        QTest::qWait(1);
+        QCOMPARE(index.data().toString(), QStringLiteral("0"));
+
+        delete listModel;
+    }
+
+    void testViewportPrefetch()
+    {
+        auto listModel = new QStandardItemModel(this);
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QString::number(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.Prefetch"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.Prefetch"), this);
+        connect(&server, SIGNAL(message(GammaRay::Message)), &client,
+                SLOT(newMessage(GammaRay::Message)));
+        connect(&client, SIGNAL(message(GammaRay::Message)), &server,
+                SLOT(newRequest(GammaRay::Message)));
+
+        client.rowCount();
+        QTest::qWait(10);
+        QCOMPARE(client.rowCount(), 100);
+
+        // scrolling down prefetches below the viewport
+        client.setViewport(client.index(40, 0), 10);
+        QTest::qWait(1);
+        auto state = client.index(40, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+        state = client.index(60, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+        state = client.index(39, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QVERIFY(state & RemoteModelNodeState::Empty);
+
+        // scrolling up prefetches above it
+        client.setViewport(client.index(30, 0), 10);
+        QTest::qWait(1);
+        state = client.index(10, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+
+        // scattered rows, as seen through a sorting proxy, are fetched exactly
+        client.setVisibleRows(QModelIndexList() << client.index(95, 0) << client.index(80, 0));
+        QTest::qWait(1);
+        state = client.index(95, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+        state = client.index(80, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QCOMPARE(int(state), int(RemoteModelNodeState::NoState));
+        state = client.index(90, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        QVERIFY(state & RemoteModelNodeState::Empty);
+
+        delete listModel;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    void testAppendOnlyChanges()
+    {
+        const int role = Qt::UserRole + 1;
+        auto listModel = new QStandardItemModel(this);
+        for (int i = 0; i < 10; ++i) {
+            auto item = new QStandardItem(QString::number(i));
+            item->setData(QVariantList() << 0, role);
+            listModel->appendRow(item);
+        }
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.AppendOnly"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.AppendOnly"), this);
+        connect(&server, SIGNAL(message(GammaRay::Message)), &client,
+                SLOT(newMessage(GammaRay::Message)));
+        connect(&client, SIGNAL(message(GammaRay::Message)), &server,
+                SLOT(newRequest(GammaRay::Message)));
+
+        client.rowCount();
+        QTest::qWait(10);
+        QCOMPARE(client.rowCount(), 10);
+        auto index = client.index(1, 0);
+        index.data(); // need an event loop entry for the data retrieval
+        QTest::qWait(1);
+        QCOMPARE(index.data(role).toList(), QVariantList() << 0);
+        const int contentReplies = server.contentReplyCount;
+
+        auto append = [listModel, role](int row, int value) {
+            auto item = listModel->item(row);
+            listModel->blockSignals(true);
+            item->setData(item->data(role).toList() << value, role);
+            listModel->blockSignals(false);
+            const auto idx = item->index();
+            emit listModel->dataChanged(idx, idx, QVector<int>() << role << RemoteModelRole::AppendOnly);
+        };
+
+        // only the new elements are transferred
+        append(1, 1);
+        append(1, 2);
+        QTest::qWait(50);
+        QCOMPARE(index.data(role).toList(), QVariantList() << 0 << 1 << 2);
+        QCOMPARE(server.contentReplyCount, contentReplies);
+        QCOMPARE(server.appendedContentReplyCount, 1);
+
+        // a full change merged with it requires a full refetch
+        append(1, 3);
+        listModel->item(1)->setText(QStringLiteral("changed"));
+        QTest::qWait(50);
+        index.data();
+        QTest::qWait(1);
+        QCOMPARE(index.data().toString(), QStringLiteral("changed"));
+        QCOMPARE(index.data(role).toList(), QVariantList() << 0 << 1 << 2 << 3);
+        QCOMPARE(server.contentReplyCount, contentReplies + 1);
+        QCOMPARE(server.appendedContentReplyCount, 1);
+
+        // the value gets replaced while the request for the appended elements is underway
+        client.holdMessages = true;
+        append(1, 4);
+        QVERIFY(QMetaObject::invokeMethod(&server, "sendDataChanged"));
+        const QVariantList replaced = QVariantList() << 10 << 11 << 12 << 13 << 14 << 15;
+        listModel->item(1)->setData(replaced, role);
+        client.releaseMessages();
+        // not the tail of the new value appended to the old one
+        QCOMPARE(index.data(role).toList(), QVariantList() << 0 << 1 << 2 << 3);
+        QTest::qWait(50);
+        index.data();
+        QTest::qWait(1);
+        QCOMPARE(index.data(role).toList(), replaced);
+
+        delete listModel;
+    }
+#endif
+
+    void testCompactEncoding()
+    {
+        s_payloadEncoding = Protocol::CompactEncoding;
+
+        auto listModel = new QStandardItemModel(this);
+        auto item = new QStandardItem(QStringLiteral("entry0"));
+        item->setToolTip(QStringLiteral("tooltip"));
+        item->setData(-42, Qt::UserRole);
+        item->setData(3.5, Qt::UserRole + 1);
+        item->setData(true, Qt::UserRole + 2);
+        item->setData(QByteArray("bytes"), Qt::UserRole + 3);
+        item->setData(QSize(16, 8), Qt::UserRole + 4);
+        listModel->appendRow(item);
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.CompactModel"), this);
+        server.setModel(listModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.CompactModel"), this);
+        connect(&server, SIGNAL(message(GammaRay::Message)), &client,
+                SLOT(newMessage(GammaRay::Message)));
+        connect(&client, SIGNAL(message(GammaRay::Message)), &server,
+                SLOT(newRequest(GammaRay::Message)));
+
+        ModelTest modelTest(&client);
+        QTest::qWait(10);
+
+        QCOMPARE(client.rowCount(), 1);
+        auto index = client.index(0, 0);
+        index.data(); // need an event loop entry for the data retrieval
+        QTest::qWait(1);
+        QCOMPARE(index.data().toString(), QStringLiteral("entry0"));
+        QCOMPARE(index.data(Qt::ToolTipRole).toString(), QStringLiteral("tooltip"));
+        QCOMPARE(index.data(Qt::UserRole), QVariant(-42));
+        QCOMPARE(index.data(Qt::UserRole + 1), QVariant(3.5));
+        QCOMPARE(index.data(Qt::UserRole + 2), QVariant(true));
+        QCOMPARE(index.data(Qt::UserRole + 3), QVariant(QByteArray("bytes")));
+        QCOMPARE(index.data(Qt::UserRole + 4), QVariant(QSize(16, 8)));
+
+        delete listModel;
+        s_payloadEncoding = Protocol::DataStreamEncoding;
+    }
+
+    void benchmarkContentReply_data()
+    {
+        QTest::addColumn<int>("encoding");
+        QTest::newRow("QDataStream") << static_cast<int>(Protocol::DataStreamEncoding);
+        QTest::newRow("compact") << static_cast<int>(Protocol::CompactEncoding);
+    }
+
+    // encoding and decoding of a model content reply for a larger object list, as done by
+    // RemoteModelServer and RemoteModel
+    void benchmarkContentReply()
+    {
+        QFETCH(int, encoding);
+
+        QStandardItemModel model(5000, 2);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                auto item = new QStandardItem(QStringLiteral("QObject %1").arg(row));
+                item->setToolTip(QStringLiteral("Address: 0x%1").arg(row, 0, 16));
+                item->setData(row, Qt::UserRole);
+                model.setItem(row, column, item);
+            }
+        }
+        QVector<QModelIndex> indexes;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column)
+                indexes.push_back(model.index(row, column));
+        }
+
+        int payloadSize = 0;
+        QBENCHMARK {
+            Message msg(42, Protocol::ModelContentReply);
+            if (encoding == Protocol::CompactEncoding) {
+                CompactPayloadWriter writer(&msg.rawPayload(), indexes.size() * 64);
+                writer.writeUInt(indexes.size());
+                foreach (const auto &index, indexes) {
+                    writer.writeModelIndex(Protocol::fromQModelIndex(index));
+                    writer.writeItemData(model.itemData(index));
+                    writer.writeUInt(static_cast<quint32>(model.flags(index)));
+                }
+            } else {
+                msg << quint32(indexes.size());
+                foreach (const auto &index, indexes)
+                    msg << Protocol::fromQModelIndex(index) << model.itemData(index)
+                        << qint32(model.flags(index));
+            }
+
+            QByteArray ba;
+            QBuffer buffer(&ba);
+            buffer.open(QIODevice::ReadWrite);
+            msg.write(&buffer);
+            buffer.seek(0);
+            const Message reply = Message::readMessage(&buffer);
+            payloadSize = reply.size();
+
+            if (encoding == Protocol::CompactEncoding) {
+                CompactPayloadReader reader(reply.rawPayload());
+                const quint32 size = reader.readUInt();
+                for (quint32 i = 0; i < size; ++i) {
+                    reader.readModelIndex();
+                    reader.readItemData();
+                    reader.readUInt();
+                }
+                QVERIFY(!reader.hasError());
+            } else {
+                quint32 size;
+                reply >> size;
+                for (quint32 i = 0; i < size; ++i) {
+                    Protocol::ModelIndex index;
+                    QHash<int, QVariant> itemData;
+                    qint32 flags;
+                    reply >> index >> itemData >> flags;
+                }
+            }
+        }
+
+        // the QDataStream row runs first, the compact encoding has to beat it
+        static int dataStreamPayloadSize = 0;
+        QVERIFY(payloadSize > 0);
+        if (encoding == Protocol::CompactEncoding) {
+            QVERIFY(dataStreamPayloadSize > 0);
+            QVERIFY(payloadSize < dataStreamPayloadSize);
+        } else {
+            dataStreamPayloadSize = payloadSize;
+        }
+    }
 };
 
 QTEST_MAIN(RemoteModelTest)
@@ -0,0 +1,119 @@
+/*
+  signaleventstoretest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <plugins/signalmonitor/signaleventstore.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+
+#include <limits>
+
+using namespace GammaRay;
+
+static qint64 timestamp(qint64 ev)
+{
+    return ev >> 16;
+}
+
+static int signalIndex(qint64 ev)
+{
+    return ev & 0xffff;
+}
+
+class SignalEventStoreTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testAppendAndQuery()
+    {
+        SignalEventStore store;
+        QVERIFY(store.isEmpty());
+        QCOMPARE(store.lastTimestamp(), -1ll);
+
+        // spans several chunks, with deltas of varying encoded size
+        const int count = 3 * SignalEventStore::ChunkSize + 17;
+        for (int i = 0; i < count; ++i)
+            store.append(i * 1000 + (i % 7) * 150, i % 5);
+        QCOMPARE(store.size(), count);
+        QCOMPARE(store.lastTimestamp(), (count - 1) * 1000ll + ((count - 1) % 7) * 150);
+
+        const auto all = store.events(0, std::numeric_limits<qint64>::max());
+        QCOMPARE(all.size(), count);
+        for (int i = 0; i < count; ++i) {
+            QCOMPARE(timestamp(all.at(i)), i * 1000ll + (i % 7) * 150);
+            QCOMPARE(signalIndex(all.at(i)), i % 5);
+        }
+
+        const qint64 from = (SignalEventStore::ChunkSize - 10) * 1000ll;
+        const qint64 to = (2 * SignalEventStore::ChunkSize + 10) * 1000ll;
+        const auto window = store.events(from, to);
+        QCOMPARE(window.size(), SignalEventStore::ChunkSize + 20);
+        QCOMPARE(store.count(from, to), window.size());
+        QCOMPARE(timestamp(window.first()), from + ((from / 1000) % 7) * 150);
+        QCOMPARE(store.count(0, 1), 1);
+        QCOMPARE(store.count(-1000, 0), 0);
+    }
+
+    void testDensity()
+    {
+        SignalEventStore store;
+        for (int i = 0; i < 100; ++i)
+            store.append(i * 10, 1);
+
+        const auto density = store.density(0, 1000, 10);
+        QCOMPARE(density.size(), 10);
+        foreach (qint64 bucket, density)
+            QCOMPARE(bucket, 10ll);
+
+        const auto partial = store.density(500, 1500, 4);
+        QCOMPARE(partial, QVector<qint64>() << 25 << 25 << 0 << 0);
+    }
+
+    void testEviction()
+    {
+        SignalEventStore store;
+        int chunks = 0;
+        for (int i = 0; i < 2 * SignalEventStore::ChunkSize; ++i) {
+            if (store.append(i, 0))
+                ++chunks;
+        }
+        QCOMPARE(chunks, 2);
+
+        QCOMPARE(store.evictOldestChunk(), int(SignalEventStore::ChunkSize));
+        QCOMPARE(store.size(), int(SignalEventStore::ChunkSize));
+        QCOMPARE(store.count(0, SignalEventStore::ChunkSize), 0);
+        QCOMPARE(store.events(0, 3 * SignalEventStore::ChunkSize).size(), int(SignalEventStore::ChunkSize));
+
+        QCOMPARE(store.evictOldestChunk(), int(SignalEventStore::ChunkSize));
+        QVERIFY(store.isEmpty());
+        QCOMPARE(store.evictOldestChunk(), 0);
+    }
+};
+
+QTEST_MAIN(SignalEventStoreTest)
+
+#include "signaleventstoretest.moc"
@@ -0,0 +1,185 @@
+/*
+  signalhistorymodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <plugins/signalmonitor/signalhistorymodel.h>
+#include <plugins/signalmonitor/signalmonitorcommon.h>
+
+#include <core/probeinterface.h>
+#include <core/signalspycallbackset.h>
+#include <common/remotemodelroles.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+#include <QSignalSpy>
+
+using namespace GammaRay;
+
+namespace GammaRay {
+class FakeProbe : public QObject, public ProbeInterface
+{
+    Q_OBJECT
+public:
+    explicit FakeProbe(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+    QAbstractItemModel *objectListModel() const Q_DECL_OVERRIDE { return nullptr; }
+    QAbstractItemModel *objectTreeModel() const Q_DECL_OVERRIDE { return nullptr; }
+    bool filterObject(QObject *) const Q_DECL_OVERRIDE { return false; }
+    QObject *probe() const Q_DECL_OVERRIDE { return const_cast<FakeProbe *>(this); }
+    void registerModel(const QString &, QAbstractItemModel *) Q_DECL_OVERRIDE {}
+    void installGlobalEventFilter(QObject *) Q_DECL_OVERRIDE {}
+    bool needsObjectDiscovery() const Q_DECL_OVERRIDE { return false; }
+    void discoverObject(QObject *) Q_DECL_OVERRIDE {}
+    void selectObject(QObject *, const QPoint &) Q_DECL_OVERRIDE {}
+    void selectObject(QObject *, const QString &, const QPoint &) Q_DECL_OVERRIDE {}
+    void selectObject(void *, const QString &) Q_DECL_OVERRIDE {}
+    void registerSignalSpyCallbackSet(const SignalSpyCallbackSet &) Q_DECL_OVERRIDE {}
+
+signals:
+    void objectCreated(QObject *obj);
+    void objectDestroyed(QObject *obj);
+};
+}
+
+class SignalHistoryModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void addEvents(QVector<SignalEvent> &events, QObject *sender, int count)
+    {
+        static qint64 timestamp = SignalEvent::currentTimestamp();
+        SignalEvent event;
+        event.sender = sender;
+        event.metaObject = &QObject::staticMetaObject;
+        event.methodIndex = QObject::staticMetaObject.indexOfSignal("destroyed(QObject*)");
+        event.type = SignalEvent::Begin;
+        event.threadId = nullptr;
+        for (int i = 0; i < count; ++i) {
+            event.timestamp = (timestamp += 1000);
+            events.push_back(event);
+        }
+    }
+
+    static int eventCount(SignalHistoryModel *model, int row)
+    {
+        const QModelIndex idx = model->index(row, SignalHistoryModel::EventColumn);
+        return idx.data(SignalHistoryModel::EventsRole).value<QVector<qint64> >().size();
+    }
+
+    /// rows of the dataChanged() signals recorded in @p spy, verifies each covers a single row
+    static QVector<int> changedRows(const QSignalSpy &spy)
+    {
+        QVector<int> rows;
+        for (int i = 0; i < spy.size(); ++i) {
+            const QModelIndex topLeft = spy.at(i).at(0).value<QModelIndex>();
+            const QModelIndex bottomRight = spy.at(i).at(1).value<QModelIndex>();
+            if (topLeft.row() != bottomRight.row())
+                return QVector<int>() << -1;
+            rows.push_back(topLeft.row());
+        }
+        return rows;
+    }
+
+    static bool isAppendOnly(const QSignalSpy &spy, int i)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        return spy.at(i).at(2).value<QVector<int> >().contains(RemoteModelRole::AppendOnly);
+#else
+        Q_UNUSED(spy);
+        Q_UNUSED(i);
+        return false;
+#endif
+    }
+
+private slots:
+    void testEviction()
+    {
+        const int chunkSize = SignalEventStore::ChunkSize;
+
+        FakeProbe probe;
+        SignalHistoryModel model(&probe);
+        model.setMaxEventCount(2 * chunkSize);
+
+        QObject a, b, c;
+        emit probe.objectCreated(&a);
+        emit probe.objectCreated(&b);
+        emit probe.objectCreated(&c);
+        QCOMPARE(model.rowCount(), 3);
+
+        QVector<SignalEvent> events;
+        addEvents(events, &a, chunkSize);
+        addEvents(events, &b, chunkSize - 1);
+        model.onSignalEvents(events);
+        QCOMPARE(eventCount(&model, 0), chunkSize);
+        QCOMPARE(eventCount(&model, 1), chunkSize - 1);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        QSignalSpy spy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+#else
+        QSignalSpy spy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+#endif
+        QVERIFY(spy.isValid());
+
+        // exceeds the limit, drops the oldest chunk, which belongs to a
+        events.clear();
+        addEvents(events, &c, 1);
+        addEvents(events, &b, 1);
+        model.onSignalEvents(events);
+        QCOMPARE(eventCount(&model, 0), 0);
+        QCOMPARE(eventCount(&model, 1), chunkSize);
+        QCOMPARE(eventCount(&model, 2), 1);
+        // only the evicted row is fully updated, the others are still only appended to
+        QCOMPARE(changedRows(spy), QVector<int>() << 0 << 1 << 2);
+        QVERIFY(!isAppendOnly(spy, 0));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        QVERIFY(isAppendOnly(spy, 1));
+        QVERIFY(isAppendOnly(spy, 2));
+#endif
+
+        spy.clear();
+        events.clear();
+        addEvents(events, &a, 1);
+        model.onSignalEvents(events);
+        QCOMPARE(eventCount(&model, 0), 1);
+        QCOMPARE(changedRows(spy), QVector<int>() << 0);
+
+        // lowering the limit evicts the chunk of b next
+        spy.clear();
+        model.setMaxEventCount(chunkSize);
+        QCOMPARE(eventCount(&model, 0), 1);
+        QCOMPARE(eventCount(&model, 1), 0);
+        QCOMPARE(eventCount(&model, 2), 1);
+        QCOMPARE(changedRows(spy), QVector<int>() << 1);
+        QVERIFY(!isAppendOnly(spy, 0));
+    }
+};
+
+QTEST_MAIN(SignalHistoryModelTest)
+
+#include "signalhistorymodeltest.moc"
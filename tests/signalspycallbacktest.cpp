@@ -24,15 +24,28 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <config-gammaray.h>
+
 #include <probe/probecreator.h>
 #include <core/probe.h>
+#include <core/signalindexcache.h>
+#include <core/util.h>
 
 #include <QtTest/qtest.h>
+#include <QMetaMethod>
 #include <QObject>
 #include <QPointer>
+#include <QThread>
 
 using namespace GammaRay;
 
+static QVector<SignalEvent> s_signalEvents;
+
+static void signalEventCallback(const QVector<SignalEvent> &events)
+{
+    s_signalEvents += events;
+}
+
 class Sender : public QObject
 {
     Q_OBJECT
@@ -82,6 +95,64 @@ private slots:
         QVERIFY(s2.isNull());
     }
 
+    void testSignalEvents()
+    {
+        createProbe();
+
+        SignalSpyCallbackSet callbacks;
+        callbacks.signalEventCallback = signalEventCallback;
+        Probe::instance()->registerSignalSpyCallbackSet(callbacks);
+
+        Sender s;
+        QTest::qWait(1); // make sure s is known to the probe
+        s_signalEvents.clear();
+
+        s.emitSignal();
+        QVERIFY(s_signalEvents.isEmpty()); // delivered asynchronously
+        QTest::qWait(100);
+
+        QVector<SignalEvent> events;
+        foreach (const auto &event, s_signalEvents) {
+            if (event.sender == &s)
+                events.push_back(event);
+        }
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events.at(0).type, SignalEvent::Begin);
+        QCOMPARE(events.at(1).type, SignalEvent::End);
+        const int methodIndex = s.metaObject()->indexOfSignal("mySignal()");
+        QCOMPARE(events.at(0).methodIndex, methodIndex);
+        QCOMPARE(events.at(1).methodIndex, methodIndex);
+        QVERIFY(events.at(0).timestamp <= events.at(1).timestamp);
+        QCOMPARE(events.at(0).threadId, QThread::currentThreadId());
+#ifdef HAVE_PRIVATE_QT_HEADERS
+        QCOMPARE(events.at(0).metaObject, s.metaObject());
+#endif
+    }
+
+    void testSignalIndexCache()
+    {
+        Sender s;
+        const QMetaObject *mo = SignalIndexCache::cacheableMetaObject(&s);
+#ifdef HAVE_PRIVATE_QT_HEADERS
+        QCOMPARE(mo, s.metaObject());
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+        int signalIndex = 0;
+        for (int i = 0; i < mo->methodCount(); ++i) {
+            if (mo->method(i).methodType() != QMetaMethod::Signal)
+                continue;
+            QCOMPARE(SignalIndexCache::methodIndex(mo, signalIndex), i);
+            QCOMPARE(SignalIndexCache::methodIndex(mo, signalIndex),
+                     Util::signalIndexToMethodIndex(mo, signalIndex));
+            ++signalIndex;
+        }
+#endif
+        QCOMPARE(SignalIndexCache::signalSignature(mo, mo->indexOfSignal("mySignal()")),
+                 QByteArray("mySignal()"));
+#else
+        QVERIFY(!mo);
+#endif
+    }
+
     void cleanupTestCase()
     {
         // explicitly delete the probe as our usual cleanup doesn't work since we will
@@ -26,11 +26,14 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <plugins/timertop/timerinfo.h>
 #include <plugins/timertop/timermodel.h>
+#include <plugins/timertop/timerthreadmodel.h>
 
 #include <probe/hooks.h>
 #include <probe/probecreator.h>
 #include <core/probe.h>
+#include <core/signalspycallbackset.h>
 #include <common/objectbroker.h>
 #include <common/objectid.h>
 
@@ -39,6 +42,7 @@
 #include <QtTest/qtest.h>
 #include <QObject>
 #include <QSignalSpy>
+#include <QStandardItemModel>
 #include <QTimer>
 
 using namespace GammaRay;
@@ -70,6 +74,25 @@ private:
         return idx;
     }
 
+    static TimerInfo::TimeoutEvent timeoutEvent(qint64 timeStamp, qint64 executionTime)
+    {
+        TimerInfo::TimeoutEvent event;
+        event.timeStamp = timeStamp;
+        event.executionTime = executionTime;
+        return event;
+    }
+
+    static void addThreadRow(QStandardItemModel *model, const QString &thread, int wakeups,
+                             double wakeupsPerSec)
+    {
+        const int row = model->rowCount();
+        model->insertRow(row);
+        model->setData(model->index(row, TimerModel::ThreadColumn), thread);
+        model->setData(model->index(row, TimerModel::TotalWakeupsColumn), wakeups);
+        model->setData(model->index(row, TimerModel::WakeupsPerSecColumn),
+                       QString::number(wakeupsPerSec, 'f', 1));
+    }
+
 private slots:
     void testTimerCreateDestroy()
     {
@@ -144,12 +167,142 @@ private slots:
         QVERIFY(idx.isValid());
         QEXPECT_FAIL("", "still needs to be investigated", Continue);
         QCOMPARE(idx.data(TimerModel::ObjectIdRole).value<ObjectId>(), ObjectId(this));
-        idx = idx.sibling(idx.row(), 6);
+        idx = idx.sibling(idx.row(), TimerModel::TimerIdColumn);
         QVERIFY(idx.isValid());
         QCOMPARE(idx.data().toInt(), timerId);
 
         killTimer(timerId);
     }
+
+    void testWakeupTimePercentiles()
+    {
+        QTimer timer;
+        TimerInfo info(&timer);
+        QCOMPARE(info.wakeupTimePercentile(50), QStringLiteral("N/A"));
+
+        // 1us to 1000us, in scrambled order
+        const qint64 now = SignalEvent::currentTimestamp();
+        for (int i = 0; i < 1000; ++i)
+            info.addEvent(timeoutEvent(now, ((i * 7919) % 1000 + 1) * 1000));
+
+        QCOMPARE(info.totalWakeups(), 1000);
+        QCOMPARE(info.maxWakeupTime(), QStringLiteral("1000.0"));
+
+        // the histogram overestimates by at most 1/8
+        const double median = info.wakeupTimePercentile(50).toDouble();
+        QVERIFY(median >= 500.0);
+        QVERIFY(median <= 500.0 * 9 / 8);
+        const double p99 = info.wakeupTimePercentile(99).toDouble();
+        QVERIFY(p99 >= 990.0);
+        QVERIFY(p99 <= 1000.0);
+        QCOMPARE(info.wakeupTimePercentile(100), QStringLiteral("1000.0"));
+
+        // mostly tiny wakeups
+        TimerInfo smallInfo(&timer);
+        for (int i = 0; i < 100; ++i)
+            smallInfo.addEvent(timeoutEvent(now, i < 90 ? 3000 : 7));
+        QCOMPARE(smallInfo.wakeupTimePercentile(10), QStringLiteral("0.0"));
+        QVERIFY(smallInfo.wakeupTimePercentile(95).toDouble() >= 3.0);
+        QVERIFY(smallInfo.wakeupTimePercentile(95).toDouble() <= 3.0 * 9 / 8);
+
+        // free timers have no execution time
+        TimerInfo freeInfo(42);
+        freeInfo.addEvent(timeoutEvent(now, -1));
+        QCOMPARE(freeInfo.wakeupTimePercentile(50), QStringLiteral("N/A"));
+    }
+
+    void testJitter()
+    {
+        QTimer timer;
+        timer.setInterval(10);
+        TimerInfo info(&timer);
+        QCOMPARE(info.jitter(), QStringLiteral("N/A"));
+
+        // alternating 9ms and 11ms intervals, 1ms off the configured interval
+        const qint64 start = SignalEvent::currentTimestamp() - Q_INT64_C(2000000000);
+        for (int i = 0; i < 100; ++i)
+            info.addEvent(timeoutEvent(start + i * 10000000 + (i % 2) * 1000000, 0));
+        QCOMPARE(info.jitter(), QStringLiteral("1000.0"));
+
+        // without a known interval, the deviation from the average interval is used
+        TimerInfo freeInfo(42);
+        for (int i = 0; i < 100; ++i)
+            freeInfo.addEvent(timeoutEvent(start + i * 20000000, -1));
+        QCOMPARE(freeInfo.jitter(), QStringLiteral("0.0"));
+        QCOMPARE(freeInfo.wakeupsPerSec(), QStringLiteral("50.0"));
+
+        // events older than the statistics time span are ignored
+        TimerInfo oldInfo(42);
+        const qint64 old = SignalEvent::currentTimestamp() - Q_INT64_C(60000000000);
+        for (int i = 0; i < 10; ++i)
+            oldInfo.addEvent(timeoutEvent(old + i * 1000000, -1));
+        QCOMPARE(oldInfo.jitter(), QStringLiteral("N/A"));
+        QCOMPARE(oldInfo.wakeupsPerSec(), QStringLiteral("0"));
+    }
+
+    void testEventRingBuffer()
+    {
+        TimerInfo info(42);
+        const qint64 start = SignalEvent::currentTimestamp() - Q_INT64_C(5000000000);
+        // irregular events first, which get overwritten by the regular ones
+        for (int i = 0; i < 172; ++i)
+            info.addEvent(timeoutEvent(start + i * 1000000 + (i % 3) * 300000, -1));
+        QCOMPARE(info.numEvents(), 128);
+        QVERIFY(info.jitter() != QStringLiteral("0.0"));
+
+        const qint64 regularStart = start + Q_INT64_C(1000000000);
+        for (int i = 0; i < 128; ++i)
+            info.addEvent(timeoutEvent(regularStart + i * 10000000, -1));
+        QCOMPARE(info.numEvents(), 128);
+        QCOMPARE(info.totalWakeups(), 300);
+        QCOMPARE(info.jitter(), QStringLiteral("0.0"));
+        QCOMPARE(info.wakeupsPerSec(), QStringLiteral("100.0"));
+
+        // partially overwritten, the events need to stay in order across the wrap around
+        for (int i = 128; i < 192; ++i)
+            info.addEvent(timeoutEvent(regularStart + i * 10000000, -1));
+        QCOMPARE(info.numEvents(), 128);
+        QCOMPARE(info.totalWakeups(), 364);
+        QCOMPARE(info.jitter(), QStringLiteral("0.0"));
+        QCOMPARE(info.wakeupsPerSec(), QStringLiteral("100.0"));
+    }
+
+    void testThreadModel()
+    {
+        QStandardItemModel timerModel(0, TimerModel::ColumnCount);
+        TimerThreadModel model(&timerModel);
+        ModelTest modelTest(&model);
+        QCOMPARE(model.rowCount(), 0);
+
+        addThreadRow(&timerModel, QStringLiteral("worker"), 10, 2.5);
+        addThreadRow(&timerModel, QStringLiteral("main"), 100, 50.0);
+        addThreadRow(&timerModel, QStringLiteral("worker"), 5, 1.0);
+        addThreadRow(&timerModel, QStringLiteral("main"), 20, 10.0);
+        addThreadRow(&timerModel, QStringLiteral("worker"), 1, 0.5);
+        QVERIFY(QMetaObject::invokeMethod(&model, "update"));
+
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.index(0, TimerThreadModel::ThreadColumn).data().toString(), QStringLiteral("main"));
+        QCOMPARE(model.index(0, TimerThreadModel::TimerCountColumn).data().toInt(), 2);
+        QCOMPARE(model.index(0, TimerThreadModel::TotalWakeupsColumn).data().toInt(), 120);
+        QCOMPARE(model.index(0, TimerThreadModel::WakeupsPerSecColumn).data().toString(), QStringLiteral("60.0"));
+        QCOMPARE(model.index(1, TimerThreadModel::ThreadColumn).data().toString(), QStringLiteral("worker"));
+        QCOMPARE(model.index(1, TimerThreadModel::TimerCountColumn).data().toInt(), 3);
+        QCOMPARE(model.index(1, TimerThreadModel::TotalWakeupsColumn).data().toInt(), 16);
+        QCOMPARE(model.index(1, TimerThreadModel::WakeupsPerSecColumn).data().toString(), QStringLiteral("4.0"));
+
+        // same threads, only the statistics change
+        QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+        timerModel.setData(timerModel.index(1, TimerModel::TotalWakeupsColumn), 200);
+        QVERIFY(QMetaObject::invokeMethod(&model, "update"));
+        QCOMPARE(dataChangedSpy.size(), 1);
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.index(0, TimerThreadModel::TotalWakeupsColumn).data().toInt(), 220);
+
+        timerModel.removeRows(0, 5);
+        QVERIFY(QMetaObject::invokeMethod(&model, "update"));
+        QCOMPARE(model.rowCount(), 0);
+    }
 };
 
 QTEST_MAIN(TimerTopTest)
@@ -0,0 +1,196 @@
+/*
+  transferimagetest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common/remoteviewframe.h>
+#include <common/transferimage.h>
+
+#include <QtTest/qtest.h>
+#include <QObject>
+#include <QPainter>
+
+using namespace GammaRay;
+
+class TransferImageTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QImage createImage(const QColor &color)
+    {
+        QImage img(300, 200, QImage::Format_ARGB32_Premultiplied);
+        img.fill(color.rgba());
+        return img;
+    }
+
+    static QByteArray serialize(const TransferImage &image)
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << image;
+        return data;
+    }
+
+    static TransferImage deserialize(const QByteArray &data)
+    {
+        TransferImage image;
+        QDataStream stream(data);
+        stream >> image;
+        return image;
+    }
+
+private slots:
+    void testRawFormat()
+    {
+        const auto img = createImage(Qt::red);
+        const auto received = deserialize(serialize(TransferImage(img)));
+        QVERIFY(!received.isDelta());
+        QCOMPARE(received.image(), img);
+    }
+
+    void testTileDelta()
+    {
+        TransferImageDeltaEncoder encoder;
+
+        const auto img1 = createImage(Qt::red);
+        TransferImage t1(img1);
+        encoder.encode(&t1);
+        const auto keyFrame = serialize(t1);
+        auto received1 = deserialize(keyFrame);
+        QVERIFY(!received1.isDelta()); // first one is always complete
+
+        auto img2 = img1;
+        QPainter p(&img2);
+        p.fillRect(100, 70, 10, 10, Qt::blue);
+        p.end();
+        TransferImage t2(img2);
+        encoder.encode(&t2);
+        const auto delta = serialize(t2);
+        QVERIFY(delta.size() < keyFrame.size() / 10);
+
+        auto received2 = deserialize(delta);
+        QVERIFY(received2.isDelta());
+        QVERIFY(!received2.applyDelta(createImage(Qt::red).copy(0, 0, 200, 100)));
+        received2 = deserialize(delta);
+        QVERIFY(received2.applyDelta(received1.image()));
+        QVERIFY(!received2.isDelta());
+        QCOMPARE(received2.image(), img2);
+
+        // unchanged content results in an empty delta
+        TransferImage t3(img2);
+        encoder.encode(&t3);
+        auto received3 = deserialize(serialize(t3));
+        QVERIFY(received3.isDelta());
+        QVERIFY(received3.applyDelta(received2.image()));
+        QCOMPARE(received3.image(), img2);
+
+        // size changes and resets result in a new key frame
+        TransferImage t4(img2.copy(0, 0, 100, 100));
+        encoder.encode(&t4);
+        QVERIFY(!deserialize(serialize(t4)).isDelta());
+
+        encoder.reset();
+        TransferImage t5(img2.copy(0, 0, 100, 100));
+        encoder.encode(&t5);
+        QVERIFY(!deserialize(serialize(t5)).isDelta());
+    }
+
+    void testReduceImage()
+    {
+        RemoteViewFrame frame;
+        frame.setImage(createImage(Qt::red));
+
+        // nothing known about the client, or everything visible at full size
+        frame.reduceImage(QRectF(), QSize());
+        QCOMPARE(frame.image().size(), QSize(300, 200));
+        frame.reduceImage(QRectF(-100, -100, 500, 400), QSize(1000, 800));
+        QCOMPARE(frame.image().size(), QSize(300, 200));
+        QCOMPARE(frame.imageRect(), QRectF(0, 0, 300, 200));
+
+        // zoomed out to 50% and only showing a part of the view
+        frame.reduceImage(QRectF(100, 50, 400, 200), QSize(200, 100));
+        QCOMPARE(frame.image().size(), QSize(100, 75));
+        QCOMPARE(frame.imageRect(), QRectF(100, 50, 200, 150));
+        QCOMPARE(frame.viewRect(), QRectF(0, 0, 300, 200));
+
+        const auto received = [](const RemoteViewFrame &frame) {
+            QByteArray data;
+            QDataStream out(&data, QIODevice::WriteOnly);
+            out << frame;
+            RemoteViewFrame result;
+            QDataStream in(data);
+            in >> result;
+            return result;
+        }(frame);
+        QCOMPARE(received.imageRect(), frame.imageRect());
+        QCOMPARE(received.viewRect(), frame.viewRect());
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    void testSharedMemory()
+    {
+        TransferImageSharedMemoryEncoder encoder;
+
+        const auto img1 = createImage(Qt::red);
+        TransferImage t1(img1);
+        if (!encoder.encode(&t1))
+            QSKIP("shared memory not available");
+        const auto data1 = serialize(t1);
+        QVERIFY(data1.size() < 100);
+        const auto received1 = deserialize(data1);
+        QVERIFY(!received1.isInaccessible());
+        QVERIFY(!received1.isDelta());
+        QCOMPARE(received1.image(), img1);
+
+        // the previous image stays intact while the next one is in flight
+        const auto img2 = createImage(Qt::blue);
+        TransferImage t2(img2);
+        QVERIFY(encoder.encode(&t2));
+        const auto received2 = deserialize(serialize(t2));
+        QCOMPARE(received2.image(), img2);
+        QCOMPARE(received1.image(), img1);
+
+        // growing beyond the segment size
+        const auto img3 = createImage(Qt::green).scaled(600, 400);
+        TransferImage t3(img3);
+        QVERIFY(encoder.encode(&t3));
+        QCOMPARE(deserialize(serialize(t3)).image(), img3);
+        QCOMPARE(received2.image(), img2);
+
+        // the device pixel ratio is passed next to the image, not applied to it
+        auto img4 = createImage(Qt::red);
+        img4.setDevicePixelRatio(2.0);
+        TransferImage t4(img4);
+        QVERIFY(encoder.encode(&t4));
+        const auto received4 = deserialize(serialize(t4));
+        QCOMPARE(received4.devicePixelRatio(), 2.0);
+        QCOMPARE(received4.image().size(), img4.size());
+    }
+#endif
+};
+
+QTEST_MAIN(TransferImageTest)
+
+#include "transferimagetest.moc"
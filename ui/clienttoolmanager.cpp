@@ -35,6 +35,7 @@
 #include <ui/tools/metaobjectbrowser/metaobjectbrowserwidget.h>
 #include <ui/tools/metatypebrowser/metatypebrowserwidget.h>
 #include <ui/tools/objectinspector/objectinspectorwidget.h>
+#include <ui/tools/objectsnapshot/objectsnapshotwidget.h>
 #include <ui/tools/resourcebrowser/resourcebrowserwidget.h>
 #include <ui/tools/standardpaths/standardpathswidget.h>
 
@@ -64,6 +65,7 @@ MAKE_FACTORY(LocaleInspector,   qApp->translate("GammaRay::LocaleInspectorFactor
 MAKE_FACTORY(MessageHandler,    qApp->translate("GammaRay::MessageHandlerFactory", "Messages"));
 MAKE_FACTORY(MetaObjectBrowser, qApp->translate("GammaRay::MetaObjectBrowserFactory", "Meta Objects"));
 MAKE_FACTORY(MetaTypeBrowser,   qApp->translate("GammaRay::MetaTypeBrowserFactory", "Meta Types"));
+MAKE_FACTORY(ObjectSnapshot,    qApp->translate("GammaRay::ObjectSnapshotFactory", "Object Snapshots"));
 MAKE_FACTORY(ResourceBrowser,   qApp->translate("GammaRay::ResourceBrowserFactory", "Resources"));
 MAKE_FACTORY(StandardPaths,     qApp->translate("GammaRay::StandardPathsFactory", "Standard Paths"));
 
@@ -99,6 +101,7 @@ static void initPluginRepository()
     insertFactory(new MetaObjectBrowserFactory);
     insertFactory(new MetaTypeBrowserFactory);
     insertFactory(new ObjectInspectorFactory);
+    insertFactory(new ObjectSnapshotFactory);
     insertFactory(new ResourceBrowserFactory);
     insertFactory(new StandardPathsFactory);
 
@@ -30,7 +30,9 @@
 #include "deferredtreeview.h"
 #include "deferredtreeview_p.h"
 
+#include <QAbstractProxyModel>
 #include <QTimer>
+#include <QVector>
 
 #if defined(HAVE_PRIVATE_QT_HEADERS)
 #include <private/qheaderview_p.h>
@@ -86,9 +88,12 @@ DeferredTreeView::DeferredTreeView(QWidget *parent)
     , m_expandNewContent(false)
     , m_allExpanded(false)
     , m_timer(new QTimer(this))
+    , m_viewportTimer(new QTimer(this))
 {
     m_timer->setSingleShot(true);
     m_timer->setInterval(125);
+    m_viewportTimer->setSingleShot(true);
+    m_viewportTimer->setInterval(25);
 
     setHeader(new HeaderView(header()->orientation(), this));
 
@@ -108,6 +113,7 @@ DeferredTreeView::DeferredTreeView(QWidget *parent)
 
     connect(header(), SIGNAL(sectionCountChanged(int,int)), SLOT(sectionCountChanged()));
     connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    connect(m_viewportTimer, SIGNAL(timeout()), this, SLOT(reportViewport()));
 }
 
 void DeferredTreeView::setModel(QAbstractItemModel *model)
@@ -201,6 +207,19 @@ void DeferredTreeView::rowsInserted(const QModelIndex &parent, int start, int en
     triggerExpansion(parent);
 }
 
+void DeferredTreeView::scrollContentsBy(int dx, int dy)
+{
+    QTreeView::scrollContentsBy(dx, dy);
+    if (dy)
+        m_viewportTimer->start();
+}
+
+void DeferredTreeView::updateGeometries()
+{
+    QTreeView::updateGeometries();
+    m_viewportTimer->start();
+}
+
 void DeferredTreeView::sectionCountChanged()
 {
     const int sections = header()->count();
@@ -257,3 +276,51 @@ void DeferredTreeView::timeout()
 
     emit newContentExpanded();
 }
+
+void DeferredTreeView::reportViewport()
+{
+    if (!model())
+        return;
+
+    QModelIndex index = indexAt(QPoint(0, 0));
+    if (!index.isValid())
+        return;
+
+    // the consumer of this is RemoteModel, at the bottom of the proxy model chain
+    QVector<const QAbstractProxyModel *> proxies;
+    const QAbstractItemModel *sourceModel = model();
+    while (auto proxy = qobject_cast<const QAbstractProxyModel *>(sourceModel)) {
+        proxies.push_back(proxy);
+        sourceModel = proxy->sourceModel();
+    }
+    if (sourceModel->metaObject()->indexOfMethod("setViewport(QModelIndex,int)") < 0)
+        return;
+
+    // map every visible row, sorting or filtering proxies don't preserve contiguous ranges
+    QModelIndexList rows;
+    bool contiguous = true;
+    for (index = index.sibling(index.row(), 0);
+         index.isValid() && visualRect(index).top() < viewport()->height();
+         index = indexBelow(index)) {
+        QModelIndex sourceIndex = index;
+        foreach (auto proxy, proxies)
+            sourceIndex = proxy->mapToSource(sourceIndex);
+        if (!sourceIndex.isValid())
+            continue;
+        if (!rows.isEmpty()) {
+            contiguous = contiguous && sourceIndex.parent() == rows.last().parent()
+                         && sourceIndex.row() == rows.last().row() + 1;
+        }
+        rows.push_back(sourceIndex);
+    }
+    if (rows.isEmpty())
+        return;
+
+    auto remoteModel = const_cast<QAbstractItemModel *>(sourceModel);
+    if (contiguous) {
+        QMetaObject::invokeMethod(remoteModel, "setViewport",
+                                  Q_ARG(QModelIndex, rows.first()), Q_ARG(int, rows.size()));
+    } else {
+        QMetaObject::invokeMethod(remoteModel, "setVisibleRows", Q_ARG(QModelIndexList, rows));
+    }
+}
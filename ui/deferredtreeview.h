@@ -72,9 +72,11 @@ signals:
 
 protected:
     void resetDeferredInitialized();
+    void scrollContentsBy(int dx, int dy) Q_DECL_OVERRIDE;
 
 protected slots:
     void rowsInserted(const QModelIndex &parent, int start, int end) Q_DECL_OVERRIDE;
+    void updateGeometries() Q_DECL_OVERRIDE;
 
 private:
     struct DeferredHeaderProperties
@@ -98,11 +100,13 @@ private:
     bool m_allExpanded;
     QVector<QPersistentModelIndex> m_insertedRows;
     QTimer *m_timer;
+    QTimer *m_viewportTimer;
 
 private slots:
     void sectionCountChanged();
     void triggerExpansion(const QModelIndex &parent);
     void timeout();
+    void reportViewport();
 };
 } // namespace GammaRay
 
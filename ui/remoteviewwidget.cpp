@@ -225,8 +225,23 @@ void RemoteViewWidget::elementsAtReceived(const GammaRay::ObjectIds &ids, int be
     }
 }
 
-void RemoteViewWidget::frameUpdated(const RemoteViewFrame &frame)
+void RemoteViewWidget::frameUpdated(const RemoteViewFrame &deltaFrame)
 {
+    if (deltaFrame.isImageInaccessible()) {
+        // shared memory of a server in a sandbox or under a different user
+        m_interface->requestInlineFrames();
+        QMetaObject::invokeMethod(m_interface, "clientViewUpdated", Qt::QueuedConnection);
+        return;
+    }
+
+    RemoteViewFrame frame(deltaFrame);
+    if (frame.isImageDelta() && !frame.applyImageDelta(m_frame)) {
+        // we don't have the frame this is based on anymore, e.g. after a reset
+        m_interface->requestCompleteFrame();
+        QMetaObject::invokeMethod(m_interface, "clientViewUpdated", Qt::QueuedConnection);
+        return;
+    }
+
     if (!m_frame.isValid()) {
         m_frame = frame;
         if (m_initialZoomDone)
@@ -279,6 +294,8 @@ void RemoteViewWidget::reset()
 {
     m_frame = RemoteViewFrame();
     m_hasMeasurement = false;
+    m_reportedViewportRect = QRectF();
+    m_reportedViewportSize = QSize();
     update();
 }
 
@@ -482,7 +499,9 @@ void RemoteViewWidget::paintEvent(QPaintEvent *event)
                         // but need to be able to see single pixels when zoomed in.
         p.setRenderHint(QPainter::SmoothPixmapTransform);
     }
-    p.drawImage(QRect(QPoint(0, 0), m_frame.viewRect().size().toSize() * m_zoom), m_frame.image());
+    // imageRect() accounts for the device pixel ratio, the received image itself doesn't carry it
+    const QRectF imageRect = m_frame.imageRect();
+    p.drawImage(QRectF(imageRect.topLeft() * m_zoom, imageRect.size() * m_zoom), m_frame.image());
     drawDecoration(&p);
     p.restore();
 
@@ -490,6 +509,9 @@ void RemoteViewWidget::paintEvent(QPaintEvent *event)
 
     if (m_interactionMode == Measuring && m_hasMeasurement)
         drawMeasureOverlay(&p);
+
+    // every zoom or pan position change ends up here
+    reportViewport();
 }
 
 void RemoteViewWidget::drawDecoration(QPainter *p)
@@ -811,6 +833,25 @@ void RemoteViewWidget::clampPanPosition()
         m_y = height() / 2 - m_frame.sceneRect().height() * m_zoom;
 }
 
+void RemoteViewWidget::reportViewport()
+{
+    if (!m_interface || !m_frame.isValid())
+        return;
+
+    const QRectF viewportRect = mapToSource(QRectF(rect()));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    const QSize viewportSize = size() * devicePixelRatio();
+#else
+    const QSize viewportSize = size();
+#endif
+    if (viewportRect == m_reportedViewportRect && viewportSize == m_reportedViewportSize)
+        return;
+
+    m_reportedViewportRect = viewportRect;
+    m_reportedViewportSize = viewportSize;
+    m_interface->setViewport(viewportRect, viewportSize);
+}
+
 void RemoteViewWidget::resizeEvent(QResizeEvent *event)
 {
     m_x += 0.5 * (event->size().width() - event->oldSize().width());
@@ -173,6 +173,8 @@ private:
     void drawMeasurementLabel(QPainter *p, QPoint pos, QPoint dir, const QString &text);
 
     void clampPanPosition();
+    /// tell the server what we show, if that changed since last time
+    void reportViewport();
 
     void sendMouseEvent(QMouseEvent *event);
     void sendKeyEvent(QKeyEvent *event);
@@ -219,6 +221,8 @@ private:
     bool m_initialZoomDone;
     int m_flagRole;
     int m_invisibleMask;
+    QRectF m_reportedViewportRect;
+    QSize m_reportedViewportSize;
 };
 }
 
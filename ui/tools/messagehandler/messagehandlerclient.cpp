@@ -28,9 +28,17 @@
 
 #include "messagehandlerclient.h"
 
+#include <common/endpoint.h>
+
 using namespace GammaRay;
 
 MessageHandlerClient::MessageHandlerClient(QObject *parent)
     : MessageHandlerInterface(parent)
 {
 }
+
+void MessageHandlerClient::requestBacktrace(int messageId)
+{
+    Endpoint::instance()->invokeObject(objectName(), "requestBacktrace",
+                                       QVariantList() << messageId);
+}
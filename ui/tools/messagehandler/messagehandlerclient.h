@@ -38,6 +38,8 @@ class MessageHandlerClient : public MessageHandlerInterface
     Q_INTERFACES(GammaRay::MessageHandlerInterface)
 public:
     explicit MessageHandlerClient(QObject *parent = nullptr);
+
+    void requestBacktrace(int messageId) Q_DECL_OVERRIDE;
 };
 }
 
@@ -65,13 +65,17 @@ MessageHandlerWidget::MessageHandlerWidget(QWidget *parent)
     , ui(new Ui::MessageHandlerWidget)
     , m_stateManager(this)
     , m_backtraceModel(new QStringListModel(this))
+    , m_handler(nullptr)
+    , m_selectedMessageId(-1)
 {
     ObjectBroker::registerClientObjectFactoryCallback<MessageHandlerInterface *>(
         createClientMessageHandler);
-    MessageHandlerInterface *handler = ObjectBroker::object<MessageHandlerInterface *>();
+    m_handler = ObjectBroker::object<MessageHandlerInterface *>();
 
-    connect(handler, SIGNAL(fatalMessageReceived(QString,QString,QTime,QStringList)),
+    connect(m_handler, SIGNAL(fatalMessageReceived(QString,QString,QTime,QStringList)),
             this, SLOT(fatalMessageReceived(QString,QString,QTime,QStringList)));
+    connect(m_handler, SIGNAL(backtraceAvailable(int,QStringList)),
+            this, SLOT(backtraceAvailable(int,QStringList)));
 
     ui->setupUi(this);
 
@@ -209,11 +213,23 @@ void MessageHandlerWidget::messageSelected(const QItemSelection &selection)
     if (!index.isValid())
         return;
 
-    const auto bt = index.sibling(index.row(), 0).data(MessageModelRole::Backtrace).toStringList();
-    if (bt.isEmpty()) {
+    // backtraces are only symbolized on request, rather than for every message transferred
+    const auto messageId = index.sibling(index.row(), 0).data(MessageModelRole::MessageId);
+    m_selectedMessageId = messageId.isValid() ? messageId.toInt() : -1;
+    ui->backtraceView->hide();
+    if (m_selectedMessageId >= 0)
+        m_handler->requestBacktrace(m_selectedMessageId);
+}
+
+void MessageHandlerWidget::backtraceAvailable(int messageId, const QStringList &backtrace)
+{
+    if (messageId != m_selectedMessageId)
+        return;
+
+    if (backtrace.isEmpty()) {
         ui->backtraceView->hide();
     } else {
         ui->backtraceView->show();
-        m_backtraceModel->setStringList(bt);
+        m_backtraceModel->setStringList(backtrace);
     }
 }
@@ -39,6 +39,8 @@ class QTime;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class MessageHandlerInterface;
+
 namespace Ui {
 class MessageHandlerWidget;
 }
@@ -56,11 +58,14 @@ private slots:
     void copyToClipboard(const QString &message);
     void messageContextMenu(const QPoint &pos);
     void messageSelected(const QItemSelection &selection);
+    void backtraceAvailable(int messageId, const QStringList &backtrace);
 
 private:
     QScopedPointer<Ui::MessageHandlerWidget> ui;
     UIStateManager m_stateManager;
     QStringListModel *m_backtraceModel;
+    MessageHandlerInterface *m_handler;
+    int m_selectedMessageId;
 };
 }
 
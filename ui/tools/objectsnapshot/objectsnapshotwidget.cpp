@@ -0,0 +1,151 @@
+/*
+  objectsnapshotwidget.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2016 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "objectsnapshotwidget.h"
+#include "ui_objectsnapshotwidget.h"
+#include "objectsnapshotclient.h"
+
+#include <ui/searchlinecontroller.h>
+
+#include <common/objectbroker.h>
+#include <common/tools/objectsnapshot/objectsnapshotroles.h>
+
+#include <QMenu>
+
+using namespace GammaRay;
+
+static QObject *createObjectSnapshotClient(const QString & /*name*/, QObject *parent)
+{
+    return new ObjectSnapshotClient(parent);
+}
+
+ObjectSnapshotWidget::ObjectSnapshotWidget(QWidget *parent)
+    : QWidget(parent)
+    , ui(new Ui::ObjectSnapshotWidget)
+    , m_stateManager(this)
+    , m_interface(nullptr)
+    , m_selectionPending(false)
+{
+    ObjectBroker::registerClientObjectFactoryCallback<ObjectSnapshotInterface *>(
+        createObjectSnapshotClient);
+    m_interface = ObjectBroker::object<ObjectSnapshotInterface *>();
+
+    ui->setupUi(this);
+
+    auto snapshotListModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ObjectSnapshotListModel"));
+    ui->snapshotView->header()->setObjectName("snapshotViewHeader");
+    ui->snapshotView->setDeferredResizeMode(0, QHeaderView::ResizeToContents);
+    ui->snapshotView->setDeferredResizeMode(1, QHeaderView::ResizeToContents);
+    ui->snapshotView->setDeferredResizeMode(2, QHeaderView::ResizeToContents);
+    ui->snapshotView->setModel(snapshotListModel);
+    connect(ui->snapshotView->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+            this, SLOT(snapshotSelected()));
+    connect(snapshotListModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(snapshotsInserted(QModelIndex,int,int)));
+    connect(snapshotListModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+            this, SLOT(snapshotDataChanged()));
+    connect(ui->snapshotView, SIGNAL(customContextMenuRequested(QPoint)),
+            this, SLOT(snapshotContextMenu(QPoint)));
+
+    auto snapshotModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ObjectSnapshotModel"));
+    ui->objectView->header()->setObjectName("objectViewHeader");
+    ui->objectView->setDeferredResizeMode(0, QHeaderView::Interactive);
+    ui->objectView->setDeferredResizeMode(1, QHeaderView::Interactive);
+    ui->objectView->setDeferredResizeMode(2, QHeaderView::ResizeToContents);
+    ui->objectView->setModel(snapshotModel);
+    new SearchLineController(ui->objectSearchLine, snapshotModel);
+    // every followed snapshot resets the object view, so stop as soon as the user looks into it
+    connect(ui->objectView, SIGNAL(expanded(QModelIndex)), this, SLOT(stopFollowing()));
+    connect(ui->objectView, SIGNAL(pressed(QModelIndex)), this, SLOT(stopFollowing()));
+
+    m_stateManager.setDefaultSizes(ui->mainSplitter, UISizeVector() << "25%" << "75%");
+
+    connect(ui->actionTakeSnapshot, SIGNAL(triggered()), m_interface, SLOT(takeSnapshot()));
+    connect(ui->actionContinuousCapture, SIGNAL(toggled(bool)),
+            m_interface, SLOT(setContinuousCapture(bool)));
+    addAction(ui->actionTakeSnapshot);
+    addAction(ui->actionContinuousCapture);
+    addAction(ui->actionFollowLatest);
+}
+
+ObjectSnapshotWidget::~ObjectSnapshotWidget()
+{
+    if (ui->actionContinuousCapture->isChecked())
+        m_interface->setContinuousCapture(false);
+}
+
+void ObjectSnapshotWidget::snapshotSelected()
+{
+    const QModelIndexList rows = ui->snapshotView->selectionModel()->selectedRows();
+    if (rows.isEmpty()) {
+        m_selectionPending = false;
+        m_interface->selectSnapshot(-1);
+        return;
+    }
+
+    const QVariant snapshotId = rows.first().data(ObjectSnapshotRoles::SnapshotIdRole);
+    m_selectionPending = !snapshotId.isValid();
+    if (!m_selectionPending)
+        m_interface->selectSnapshot(snapshotId.toInt());
+}
+
+void ObjectSnapshotWidget::snapshotsInserted(const QModelIndex &parent, int first, int last)
+{
+    // follow new snapshots if asked to, unless an older one has been picked explicitly
+    const QModelIndex current = ui->snapshotView->currentIndex();
+    if (current.isValid() && (!ui->actionFollowLatest->isChecked() || current.row() != first - 1))
+        return;
+    ui->snapshotView->setCurrentIndex(ui->snapshotView->model()->index(last, 0, parent));
+}
+
+void ObjectSnapshotWidget::stopFollowing()
+{
+    ui->actionFollowLatest->setChecked(false);
+}
+
+void ObjectSnapshotWidget::snapshotDataChanged()
+{
+    if (m_selectionPending)
+        snapshotSelected();
+}
+
+void ObjectSnapshotWidget::snapshotContextMenu(QPoint pos)
+{
+    const QModelIndex index = ui->snapshotView->indexAt(pos);
+    const QVariant snapshotId = index.sibling(index.row(), 0).data(ObjectSnapshotRoles::SnapshotIdRole);
+
+    QMenu menu;
+    QAction *compareAction = menu.addAction(tr("Compare Against This Snapshot"));
+    compareAction->setEnabled(snapshotId.isValid());
+    QAction *stopAction = menu.addAction(tr("Stop Comparing"));
+
+    QAction *action = menu.exec(ui->snapshotView->viewport()->mapToGlobal(pos));
+    if (action == compareAction)
+        m_interface->setDiffBase(snapshotId.toInt());
+    else if (action == stopAction)
+        m_interface->setDiffBase(-1);
+}